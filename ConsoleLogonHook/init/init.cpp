@@ -101,6 +101,7 @@ namespace init
         ControlBase__PaintArea = memory::FindPatternCached<decltype(ControlBase__PaintArea)>("ControlBasePaintArea", { "48 89 5C 24 10 48 89 6C 24 18 56 57 41 54 41 56 41 57 48 83 EC 40" });
         Hook(ControlBase__PaintArea, ControlBase__PaintArea_Hook);
         //MessageBox(0, L"dbg3", 0, 0);
+        interop_trace::Start();
         external::InitExternal();
         //MessageBox(0, L"dbg3.05", 0, 0);
         uiSecurityControl::InitHooks(baseaddress);
@@ -125,6 +126,7 @@ namespace init
     void Unload()
     {
         TerminateThread(uiUserSelectThreadHandle, 0);
+        interop_trace::Stop();
         external::Unload();
     }
 }
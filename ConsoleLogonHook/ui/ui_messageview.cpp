@@ -115,6 +115,7 @@ void uiMessageView::InitHooks(uintptr_t baseaddress)
 
 void external::MessageOptionControl_Press(void* actualInstance, const struct _KEY_EVENT_RECORD* keyrecord, int* success)
 {
+    interop_trace::Record(interop_trace::EV_MESSAGEOPTIONCONTROL_PRESS, (unsigned long long)actualInstance, keyrecord ? keyrecord->wVirtualKeyCode : 0);
     if (actualInstance)
     {
         SPDLOG_INFO("Actual instance {} isn't null, so we are calling handlekeyinput with enter on the control!", actualInstance);
@@ -126,6 +127,7 @@ void external::MessageOptionControl_Press(void* actualInstance, const struct _KE
 const wchar_t* external::MessageOptionControl_GetText(void* actualInstance)
 {
     const wchar_t*& rawptr = *(const wchar_t**)(__int64(actualInstance) + 0x48);
+    interop_trace::Record(interop_trace::EV_MESSAGEOPTIONCONTROL_GETTEXT, (unsigned long long)actualInstance, 0, rawptr);
     return rawptr;
 }
 
@@ -179,6 +179,7 @@ __int64 SecurityOptionsView__Destructor_Hook(__int64 a1, char a2)
 
 void external::SecurityOptionControl_Press(void* actualInstance, const struct _KEY_EVENT_RECORD* keyrecord, int* success)
 {
+    interop_trace::Record(interop_trace::EV_SECURITYOPTIONCONTROL_PRESS, (unsigned long long)actualInstance, keyrecord ? keyrecord->wVirtualKeyCode : 0);
     if (actualInstance)
     {
 
@@ -188,7 +189,9 @@ void external::SecurityOptionControl_Press(void* actualInstance, const struct _K
 
 const wchar_t* external::SecurityOptionControl_getString(void* actualInstance)
 {
-    return *(wchar_t**)(__int64(actualInstance) + 0x48);
+    const wchar_t* string = *(wchar_t**)(__int64(actualInstance) + 0x48);
+    interop_trace::Record(interop_trace::EV_SECURITYOPTIONCONTROL_GETSTRING, (unsigned long long)actualInstance, 0, string);
+    return string;
 }
 
 /*void SecurityOptionControlWrapper::Press()
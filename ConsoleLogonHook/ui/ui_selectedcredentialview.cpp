@@ -155,13 +155,16 @@ const wchar_t* external::EditControl_GetFieldName(void* actualInstance)
 	if (!v28)
 	{
 		SPDLOG_INFO("v28 is null, returning nothing");
+		interop_trace::Record(interop_trace::EV_EDITCONTROL_GETFIELDNAME, (unsigned long long)actualInstance);
 		return L"";
 	}
 
 	HSTRING v27;
 	(*(__int64(__fastcall**)(__int64, HSTRING*))(*(uintptr_t*)v28 + 48i64))(v28, &v27);
 
-	return ConvertHStringToRawString(v27);
+	const wchar_t* fieldName = ConvertHStringToRawString(v27);
+	interop_trace::Record(interop_trace::EV_EDITCONTROL_GETFIELDNAME, (unsigned long long)actualInstance, 0, fieldName);
+	return fieldName;
 }
 
 const wchar_t* external::EditControl_GetInputtedText(void* actualInstance)
@@ -170,11 +173,16 @@ const wchar_t* external::EditControl_GetInputtedText(void* actualInstance)
 	uintptr_t v2 = *(uintptr_t*)(__int64(actualInstance) + 0x70);
 	(*(__int64(__fastcall**)(__int64, HSTRING*))(*(__int64*)v2 + 0x30i64))(v2, &string);
 
-	return ConvertHStringToRawString(string);
+	const wchar_t* text = ConvertHStringToRawString(string);
+	interop_trace::Record(interop_trace::EV_EDITCONTROL_GETINPUTTEDTEXT, (unsigned long long)actualInstance, text ? wcslen(text) : 0);
+	return text;
 }
 
 void external::EditControl_SetInputtedText(void* actualInstance, const wchar_t* input)
 {
+	// Only the length is recorded, the input may be a password
+	interop_trace::Record(interop_trace::EV_EDITCONTROL_SETINPUTTEDTEXT, (unsigned long long)actualInstance, input ? wcslen(input) : 0);
+
 	//HSTRING string;
 	//uintptr_t v2 = *(uintptr_t*)(__int64(actualInstance) + 0x70);
 	//(*(__int64(__fastcall**)(__int64, HSTRING*))(*(__int64*)v2 + 0x30i64))(v2, &string);
@@ -195,6 +203,7 @@ bool external::EditControl_isVisible(void* actualInstance)
 {
 	bool val = *(bool*)(__int64(actualInstance) + 0x78);
 	SPDLOG_INFO("val {}",(int)val);
+	interop_trace::Record(interop_trace::EV_EDITCONTROL_ISVISIBLE, (unsigned long long)actualInstance, val);
 	return val;
 }
 
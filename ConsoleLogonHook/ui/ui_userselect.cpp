@@ -2,9 +2,12 @@
 #include "detours.h"
 #include "spdlog/spdlog.h"
 #include "../util/util.h"
+#include "../../ConsoleLogonUI/util/sort_key.h"
 #include <winstring.h>
 #include <sddl.h>
 #include <vector>
+#include <numeric>
+#include <algorithm>
 #include <atlbase.h>
 #include "util/interop.h"
 #include "util/memory_man.h"
@@ -39,7 +42,21 @@ __int64 UserSelectionView__RuntimeClassInitialize_Hook(void* _this, void* a2)
 
     external::SelectableUserOrCredentialControl_Sort();
 
-    std::sort(buttons.begin(), buttons.end(), [](SelectableUserOrCredentialControlWrapper& a, SelectableUserOrCredentialControlWrapper& b) { return a.GetText() < b.GetText(); });
+    // Fetch each name and work out its sort key once, then sort indices by key
+    std::vector<std::vector<uint8_t>> keys;
+    keys.reserve(buttons.size());
+    for (auto& button : buttons)
+        keys.push_back(GetSortKey(button.GetText()));
+
+    std::vector<size_t> order(buttons.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    std::vector<SelectableUserOrCredentialControlWrapper> sorted;
+    sorted.reserve(buttons.size());
+    for (size_t i : order)
+        sorted.push_back(std::move(buttons[i]));
+    buttons.swap(sorted);
 
     return res;
 }
@@ -110,23 +127,9 @@ __int64 SelectableUserOrCredentialControl__RuntimeClassInitialize_Hook(void* _th
 
     //MessageBoxW(0, username, username, 0);
 
+    // The GINA user list has no pictures, so no SID or picture lookup is done for the tile
     if (!wrapper.isCredentialControl())
-    {
-
-        std::wstring sid = L"";
-        auto hr = GetSIDStringFromUsername(wrapper.GetText().c_str(), &sid);
-
-        //Use higher res image for dpis higher than 96
-        bool bHighRes = false;
-        int DPI = GetDpiForSystem();
-        if (DPI > 96)
-            bHighRes = true;
-
-        auto path = GetProfilePicturePathFromSID(sid.c_str(), bHighRes);
-            
-        external::SelectableUserOrCredentialControl_Create(wrapper.actualInstance, path);
-
-    }
+        external::SelectableUserOrCredentialControl_Create(wrapper.actualInstance, L"");
 
     SPDLOG_INFO("SelectableUserOrCredentialControl__RuntimeClassInitialize_Hook, user name {} this {} a3 {} SID {}", ws2s(wrapper.GetText()),_this,a3, str ? ws2s(str) : "NULL");
     buttons.push_back(wrapper);
@@ -237,11 +240,13 @@ void uiUserSelect::InitHooks(uintptr_t baseaddress)
 
 void external::ConsoleUIView__HandleKeyInputExternal(void* instance, const struct _KEY_EVENT_RECORD* keyrecord)
 {
+    interop_trace::Record(interop_trace::EV_CONSOLEUIVIEW_HANDLEKEYINPUT, (unsigned long long)instance, keyrecord ? keyrecord->wVirtualKeyCode : 0);
     globals::ConsoleUIView__HandleKeyInput((void*)(__int64(instance) + 8),keyrecord);
 }
 
 void* external::GetConsoleUIView()
 {
+    interop_trace::Record(interop_trace::EV_GETCONSOLEUIVIEW, (unsigned long long)globals::ConsoleUIView);
     return globals::ConsoleUIView;
 }
 
@@ -255,13 +260,16 @@ void external::SelectableUserOrCredentialControl_GetText(void* actualInstance, w
 
         std::wstring text = button.GetText();
         wcscpy_s(OutText, MaxLength,text.c_str());
+        interop_trace::Record(interop_trace::EV_SELECTABLEUSERORCREDENTIALCONTROL_GETTEXT, (unsigned long long)actualInstance, 0, text.c_str());
         
         return;
     }
+    interop_trace::Record(interop_trace::EV_SELECTABLEUSERORCREDENTIALCONTROL_GETTEXT, (unsigned long long)actualInstance);
 }
 
 void external::SelectableUserOrCredentialControl_Press(void* actualInstance)
 {
+    interop_trace::Record(interop_trace::EV_SELECTABLEUSERORCREDENTIALCONTROL_PRESS, (unsigned long long)actualInstance);
     for (int i = 0; i < buttons.size(); ++i)
     {
         auto& button = buttons[i];
@@ -282,8 +290,11 @@ bool external::SelectableUserOrCredentialControl_isCredentialControl(void* actua
         if (button.actualInstance != actualInstance)
             continue;
 
-        return button.isCredentialControl();
+        bool isCredentialControl = button.isCredentialControl();
+        interop_trace::Record(interop_trace::EV_SELECTABLEUSERORCREDENTIALCONTROL_ISCREDENTIALCONTROL, (unsigned long long)actualInstance, isCredentialControl);
+        return isCredentialControl;
     }
+    interop_trace::Record(interop_trace::EV_SELECTABLEUSERORCREDENTIALCONTROL_ISCREDENTIALCONTROL, (unsigned long long)actualInstance);
     return false;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include <windows.h>
+#include "interop_trace.h"
 
 #define EXTERNAL(a,b) (a)(GetProcAddress(externalUiModule, b))
 
@@ -32,6 +33,7 @@ namespace external
 
     static void MessageView_SetActive()
     {
+        interop_trace::Record(interop_trace::EV_MESSAGEVIEW_SETACTIVE);
         static auto fMessageView_SetActive = EXTERNAL(void(*)(), "MessageView_SetActive");
         if (fMessageView_SetActive)
             fMessageView_SetActive();
@@ -39,6 +41,7 @@ namespace external
 
     static void MessageOptionControl_Create(void* actualInsance, int optionflag)
     {
+        interop_trace::Record(interop_trace::EV_MESSAGEOPTIONCONTROL_CREATE, (unsigned long long)actualInsance, optionflag);
         static auto fMessageView_SetActive = EXTERNAL(void(*)(void* actualInsance, int optionflag), "MessageOptionControl_Create");
         if (fMessageView_SetActive)
             fMessageView_SetActive(actualInsance,optionflag);
@@ -46,6 +49,7 @@ namespace external
 
     static void MessageOptionControl_Destroy(void* actualInstance)
     {
+        interop_trace::Record(interop_trace::EV_MESSAGEOPTIONCONTROL_DESTROY, (unsigned long long)actualInstance);
         static auto fMessageOptionControl_Destroy = EXTERNAL(void(*)(void* actualInstance), "MessageOptionControl_Destroy");
         if (fMessageOptionControl_Destroy)
             fMessageOptionControl_Destroy(actualInstance);
@@ -53,6 +57,7 @@ namespace external
 
     static void MessageView_SetMessage(std::wstring message)
     {
+        interop_trace::Record(interop_trace::EV_MESSAGEVIEW_SETMESSAGE, 0, 0, message.c_str());
         static auto fMessageView_SetMessage = EXTERNAL(void(*)(const wchar_t* message), "MessageView_SetMessage");
         if (fMessageView_SetMessage)
             fMessageView_SetMessage(message.c_str());
@@ -60,6 +65,7 @@ namespace external
 
     static void SecurityControlButtonsList_Clear()
     {
+        interop_trace::Record(interop_trace::EV_SECURITYCONTROLBUTTONSLIST_CLEAR);
         static auto fSecurityControlButtonsList_Clear = EXTERNAL(void(*)(), "SecurityControlButtonsList_Clear");
         if (fSecurityControlButtonsList_Clear)
             fSecurityControlButtonsList_Clear();
@@ -67,6 +73,7 @@ namespace external
 
     static void SecurityControl_SetActive()
     {
+        interop_trace::Record(interop_trace::EV_SECURITYCONTROL_SETACTIVE);
         static auto fSecurityControl_SetActive = EXTERNAL(void(*)(), "SecurityControl_SetActive");
         if (fSecurityControl_SetActive)
             fSecurityControl_SetActive();
@@ -74,6 +81,7 @@ namespace external
 
     static void SecurityControl_SetInactive()
     {
+        interop_trace::Record(interop_trace::EV_SECURITYCONTROL_SETINACTIVE);
         static auto fSecurityControl_SetInactive = EXTERNAL(void(*)(), "SecurityControl_SetInactive");
         if (fSecurityControl_SetInactive)
             fSecurityControl_SetInactive();
@@ -81,6 +89,7 @@ namespace external
 
     static void SecurityControl_ButtonsReady()
     {
+        interop_trace::Record(interop_trace::EV_SECURITYCONTROL_BUTTONSREADY);
         static auto fSecurityControl_ButtonsReady = EXTERNAL(void(*)(), "SecurityControl_ButtonsReady");
         if (fSecurityControl_ButtonsReady)
             fSecurityControl_ButtonsReady();
@@ -88,6 +97,7 @@ namespace external
 
     static void SecurityOptionControl_Create(void* actualInstance)
     {
+        interop_trace::Record(interop_trace::EV_SECURITYOPTIONCONTROL_CREATE, (unsigned long long)actualInstance);
         static auto fSecurityOptionControl_Create = EXTERNAL(void(*)(void* actualInstance), "SecurityOptionControl_Create");
         if (fSecurityOptionControl_Create)
             fSecurityOptionControl_Create(actualInstance);
@@ -95,6 +105,7 @@ namespace external
 
     static void SecurityOptionControl_Destroy(void* actualInstance)
     {
+        interop_trace::Record(interop_trace::EV_SECURITYOPTIONCONTROL_DESTROY, (unsigned long long)actualInstance);
         static auto fSecurityOptionControl_Destroy = EXTERNAL(void(*)(void* actualInstance), "SecurityOptionControl_Destroy");
         if (fSecurityOptionControl_Destroy)
             fSecurityOptionControl_Destroy(actualInstance);
@@ -102,6 +113,7 @@ namespace external
 
     static void NotifyWasInSelectedCredentialView()
     {
+        interop_trace::Record(interop_trace::EV_NOTIFYWASINSELECTEDCREDENTIALVIEW);
         static auto fNotifyWasInSelectedCredentialView = EXTERNAL(void(*)(), "NotifyWasInSelectedCredentialView");
         if (fNotifyWasInSelectedCredentialView)
             fNotifyWasInSelectedCredentialView();
@@ -109,6 +121,7 @@ namespace external
 
     static void SelectedCredentialView_SetActive(const wchar_t* accountNameToDisplay, int flag)
     {
+        interop_trace::Record(interop_trace::EV_SELECTEDCREDENTIALVIEW_SETACTIVE, flag, 0, accountNameToDisplay);
         static auto fSelectedCredentialView_SetActive = EXTERNAL(void(*)(const wchar_t* accountNameToDisplay, int flag), "SelectedCredentialView_SetActive");
         if (fSelectedCredentialView_SetActive)
             fSelectedCredentialView_SetActive(accountNameToDisplay, flag);
@@ -116,6 +129,7 @@ namespace external
 
     static void EditControl_Create(void* actualInstance)
     {
+        interop_trace::Record(interop_trace::EV_EDITCONTROL_CREATE, (unsigned long long)actualInstance);
         static auto fEditControl_Create = EXTERNAL(void(*)(void* actualInstance), "EditControl_Create");
         if (fEditControl_Create)
             fEditControl_Create(actualInstance);
@@ -123,6 +137,7 @@ namespace external
 
     static void EditControl_Destroy(void* actualInstance)
     {
+        interop_trace::Record(interop_trace::EV_EDITCONTROL_DESTROY, (unsigned long long)actualInstance);
         static auto fEditControl_Destroy = EXTERNAL(void(*)(void* actualInstance), "EditControl_Destroy");
         if (fEditControl_Destroy)
             fEditControl_Destroy(actualInstance);
@@ -130,6 +145,7 @@ namespace external
 
     static void StatusView_SetActive(std::wstring text)
     {
+        interop_trace::Record(interop_trace::EV_STATUSVIEW_SETACTIVE, 0, 0, text.c_str());
         static auto fStatusView_SetActive = EXTERNAL(void(*)(const wchar_t*), "StatusView_SetActive");
         if (fStatusView_SetActive)
             fStatusView_SetActive(text.c_str());
@@ -137,6 +153,7 @@ namespace external
 
     static void UserSelect_SetActive()
     {
+        interop_trace::Record(interop_trace::EV_USERSELECT_SETACTIVE);
         static auto fUserSelect_SetActive = EXTERNAL(void(*)(), "UserSelect_SetActive");
         if (fUserSelect_SetActive)
             fUserSelect_SetActive();
@@ -144,6 +161,7 @@ namespace external
 
     static void SelectableUserOrCredentialControl_Sort()
     {
+        interop_trace::Record(interop_trace::EV_SELECTABLEUSERORCREDENTIALCONTROL_SORT);
         static auto fSelectableUserOrCredentialControl_Sort = EXTERNAL(void(*)(), "SelectableUserOrCredentialControl_Sort");
         if (fSelectableUserOrCredentialControl_Sort)
             fSelectableUserOrCredentialControl_Sort();
@@ -151,6 +169,7 @@ namespace external
 
     static void SelectableUserOrCredentialControl_Create(void* actualInstance, std::wstring path)
     {
+        interop_trace::Record(interop_trace::EV_SELECTABLEUSERORCREDENTIALCONTROL_CREATE, (unsigned long long)actualInstance, 0, path.c_str());
         static auto fSelectableUserOrCredentialControl_Create = EXTERNAL(void(*)(void* actualInstance, const wchar_t* path), "SelectableUserOrCredentialControl_Create");
         if (fSelectableUserOrCredentialControl_Create)
             fSelectableUserOrCredentialControl_Create(actualInstance,path.c_str());
@@ -158,6 +177,7 @@ namespace external
 
     static void SelectableUserOrCredentialControl_Destroy(void* actualInstance)
     {
+        interop_trace::Record(interop_trace::EV_SELECTABLEUSERORCREDENTIALCONTROL_DESTROY, (unsigned long long)actualInstance);
         static auto fSelectableUserOrCredentialControl_Destroy = EXTERNAL(void(*)(void* actualInstance), "SelectableUserOrCredentialControl_Destroy");
         if (fSelectableUserOrCredentialControl_Destroy)
             fSelectableUserOrCredentialControl_Destroy(actualInstance);
@@ -165,6 +185,7 @@ namespace external
 
     static void MessageOrStatusView_Destroy()
     {
+        interop_trace::Record(interop_trace::EV_MESSAGEORSTATUSVIEW_DESTROY);
         static auto fMessageOrStatusView_Destroy = EXTERNAL(void(*)(), "MessageOrStatusView_Destroy");
         if (fMessageOrStatusView_Destroy)
             fMessageOrStatusView_Destroy();
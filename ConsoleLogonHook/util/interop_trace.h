@@ -0,0 +1,81 @@
+#pragma once
+#include <windows.h>
+#include <mutex>
+#include "interop_trace_file.h"
+
+// Binary recorder for the calls crossing the ConsoleLogonHook <-> ConsoleLogonUI boundary
+// Enable by setting the CLH_GINA InteropTrace value (REG_SZ) to the path of the trace file
+// The format and the reader live in interop_trace_file.h
+namespace interop_trace
+{
+    inline HANDLE hTraceFile = INVALID_HANDLE_VALUE;
+    inline std::mutex traceMutex;
+
+    static void Start()
+    {
+        WCHAR szPath[MAX_PATH];
+        DWORD cbData = sizeof(szPath);
+        if (RegGetValueW(
+            HKEY_LOCAL_MACHINE,
+            L"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Authentication\\LogonUI\\CLH_GINA",
+            L"InteropTrace",
+            RRF_RT_REG_SZ,
+            NULL,
+            szPath,
+            &cbData) != ERROR_SUCCESS || !szPath[0])
+        {
+            return;
+        }
+
+        hTraceFile = CreateFileW(szPath, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (hTraceFile == INVALID_HANDLE_VALUE)
+            return;
+
+        traceHeader header;
+        LARGE_INTEGER li;
+        header.magic = TraceMagic;
+        header.version = TraceVersion;
+        QueryPerformanceFrequency(&li);
+        header.qpcFrequency = li.QuadPart;
+        QueryPerformanceCounter(&li);
+        header.qpcStart = li.QuadPart;
+
+        DWORD cbWritten;
+        WriteFile(hTraceFile, &header, sizeof(header), &cbWritten, NULL);
+    }
+
+    static void Stop()
+    {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        if (hTraceFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(hTraceFile);
+            hTraceFile = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    static void Record(EVENT event, unsigned long long arg0 = 0, unsigned long long arg1 = 0, const wchar_t* str = nullptr)
+    {
+        if (hTraceFile == INVALID_HANDLE_VALUE)
+            return;
+
+        traceRecord record;
+        LARGE_INTEGER li;
+        QueryPerformanceCounter(&li);
+        record.qpc = li.QuadPart;
+        record.event = event;
+        record.strLength = str ? (uint16_t)min(wcslen(str), 0xFFFF) : 0;
+        record.arg0 = arg0;
+        record.arg1 = arg1;
+
+        // Keep the record and its payload together when several threads call across at once
+        std::lock_guard<std::mutex> lock(traceMutex);
+        if (hTraceFile == INVALID_HANDLE_VALUE)
+            return;
+
+        DWORD cbWritten;
+        WriteFile(hTraceFile, &record, sizeof(record), &cbWritten, NULL);
+        if (record.strLength)
+            WriteFile(hTraceFile, str, record.strLength * sizeof(wchar_t), &cbWritten, NULL);
+    }
+}
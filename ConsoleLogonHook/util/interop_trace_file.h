@@ -0,0 +1,144 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// On-disk format of the interop trace and the code to read it back
+// Kept free of Win32 so traces can be loaded and replayed anywhere, interop_trace.h does the recording
+//
+// File layout:
+//   traceHeader
+//   traceRecord + (strLength * 2) bytes of UTF-16 string payload, repeated
+namespace interop_trace
+{
+    enum EVENT : unsigned short
+    {
+        // Hook -> UI
+        EV_MESSAGEVIEW_SETACTIVE = 1,
+        EV_MESSAGEOPTIONCONTROL_CREATE,
+        EV_MESSAGEOPTIONCONTROL_DESTROY,
+        EV_MESSAGEVIEW_SETMESSAGE,
+        EV_SECURITYCONTROLBUTTONSLIST_CLEAR,
+        EV_SECURITYCONTROL_SETACTIVE,
+        EV_SECURITYCONTROL_SETINACTIVE,
+        EV_SECURITYCONTROL_BUTTONSREADY,
+        EV_SECURITYOPTIONCONTROL_CREATE,
+        EV_SECURITYOPTIONCONTROL_DESTROY,
+        EV_NOTIFYWASINSELECTEDCREDENTIALVIEW,
+        EV_SELECTEDCREDENTIALVIEW_SETACTIVE,
+        EV_EDITCONTROL_CREATE,
+        EV_EDITCONTROL_DESTROY,
+        EV_STATUSVIEW_SETACTIVE,
+        EV_USERSELECT_SETACTIVE,
+        EV_SELECTABLEUSERORCREDENTIALCONTROL_SORT,
+        EV_SELECTABLEUSERORCREDENTIALCONTROL_CREATE,
+        EV_SELECTABLEUSERORCREDENTIALCONTROL_DESTROY,
+        EV_MESSAGEORSTATUSVIEW_DESTROY,
+
+        // UI -> Hook
+        EV_MESSAGEOPTIONCONTROL_PRESS = 0x100,
+        EV_SECURITYOPTIONCONTROL_PRESS,
+        EV_EDITCONTROL_SETINPUTTEDTEXT,
+        EV_CONSOLEUIVIEW_HANDLEKEYINPUT,
+        EV_SELECTABLEUSERORCREDENTIALCONTROL_PRESS,
+        EV_HIDECONSOLEUI,
+        EV_SHOWCONSOLEUI,
+
+        // UI -> Hook getters, arg1 or the string holds what was returned
+        EV_MESSAGEOPTIONCONTROL_GETTEXT,
+        EV_SECURITYOPTIONCONTROL_GETSTRING,
+        EV_EDITCONTROL_GETFIELDNAME,
+        EV_EDITCONTROL_GETINPUTTEDTEXT, // Length only, like EV_EDITCONTROL_SETINPUTTEDTEXT
+        EV_EDITCONTROL_ISVISIBLE,
+        EV_GETCONSOLEUIVIEW,
+        EV_GETPROFILEPICTUREPATHFROMSID, // The string is the SID asked for
+        EV_GETSIDFROMNAME, // The string is the user name asked for
+        EV_SELECTABLEUSERORCREDENTIALCONTROL_GETTEXT,
+        EV_SELECTABLEUSERORCREDENTIALCONTROL_ISCREDENTIALCONTROL,
+    };
+
+    inline const uint32_t TraceMagic = 0x544C4843; // "CHLT" on disk
+    inline const uint32_t TraceVersion = 1;
+
+#pragma pack(push, 1)
+    struct traceHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        int64_t qpcFrequency;
+        int64_t qpcStart;
+    };
+
+    struct traceRecord
+    {
+        int64_t qpc;
+        uint16_t event;
+        uint16_t strLength;
+        uint64_t arg0;
+        uint64_t arg1;
+    };
+#pragma pack(pop)
+
+    struct traceEvent
+    {
+        int64_t time; // 100ns units since the start of the trace
+        EVENT event;
+        uint64_t arg0;
+        uint64_t arg1;
+        std::wstring str;
+    };
+
+    // A trace cut short by a crash loads up to its last complete record
+    static bool Load(const std::filesystem::path& path, std::vector<traceEvent>& events)
+    {
+        events.clear();
+
+        std::ifstream file(path, std::ios::binary);
+        traceHeader header;
+        if (!file.read((char*)&header, sizeof(header))
+            || header.magic != TraceMagic || header.version != TraceVersion || header.qpcFrequency <= 0)
+            return false;
+
+        traceRecord record;
+        std::u16string payload;
+        while (file.read((char*)&record, sizeof(record)))
+        {
+            payload.resize(record.strLength);
+            if (record.strLength && !file.read((char*)payload.data(), record.strLength * sizeof(char16_t)))
+                break;
+
+            traceEvent event;
+            // Store timestamps in 100ns units so replays don't depend on the recording machine's QPC frequency
+            event.time = (int64_t)((double)(record.qpc - header.qpcStart) * 10000000 / header.qpcFrequency);
+            event.event = (EVENT)record.event;
+            event.arg0 = record.arg0;
+            event.arg1 = record.arg1;
+            // Code unit by code unit, which is exact where wchar_t is UTF-16 and keeps the BMP intact elsewhere
+            event.str.assign(payload.begin(), payload.end());
+            events.push_back(std::move(event));
+        }
+        return true;
+    }
+
+    // Feeds the events to the callback with their original spacing divided by speed
+    // Pass 0 as speed to replay as fast as possible (e.g. for soak tests)
+    static void Replay(const std::vector<traceEvent>& events, double speed, const std::function<void(const traceEvent&)>& callback)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (const traceEvent& event : events)
+        {
+            if (speed > 0)
+            {
+                auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double, std::ratio<1, 10000000>>(event.time / speed));
+                std::this_thread::sleep_until(due);
+            }
+            callback(event);
+        }
+    }
+}
@@ -22,19 +22,23 @@
 
 void external::GetProfilePicturePathFromSID(const wchar_t* sid, const wchar_t* outUsername, bool bHighRes)
 {
+    interop_trace::Record(interop_trace::EV_GETPROFILEPICTUREPATHFROMSID, bHighRes, 0, sid);
     ::GetProfilePicturePathFromSID(std::wstring(sid),outUsername,bHighRes);
 }
 void external::GetSIDFromName(const wchar_t* username, wchar_t** sid)
 {
     auto hr = ::GetSIDStringFromUsername(username, sid);
+    interop_trace::Record(interop_trace::EV_GETSIDFROMNAME, (unsigned long)hr, 0, username);
 }   
 
 void external::HideConsoleUI()
 {
+    interop_trace::Record(interop_trace::EV_HIDECONSOLEUI);
     MinimizeLogonConsole();
 }
 
 void external::ShowConsoleUI()
 {
+    interop_trace::Record(interop_trace::EV_SHOWCONSOLEUI);
     ShowLogonConsole();
 }
\ No newline at end of file
@@ -4,11 +4,15 @@
 #include <windows.h>
 #include "ui/gina_manager.h"
 #include "util/interop.h"
+#include "util/util.h"
 #include "ui/wallhost.h"
 
 extern "C" __declspec(dllexport) void InitUI()
 {
     external::InitExternal();
+	ginaViewState::Get()->SetLogSink([](const wchar_t* line) { OutputDebugStringW(line); });
+	InitSessionCache();
+	InitConfigStore();
 	ginaManager::Get()->LoadGina();
 	InitWallHost();
 }
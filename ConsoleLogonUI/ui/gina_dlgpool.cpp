@@ -0,0 +1,252 @@
+#pragma once
+#include "gina_dlgpool.h"
+#include "gina_manager.h"
+#include "util/util.h"
+#include "util/dlg_template.h"
+#include <thread>
+
+static LONGLONG ElapsedUs(LONGLONG start)
+{
+	LARGE_INTEGER freq, now;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (now.QuadPart - start) * 1000000 / freq.QuadPart;
+}
+
+ginaDialogPool* ginaDialogPool::Get()
+{
+	// Never destroyed, the pool thread keeps running while statics are torn down
+	static ginaDialogPool* pool = new ginaDialogPool();
+	return pool;
+}
+
+ginaDialogPool::ginaDialogPool()
+	: _hWnd(NULL)
+{
+	for (int i = 0; i < GV_COUNT; i++)
+	{
+		_entries[i] = {};
+	}
+}
+
+void ginaDialogPool::Start(const std::vector<ginaPooledView>& views)
+{
+	if (_hWnd)
+	{
+		return;
+	}
+
+	for (const ginaPooledView& desc : views)
+	{
+		entry& e = _entries[desc.view];
+		e.desc = desc;
+		// Manual reset, set while the view is hidden
+		e.hHidden = CreateEventW(NULL, TRUE, TRUE, NULL);
+		e.fPooled = e.hHidden != NULL;
+	}
+
+	HANDLE hReady = CreateEventW(NULL, TRUE, FALSE, NULL);
+	if (!hReady)
+	{
+		return;
+	}
+	std::thread([hReady] {
+		ginaDialogPool::Get()->Run(hReady);
+	}).detach();
+	// Only the message window, the dialogs are created afterwards
+	WaitForSingleObject(hReady, 5000);
+	CloseHandle(hReady);
+}
+
+void ginaDialogPool::Run(HANDLE hReady)
+{
+	WNDCLASSW wc = { 0 };
+	wc.lpfnWndProc = WndProc;
+	wc.hInstance = ginaManager::Get()->hInstance;
+	wc.lpszClassName = L"CLH_GINA_DialogPool";
+	RegisterClassW(&wc);
+
+	HWND hWnd = CreateWindowExW(0, wc.lpszClassName, NULL, 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, wc.hInstance, NULL);
+	if (!hWnd)
+	{
+		dbgprintf(L"CLH_GINA: Dialog pool unavailable, views create their dialogs when they come up");
+		SetEvent(hReady);
+		return;
+	}
+	_hWnd = hWnd;
+	SetEvent(hReady);
+
+	// Posted, so any view that's asked for in the meantime comes first
+	for (int i = 0; i < GV_COUNT; i++)
+	{
+		if (_entries[i].fPooled)
+		{
+			PostMessageW(hWnd, WM_POOL_WARMUP, i, 0);
+		}
+	}
+	// The dialogs' message loop is this one, pooled views beat from here while they're shown
+	SetTimer(hWnd, IDT_POOL_BEAT, ginaWatchdog::Get()->GetBeatMs(), NULL);
+
+	MSG msg;
+	while (true)
+	{
+		BOOL fResult = GetMessageW(&msg, NULL, 0, 0);
+		if (fResult == -1)
+		{
+			break;
+		}
+		if (!fResult)
+		{
+			// WM_CLOSE and WM_DESTROY of the dialogs quit their own message loop thread, here it only closes the view
+			for (int i = 0; i < GV_COUNT; i++)
+			{
+				if (_entries[i].fShown)
+				{
+					Hide((GINAVIEW)i);
+				}
+			}
+			continue;
+		}
+
+		HWND hRoot = msg.hwnd ? GetAncestor(msg.hwnd, GA_ROOT) : NULL;
+		if (hRoot && hRoot != hWnd && IsDialogMessageW(hRoot, &msg))
+		{
+			continue;
+		}
+		TranslateMessage(&msg);
+		DispatchMessageW(&msg);
+	}
+}
+
+HWND ginaDialogPool::CreateView(entry* pEntry)
+{
+	if (pEntry->hDlg)
+	{
+		return pEntry->hDlg;
+	}
+
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+
+	// A copy of the template without WS_VISIBLE, so warming up never flashes the dialog
+	peSpan span;
+	if (!ginaManager::Get()->ginaResources.Find(PE_RT_DIALOG, (uint16_t)pEntry->desc.resId, &span))
+	{
+		return NULL;
+	}
+	std::vector<BYTE> tmpl(span.data, span.data + span.size);
+	if (!ClearDialogTemplateStyle(tmpl.data(), tmpl.size(), WS_VISIBLE))
+	{
+		return NULL;
+	}
+
+	HWND hDlg = CreateDialogIndirectParamW(ginaManager::Get()->hGinaDll, (LPCDLGTEMPLATEW)tmpl.data(), NULL, pEntry->desc.pfnDlgProc, GINA_DLG_POOLED);
+	if (!hDlg)
+	{
+		return NULL;
+	}
+	if (ginaManager::Get()->config.classicTheme)
+	{
+		MakeWindowClassic(hDlg);
+	}
+
+	pEntry->hDlg = hDlg;
+	*pEntry->desc.phDlg = hDlg;
+	dbgprintf(L"CLH_GINA: Pooled %s dialog created in %lld us", ginaViewState::GetViewName(pEntry->desc.view), ElapsedUs(start.QuadPart));
+	return hDlg;
+}
+
+BOOL ginaDialogPool::Show(GINAVIEW view)
+{
+	HWND hWnd = _hWnd;
+	if (!hWnd || view <= GV_NONE || view >= GV_COUNT || !_entries[view].fPooled)
+	{
+		return FALSE;
+	}
+
+	LARGE_INTEGER start;
+	QueryPerformanceCounter(&start);
+	return (BOOL)SendMessageW(hWnd, WM_POOL_SHOW, view, (LPARAM)&start.QuadPart);
+}
+
+BOOL ginaDialogPool::Hide(GINAVIEW view)
+{
+	HWND hWnd = _hWnd;
+	if (!hWnd || view <= GV_NONE || view >= GV_COUNT || !_entries[view].hDlg)
+	{
+		return FALSE;
+	}
+
+	// Sent rather than posted, so a hide can't land after a show that was asked for later
+	SendMessageW(hWnd, WM_POOL_HIDE, view, 0);
+	return TRUE;
+}
+
+void ginaDialogPool::WaitHidden(GINAVIEW view)
+{
+	if (view > GV_NONE && view < GV_COUNT && _entries[view].hHidden)
+	{
+		WaitForSingleObject(_entries[view].hHidden, INFINITE);
+	}
+}
+
+LRESULT CALLBACK ginaDialogPool::WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+	ginaDialogPool* pool = ginaDialogPool::Get();
+	switch (uMsg)
+	{
+	case WM_POOL_WARMUP:
+	{
+		pool->CreateView(&pool->_entries[wParam]);
+		return 0;
+	}
+	case WM_POOL_SHOW:
+	{
+		entry* pEntry = &pool->_entries[wParam];
+		BOOL fWarm = pEntry->hDlg != NULL;
+		HWND hDlg = pool->CreateView(pEntry);
+		if (!hDlg)
+		{
+			return FALSE;
+		}
+
+		// Shown before the callback, which may already hide it again
+		pEntry->fShown = TRUE;
+		ResetEvent(pEntry->hHidden);
+		pEntry->desc.pfnShow(hDlg);
+		dbgprintf(L"CLH_GINA: %s visible in %lld us (%s)", ginaViewState::GetViewName(pEntry->desc.view), ElapsedUs(*(LONGLONG*)lParam),
+			fWarm ? L"pooled" : L"created on demand");
+		return TRUE;
+	}
+	case WM_POOL_HIDE:
+	{
+		entry* pEntry = &pool->_entries[wParam];
+		if (pEntry->fShown)
+		{
+			pEntry->fShown = FALSE;
+			if (pEntry->desc.pfnHide)
+			{
+				pEntry->desc.pfnHide(pEntry->hDlg);
+			}
+			ShowWindow(pEntry->hDlg, SW_HIDE);
+		}
+		SetEvent(pEntry->hHidden);
+		return 0;
+	}
+	case WM_TIMER:
+	{
+		if (wParam == IDT_POOL_BEAT)
+		{
+			for (int i = 0; i < GV_COUNT; i++)
+			{
+				if (pool->_entries[i].fShown)
+				{
+					ginaWatchdog::Get()->Beat((GINAVIEW)i);
+				}
+			}
+		}
+		return 0;
+	}
+	}
+	return DefWindowProcW(hWnd, uMsg, wParam, lParam);
+}
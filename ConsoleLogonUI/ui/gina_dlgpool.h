@@ -0,0 +1,66 @@
+#pragma once
+#include <windows.h>
+#include <atomic>
+#include <vector>
+#include "gina_viewstate.h"
+
+// dwInitParam of pooled dialogs, their WM_INITDIALOG only lays them out and leaves the rest to the show callback
+#define GINA_DLG_POOLED 1
+
+#define WM_POOL_WARMUP (WM_APP + 1) // wParam = view
+#define WM_POOL_SHOW (WM_APP + 2)   // wParam = view, lParam = LONGLONG* QueryPerformanceCounter value the switch started at
+#define WM_POOL_HIDE (WM_APP + 3)   // wParam = view
+
+#define IDT_POOL_BEAT 1
+
+// A view whose dialog is created once and then only shown and hidden
+struct ginaPooledView
+{
+	GINAVIEW view;
+	int resId;
+	DLGPROC pfnDlgProc;
+	HWND* phDlg; // The view's hDlg, set once the dialog exists
+	// Resets the fields and shows the dialog, on the pool thread
+	void (*pfnShow)(HWND hDlg);
+	// Stops whatever only runs while the dialog is shown, may be NULL
+	void (*pfnHide)(HWND hDlg);
+};
+
+// Hidden, laid out dialogs for the views that switch most often, so a switch is a show and a field reset
+// Dialogs belong to the thread that creates them, so the pool has a thread of its own that creates them all and
+// runs their message loop; a view's *_SetActive thread asks it to show the view and waits until it's hidden again,
+// which keeps Enter, Shown and Leave of the view state where they were
+// Dialogs are created one by one once the pool thread is idle, a view shown before that is created on the spot
+class ginaDialogPool
+{
+public:
+	static ginaDialogPool* Get();
+
+	// After LoadGina, once the templates and the config are there
+	void Start(const std::vector<ginaPooledView>& views);
+
+	// FALSE if the view isn't pooled or its dialog can't be created, the view creates its own then
+	BOOL Show(GINAVIEW view);
+	// FALSE if the pool doesn't own the view's dialog
+	BOOL Hide(GINAVIEW view);
+	// Returns once the view has been hidden
+	void WaitHidden(GINAVIEW view);
+
+private:
+	struct entry
+	{
+		BOOL fPooled;
+		ginaPooledView desc;
+		HWND hDlg;
+		BOOL fShown;
+		HANDLE hHidden;
+	};
+
+	ginaDialogPool();
+	void Run(HANDLE hReady);
+	HWND CreateView(entry* pEntry);
+	static LRESULT CALLBACK WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+
+	std::atomic<HWND> _hWnd;
+	entry _entries[GV_COUNT];
+};
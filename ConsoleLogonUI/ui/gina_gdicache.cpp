@@ -0,0 +1,174 @@
+#pragma once
+#include "gina_gdicache.h"
+#include "gina_manager.h"
+#include "util/util.h"
+#include <stddef.h>
+
+ginaGdiCache* ginaGdiCache::Get()
+{
+	static ginaGdiCache cache;
+	return &cache;
+}
+
+HICON ginaGdiCache::AcquireIcon(LPCWSTR lpModule, int id, int size, int dpi, UINT fuLoad)
+{
+	if (!dpi)
+	{
+		HDC hdc = GetDC(NULL);
+		dpi = GetDeviceCaps(hdc, LOGPIXELSY);
+		ReleaseDC(NULL, hdc);
+	}
+
+	entry key = { GCT_ICON, lpModule ? lpModule : L"", id, size, dpi, fuLoad };
+	return (HICON)Acquire(key);
+}
+
+HBITMAP ginaGdiCache::AcquireBitmap(LPCWSTR lpModule, int id)
+{
+	entry key = { GCT_BITMAP, lpModule ? lpModule : L"", id };
+	return (HBITMAP)Acquire(key);
+}
+
+HFONT ginaGdiCache::AcquireFont(const LOGFONTW* plf)
+{
+	entry key = { GCT_FONT };
+	key.lf = *plf;
+	return (HFONT)Acquire(key);
+}
+
+void ginaGdiCache::Release(HANDLE h)
+{
+	if (!h)
+		return;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (entry& e : _entries)
+	{
+		if (e.h == h)
+		{
+			if (e.cRefs > 0)
+				e.cRefs--;
+			return;
+		}
+	}
+}
+
+void ginaGdiCache::ReleaseControlIcon(HWND hCtl)
+{
+	if (hCtl)
+	{
+		Release((HANDLE)SendMessageW(hCtl, STM_SETICON, NULL, 0));
+	}
+}
+
+void ginaGdiCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	int cRefs = 0;
+	for (entry& e : _entries)
+	{
+		cRefs += e.cRefs;
+		if (e.type == GCT_ICON)
+			DestroyIcon((HICON)e.h);
+		else
+			DeleteObject((HGDIOBJ)e.h);
+	}
+	if (!_entries.empty())
+	{
+		dbgprintf(L"CLH_GINA: Freed %d cached GDI objects, %d references were still held", (int)_entries.size(), cRefs);
+	}
+	_entries.clear();
+}
+
+void ginaGdiCache::GetCounts(int* pcObjects, int* pcRefs)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	*pcObjects = (int)_entries.size();
+	*pcRefs = 0;
+	for (const entry& e : _entries)
+	{
+		*pcRefs += e.cRefs;
+	}
+}
+
+HANDLE ginaGdiCache::Acquire(const entry& key)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (entry& e : _entries)
+	{
+		if (Matches(e, key))
+		{
+			e.cRefs++;
+			return e.h;
+		}
+	}
+
+	// Failures aren't cached, a custom image may show up later
+	HANDLE h = Load(key);
+	if (!h)
+		return NULL;
+
+	entry e = key;
+	e.h = h;
+	e.cRefs = 1;
+	_entries.push_back(e);
+	return h;
+}
+
+bool ginaGdiCache::Matches(const entry& a, const entry& b)
+{
+	if (a.type != b.type)
+		return false;
+	if (a.type == GCT_FONT)
+	{
+		return !memcmp(&a.lf, &b.lf, offsetof(LOGFONTW, lfFaceName))
+			&& !_wcsicmp(a.lf.lfFaceName, b.lf.lfFaceName);
+	}
+	return a.id == b.id && a.size == b.size && a.dpi == b.dpi && a.fuLoad == b.fuLoad
+		&& !_wcsicmp(a.module.c_str(), b.module.c_str());
+}
+
+HANDLE ginaGdiCache::Load(const entry& key)
+{
+	if (key.type == GCT_FONT)
+	{
+		return CreateFontIndirectW(&key.lf);
+	}
+
+	HMODULE hModule = ginaManager::Get()->hGinaDll;
+	if (!key.module.empty())
+	{
+		// Data file loads don't go through KnownDLLs, so a bare name would be searched for along the DLL path
+		std::wstring path = key.module;
+		if (path.find(L'\\') == std::wstring::npos)
+		{
+			WCHAR szSystem[MAX_PATH];
+			UINT cch = GetSystemDirectoryW(szSystem, MAX_PATH);
+			if (!cch || cch >= MAX_PATH)
+				return NULL;
+			path = std::wstring(szSystem) + L"\\" + path;
+		}
+		hModule = LoadLibraryExW(path.c_str(), NULL, LOAD_LIBRARY_AS_DATAFILE | LOAD_LIBRARY_AS_IMAGE_RESOURCE);
+	}
+	if (!hModule)
+		return NULL;
+
+	HANDLE h;
+	if (key.type == GCT_BITMAP)
+	{
+		h = LoadBitmapW(hModule, MAKEINTRESOURCEW(key.id));
+	}
+	else
+	{
+		// Never LR_SHARED, the cache owns the icon and destroys it
+		int px = key.size ? MulDiv(key.size, key.dpi, 96) : 0;
+		UINT fuLoad = key.fuLoad | (key.size ? 0 : LR_DEFAULTSIZE);
+		h = LoadImageW(hModule, MAKEINTRESOURCEW(key.id), IMAGE_ICON, px, px, fuLoad & ~LR_SHARED);
+	}
+
+	if (!key.module.empty())
+	{
+		FreeLibrary(hModule);
+	}
+	return h;
+}
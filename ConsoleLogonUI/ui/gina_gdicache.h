@@ -0,0 +1,56 @@
+#pragma once
+#include <windows.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum GDICACHE_TYPE
+{
+	GCT_ICON = 0,
+	GCT_BITMAP,
+	GCT_FONT
+};
+
+// Icons, bitmaps and fonts shared by every view
+// Each object is loaded once and handed out with a reference count; it stays cached when the count drops to 0,
+// so locking and unlocking again doesn't reload anything, and everything is freed at once when msgina.dll is unloaded
+class ginaGdiCache
+{
+public:
+	static ginaGdiCache* Get();
+
+	// lpModule NULL is msgina.dll, any other module is only loaded for as long as it takes to copy the image out
+	// size is in pixels at 96 DPI and gets scaled to dpi (0 for the system DPI); size 0 is the system icon size
+	HICON AcquireIcon(LPCWSTR lpModule, int id, int size, int dpi, UINT fuLoad = LR_DEFAULTCOLOR);
+	HBITMAP AcquireBitmap(LPCWSTR lpModule, int id);
+	HFONT AcquireFont(const LOGFONTW* plf);
+	void Release(HANDLE h);
+	// Takes the icon back off a static control and releases it, does nothing the second time
+	void ReleaseControlIcon(HWND hCtl);
+
+	// Destroys every object, whether it's still referenced or not
+	void Clear();
+	// Objects alive in the cache and the references held on them
+	void GetCounts(int* pcObjects, int* pcRefs);
+
+private:
+	struct entry
+	{
+		GDICACHE_TYPE type;
+		std::wstring module;
+		int id;
+		int size;
+		int dpi;
+		UINT fuLoad;
+		LOGFONTW lf;
+		HANDLE h;
+		int cRefs;
+	};
+
+	HANDLE Acquire(const entry& key);
+	static bool Matches(const entry& a, const entry& b);
+	static HANDLE Load(const entry& key);
+
+	std::mutex _mutex;
+	std::vector<entry> _entries;
+};
@@ -5,7 +5,8 @@
 #include "util/util.h"
 #include "util/interop.h"
 
-#pragma comment(lib, "Version.lib")
+// DPI the branding offset of a dialog was last laid out for
+#define BRANDING_DPI_PROP L"CLH_GINA_BrandDpi"
 
 ginaManager* ginaManager::Get()
 {
@@ -20,6 +21,7 @@ ginaManager::ginaManager()
 	hLargeBranding = NULL;
 	hSmallBranding = NULL;
 	hBar = NULL;
+	_lfBuiltOnNT = { 0 };
 	ginaVersion = 0;
 	initedPreLogon = FALSE;
 	config = {
@@ -42,44 +44,31 @@ void ginaManager::LoadGina()
 	}
 	else
 	{
-		DWORD dwHandle;
-		HRSRC hRes = FindResourceW(hGinaDll, MAKEINTRESOURCEW(1), RT_VERSION);
-		if (hRes)
+		// LOAD_LIBRARY_AS_IMAGE_RESOURCE maps the file laid out like a loaded image, the low bits of the handle only tag it
+		const BYTE* pBase = (const BYTE*)((ULONG_PTR)hGinaDll & ~(ULONG_PTR)3);
+		// msgina.dll is a PE32 image, SizeOfImage sits at the same offset in both header formats
+		PIMAGE_NT_HEADERS32 pNtHeaders = (PIMAGE_NT_HEADERS32)(pBase + ((PIMAGE_DOS_HEADER)pBase)->e_lfanew);
+		uint32_t versionMS, versionLS;
+		if (ginaResources.Open(pBase, pNtHeaders->OptionalHeader.SizeOfImage, true)
+			&& ginaResources.GetFileVersion(&versionMS, &versionLS))
 		{
-			HGLOBAL hGlobal = LoadResource(hGinaDll, hRes);
-			if (hGlobal)
+			int major = HIWORD(versionMS);
+			int minor = LOWORD(versionMS);
+			if (major == 5 && minor == 0)
 			{
-				LPVOID lpData = LockResource(hGlobal);
-				if (lpData)
-				{
-					UINT uLen = SizeofResource(hGinaDll, hRes);
-					if (uLen)
-					{
-						VS_FIXEDFILEINFO* pFileInfo;
-						UINT uFileInfoLen;
-						if (VerQueryValueW(lpData, L"\\", (LPVOID*)&pFileInfo, &uFileInfoLen))
-						{
-							int major = HIWORD(pFileInfo->dwFileVersionMS);
-							int minor = LOWORD(pFileInfo->dwFileVersionMS);
-							if (major == 5 && minor == 0)
-							{
-								ginaVersion = GINA_VER_2K;
-							}
-							else if (major == 5 && (minor == 1 || minor == 2))
-							{
-								ginaVersion = GINA_VER_XP;
-							}
-							else if (major == 4)
-							{
-								ginaVersion = GINA_VER_NT4;
-							}
-							else
-							{
-								ginaVersion = GINA_VER_NT3;
-							}
-						}
-					}
-				}
+				ginaVersion = GINA_VER_2K;
+			}
+			else if (major == 5 && (minor == 1 || minor == 2))
+			{
+				ginaVersion = GINA_VER_XP;
+			}
+			else if (major == 4)
+			{
+				ginaVersion = GINA_VER_NT4;
+			}
+			else
+			{
+				ginaVersion = GINA_VER_NT3;
 			}
 		}
 		if (!ginaVersion || ginaVersion < GINA_VER_NT4)
@@ -87,12 +76,16 @@ void ginaManager::LoadGina()
 			std::thread([] {
 				MessageBoxW(0, L"This version of msgina.dll is not supported in this build of CLH_GINA! Please use a msgina.dll from Windows NT 4.0, 2000, or XP.", L"CLH_GINA", MB_OK | MB_ICONERROR);
 			}).detach();
+			ginaResources.Close();
 			FreeLibrary(hGinaDll);
 			hGinaDll = NULL;
 			return;
 		}
 	}
 
+	// Every view reads its strings from here instead of LoadStringW
+	ginaStrings::Get()->Load(ginaResources);
+
 	// Load branding images
 	wchar_t customBrdLarge[MAX_PATH], customBrd[MAX_PATH], customBar[MAX_PATH];
 	if (GetConfigString(L"CustomBrd", customBrd, MAX_PATH))
@@ -101,7 +94,7 @@ void ginaManager::LoadGina()
 	}
 	if (!hSmallBranding)
 	{
-		hSmallBranding = LoadBitmapW(hGinaDll, MAKEINTRESOURCEW(GINA_BMP_BRD_SMALL));
+		hSmallBranding = ginaGdiCache::Get()->AcquireBitmap(NULL, GINA_BMP_BRD_SMALL);
 	}
 	if (GetConfigString(L"CustomBrdLarge", customBrdLarge, MAX_PATH))
 	{
@@ -110,7 +103,7 @@ void ginaManager::LoadGina()
 	}
 	if (!hLargeBranding)
 	{
-		hLargeBranding = LoadBitmapW(hGinaDll, MAKEINTRESOURCEW(GINA_BMP_BRD));
+		hLargeBranding = ginaGdiCache::Get()->AcquireBitmap(NULL, GINA_BMP_BRD);
 	}
 	if (!hLargeBranding)
 	{
@@ -122,7 +115,7 @@ void ginaManager::LoadGina()
 	}
 	if (!hBar)
 	{
-		hBar = LoadBitmapW(hGinaDll, MAKEINTRESOURCEW(GINA_BMP_BAR));
+		hBar = ginaGdiCache::Get()->AcquireBitmap(NULL, GINA_BMP_BAR);
 	}
 	initedPreLogon = IsSystemUser();
 
@@ -156,26 +149,51 @@ void ginaManager::LoadGina()
 	// Load "Built on NT Technology" text and font
 	if (ginaVersion == GINA_VER_2K)
 	{
-		_szBuiltOnNT[0] = L'\0';
-		LoadStringW(hGinaDll, GINA_STR_BUILT_ON_NT, _szBuiltOnNT, ARRAYSIZE(_szBuiltOnNT));
+		ginaStrings* strings = ginaStrings::Get();
+		wcsncpy_s(_szBuiltOnNT, strings->Text(GINA_STR_BUILT_ON_NT), _TRUNCATE);
+
+		// The fonts themselves are made per DPI with the rest of the branding assets
+		const wchar_t* szHeight = strings->Text(GINA_STR_BUILT_ON_NT_FONT_SIZE, NULL);
+		_lfBuiltOnNT = { 0 };
+		wcsncpy_s(_lfBuiltOnNT.lfFaceName, strings->Text(GINA_STR_BUILT_ON_NT_FONT), _TRUNCATE);
+		_lfBuiltOnNT.lfHeight = szHeight ? -_wtol(szHeight) : 0;
+
+		// Split the <B> markup once instead of on every paint
+		_builtOnNTRuns.clear();
+		ginaTextRun run = { L"", FALSE };
+		LPCWSTR pszText = _szBuiltOnNT;
+		while (*pszText)
+		{
+			BOOL fTag = TRUE, fBold = run.fBold;
+			if (!_wcsnicmp(pszText, L"<B>", 3))
+			{
+				fBold = TRUE;
+				pszText += 3;
+			}
+			else if (!_wcsnicmp(pszText, L"</B>", 4))
+			{
+				fBold = FALSE;
+				pszText += 4;
+			}
+			else
+			{
+				run.text += *pszText++;
+				fTag = FALSE;
+			}
 
-		int iHeight = 0;
-		WCHAR szHeight[10];
-		if (LoadStringW(hGinaDll, GINA_STR_BUILT_ON_NT_FONT_SIZE, szHeight, ARRAYSIZE(szHeight)))
+			if (fTag)
+			{
+				if (!run.text.empty())
+				{
+					_builtOnNTRuns.push_back(run);
+				}
+				run = { L"", fBold };
+			}
+		}
+		if (!run.text.empty())
 		{
-			HDC hdc = GetDC(NULL);
-			iHeight = MulDiv(_wtol(szHeight), GetDeviceCaps(hdc, LOGPIXELSY), 96);
-			ReleaseDC(NULL, hdc);
+			_builtOnNTRuns.push_back(run);
 		}
-
-		LOGFONTW lf = { 0 };
-		lf.lfFaceName[0] = L'\0';
-		LoadStringW(hGinaDll, GINA_STR_BUILT_ON_NT_FONT, lf.lfFaceName, ARRAYSIZE(lf.lfFaceName));
-		lf.lfHeight = -iHeight;
-		_hfontBuiltOnNT = CreateFontIndirectW(&lf);
-
-		lf.lfWeight = FW_BOLD;
-		_hfontBuiltOnNTBold = CreateFontIndirectW(&lf);
 	}
 
 #ifdef SHOWCONSOLE
@@ -215,61 +233,321 @@ void ginaManager::LoadGina()
 	}
 
 	// Last resort to show console if something goes wrong
-	std::thread([] {
-		int cnt = 0;
-		while (true)
+	// Timeouts shorter than a few beats are raised, a healthy loop must never miss its deadline
+	int watchdogTimeout = GetConfigInt(L"WatchdogTimeout", 6000);
+	if (watchdogTimeout > 0 && (unsigned int)watchdogTimeout != ginaWatchdog::GetEffectiveTimeoutMs(watchdogTimeout))
+	{
+		dbgprintf(L"CLH_GINA: WatchdogTimeout %d ms is too short, using %u ms", watchdogTimeout, ginaWatchdog::GetEffectiveTimeoutMs(watchdogTimeout));
+	}
+	ginaWatchdog::Get()->Start(watchdogTimeout > 0 ? watchdogTimeout : 0, [](GINAVIEW view, uint64_t stalledMs) {
+		uint64_t buckets[WATCHDOG_HISTOGRAM_BUCKETS];
+		ginaWatchdog::Get()->GetHistogram(buckets);
+		std::wstring histogram;
+		for (int i = 0; i < WATCHDOG_HISTOGRAM_BUCKETS; i++)
+		{
+			histogram += std::to_wstring(buckets[i]) + L" ";
+		}
+		dbgprintf(L"CLH_GINA: %s stalled for %llu ms, progress gaps (log2 ms): %s", ginaViewState::GetViewName(view), stalledMs, histogram.c_str());
+		int cObjects, cRefs;
+		ginaGdiCache::Get()->GetCounts(&cObjects, &cRefs);
+		dbgprintf(L"CLH_GINA: %d cached GDI objects with %d references, %lu GDI handles in the process", cObjects, cRefs, GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS));
+
+		external::ShowConsoleUI();
+		ginaManager::Get()->config.showConsole = TRUE;
+		int res = MessageBoxW(NULL, L"It seems that something went wrong with CLH_GINA. Console UI has been shown to prevent lockout. Interact with the console to make the console UI to show up.\n\nIf you are not able to interact with the console, press OK to restart the logon process, or press Cancel to restart the computer.", L"CLH_GINA", MB_OKCANCEL | MB_ICONERROR);
+		if (res == IDOK)
 		{
-			HWND hDlg = FindWindow(L"#32770", NULL);
-			if (hDlg && (IsWindowVisible(hDlg) || ginaStatusView::Get()->isActive))
+			ExitProcess(0);
+		}
+		else
+		{
+			EnableShutdownPrivilege();
+			ExitWindowsEx(EWX_REBOOT, 0);
+		}
+	});
+
+	// The views ConsoleLogon switches between most, created hidden ahead of time
+	config.poolDialogs = GetConfigInt(L"PoolDialogs", 1);
+	if (config.poolDialogs)
+	{
+		std::vector<ginaPooledView> views = {
+			{ GV_STATUS, GetRes(GINA_DLG_STATUS_VIEW), (DLGPROC)ginaStatusView::DlgProc, &ginaStatusView::Get()->hDlg, ginaStatusView::PoolShow, ginaStatusView::PoolHide },
+			{ GV_SECURITYCONTROL, GetRes(GINA_DLG_SECURITY_CONTROL), (DLGPROC)ginaSecurityControl::DlgProc, &ginaSecurityControl::Get()->hDlg, ginaSecurityControl::PoolShow, NULL }
+		};
+		ginaDialogPool::Get()->Start(views);
+	}
+}
+
+void ginaManager::UnloadGina()
+{
+	// UI state that's still only in memory
+	FlushConfig();
+
+	if (hGinaDll)
+	{
+		InvalidateBrandingCache();
+		ginaStrings::Get()->Clear();
+
+		// The msgina branding bitmaps and fonts belong to the cache and go with it
+		FreeBrandingAssets();
+		int cObjects, cRefs;
+		ginaGdiCache::Get()->GetCounts(&cObjects, &cRefs);
+		DWORD cGdiBefore = GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS);
+		ginaGdiCache::Get()->Clear();
+		dbgprintf(L"CLH_GINA: Unloading with %d cached GDI objects and %d references, %lu GDI and %lu USER handles in the process (%lu GDI after clearing)",
+			cObjects, cRefs, cGdiBefore, GetGuiResources(GetCurrentProcess(), GR_USEROBJECTS), GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS));
+		hLargeBranding = NULL;
+		hSmallBranding = NULL;
+		hBar = NULL;
+
+		ginaResources.Close();
+		FreeLibrary(hGinaDll);
+	}
+}
+
+BOOL ginaManager::LoadLayout(HWND hDlg, int resId, dlgLayout* pLayout)
+{
+	RECT rcDlg;
+	GetWindowRect(hDlg, &rcDlg);
+
+	peSpan span;
+	dlgTemplate tmpl;
+	if (ginaResources.Find(PE_RT_DIALOG, (uint16_t)resId, &span) && ParseDialogTemplate(span.data, span.size, &tmpl))
+	{
+		// Base units of the dialog's own font
+		RECT rcUnits = { 0, 0, 4, 8 };
+		MapDialogRect(hDlg, &rcUnits);
+		pLayout->Load(tmpl, rcUnits.right, rcUnits.bottom, rcDlg.right - rcDlg.left, rcDlg.bottom - rcDlg.top);
+
+		// The template gives combo boxes the height of their drop-down, the window is only as tall as the edit part
+		for (dlgItem& item : pLayout->GetItems())
+		{
+			RECT rc;
+			HWND hItem = item.classAtom == DLG_CLASS_COMBOBOX ? GetDlgItem(hDlg, item.id) : NULL;
+			if (hItem && GetWindowRect(hItem, &rc))
 			{
-				cnt = 0;
+				item.cy = rc.bottom - rc.top;
 			}
-			else
+		}
+		return TRUE;
+	}
+
+	// No template to go by, read the controls back as they are
+	dbgprintf(L"CLH_GINA: Couldn't parse dialog template %d, laying it out from its windows", resId);
+	pLayout->Load(dlgTemplate{}, 4, 8, rcDlg.right - rcDlg.left, rcDlg.bottom - rcDlg.top);
+	for (HWND hChild = GetWindow(hDlg, GW_CHILD); hChild; hChild = GetWindow(hChild, GW_HWNDNEXT))
+	{
+		RECT rc;
+		GetWindowRect(hChild, &rc);
+		MapWindowPoints(HWND_DESKTOP, hDlg, (LPPOINT)&rc, 2);
+
+		dlgItem item = {};
+		item.id = (uint32_t)GetDlgCtrlID(hChild);
+		item.style = (uint32_t)GetWindowLongW(hChild, GWL_STYLE);
+		item.x = rc.left;
+		item.y = rc.top;
+		item.cx = rc.right - rc.left;
+		item.cy = rc.bottom - rc.top;
+		pLayout->Add(item);
+	}
+	return FALSE;
+}
+
+void ginaManager::ApplyLayout(HWND hDlg, dlgLayout* pLayout)
+{
+	std::vector<dlgItem>& items = pLayout->GetItems();
+	int cChanged = 0;
+	for (const dlgItem& item : items)
+	{
+		if (item.fChanged)
+			cChanged++;
+	}
+
+	if (cChanged)
+	{
+		HDWP hdwp = BeginDeferWindowPos(cChanged);
+
+		// Children are created in template order, so walk both together and only look a control up by id when they disagree
+		HWND hChild = GetWindow(hDlg, GW_CHILD);
+		for (dlgItem& item : items)
+		{
+			HWND hItem = hChild;
+			if (!hItem || (WORD)GetDlgCtrlID(hItem) != (WORD)item.id)
 			{
-				cnt++;
+				hItem = GetDlgItem(hDlg, item.id);
 			}
-			if (cnt > 3)
+			if (hItem)
 			{
-				external::ShowConsoleUI();
-				ginaManager::Get()->config.showConsole = TRUE;
-				int res = MessageBoxW(NULL, L"It seems that something went wrong with CLH_GINA. Console UI has been shown to prevent lockout. Interact with the console to make the console UI to show up.\n\nIf you are not able to interact with the console, press OK to restart the logon process, or press Cancel to restart the computer.", L"CLH_GINA", MB_OKCANCEL | MB_ICONERROR);
-				if (res == IDOK)
-				{
-					ExitProcess(0);
-				}
-				else
-				{
-					EnableShutdownPrivilege();
-					ExitWindowsEx(EWX_REBOOT, 0);
-				}
+				hChild = GetWindow(hItem, GW_HWNDNEXT);
+			}
+			if (!hItem || !item.fChanged)
+				continue;
+
+			UINT flags = SWP_NOZORDER | SWP_NOSIZE | SWP_NOACTIVATE | (item.fHidden ? SWP_HIDEWINDOW : 0);
+			if (hdwp)
+			{
+				hdwp = DeferWindowPos(hdwp, hItem, NULL, item.x, item.y, 0, 0, flags);
 			}
-			Sleep(2000);
+			if (!hdwp)
+			{
+				// Out of memory for the batch, fall back to moving one at a time
+				SetWindowPos(hItem, NULL, item.x, item.y, 0, 0, flags);
+			}
+			item.fChanged = false;
 		}
-	}).detach();
+
+		if (hdwp)
+		{
+			EndDeferWindowPos(hdwp);
+		}
+	}
+
+	// The dialog has a different parent than its controls, so it can't go in the same batch
+	if (pLayout->IsResized())
+	{
+		SetWindowPos(hDlg, NULL, 0, 0, pLayout->GetWidth(), pLayout->GetHeight(), SWP_NOZORDER | SWP_NOMOVE | SWP_NOACTIVATE);
+	}
 }
 
-void ginaManager::UnloadGina()
+// Copies hbm into a 32bpp DIB section of cx by cy
+static HBITMAP ScaleBrandingBitmap(HBITMAP hbm, int cx, int cy)
 {
-	if (hGinaDll)
+	BITMAP bm;
+	if (!hbm || !GetObjectW(hbm, sizeof(bm), &bm) || bm.bmWidth <= 0 || bm.bmHeight <= 0 || cx <= 0 || cy <= 0)
+		return NULL;
+
+	BITMAPINFO bmi = { 0 };
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = bm.bmWidth;
+	bmi.bmiHeader.biHeight = -bm.bmHeight;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	std::vector<uint8_t> pixels((size_t)bm.bmWidth * bm.bmHeight * 4);
+	HDC hdc = GetDC(NULL);
+	BOOL fRead = GetDIBits(hdc, hbm, 0, bm.bmHeight, pixels.data(), &bmi, DIB_RGB_COLORS) == bm.bmHeight;
+
+	void* pvBits = NULL;
+	bmi.bmiHeader.biWidth = cx;
+	bmi.bmiHeader.biHeight = -cy;
+	HBITMAP hbmScaled = fRead ? CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &pvBits, NULL, 0) : NULL;
+	ReleaseDC(NULL, hdc);
+	if (!hbmScaled)
+		return NULL;
+
+	imageView src = { pixels.data(), bm.bmWidth, bm.bmHeight, bm.bmWidth * 4 };
+	imageView dst = { (uint8_t*)pvBits, cx, cy, cx * 4 };
+	Resample(src, dst, 0, 0, cx, cy, RF_LANCZOS3, 1);
+	GdiFlush();
+	return hbmScaled;
+}
+
+ginaBrandingAssets ginaManager::GetBrandingAssets(int dpi)
+{
+	std::lock_guard<std::mutex> lock(_assetsMutex);
+	for (const ginaBrandingAssets& assets : _brandingAssets)
 	{
-		FreeLibrary(hGinaDll);
+		if (assets.dpi == dpi)
+			return assets;
+	}
+
+	ginaBrandingAssets assets = { dpi, hLargeBranding, hSmallBranding, hBar, _sizeLargeBrand, _sizeSmallBrand, _sizeBar };
+	if (dpi != 96)
+	{
+		SIZE* psizes[] = { &assets.sizeLargeBrand, &assets.sizeSmallBrand, &assets.sizeBar };
+		for (SIZE* psize : psizes)
+		{
+			psize->cx = MulDiv(psize->cx, dpi, 96);
+			psize->cy = MulDiv(psize->cy, dpi, 96);
+		}
+
+		// Keep the loaded image if scaling fails, a misplaced header beats none
+		HBITMAP hbm = ScaleBrandingBitmap(hSmallBranding, assets.sizeSmallBrand.cx, assets.sizeSmallBrand.cy);
+		assets.hSmallBranding = hbm ? hbm : hSmallBranding;
+		if (hLargeBranding == hSmallBranding)
+		{
+			assets.hLargeBranding = assets.hSmallBranding;
+		}
+		else
+		{
+			hbm = ScaleBrandingBitmap(hLargeBranding, assets.sizeLargeBrand.cx, assets.sizeLargeBrand.cy);
+			assets.hLargeBranding = hbm ? hbm : hLargeBranding;
+		}
+		hbm = ScaleBrandingBitmap(hBar, assets.sizeBar.cx, assets.sizeBar.cy);
+		assets.hBar = hbm ? hbm : hBar;
 	}
+
+	if (_lfBuiltOnNT.lfFaceName[0])
+	{
+		LOGFONTW lf = _lfBuiltOnNT;
+		lf.lfHeight = MulDiv(lf.lfHeight, dpi, 96);
+		assets.hfontBuiltOnNT = ginaGdiCache::Get()->AcquireFont(&lf);
+		lf.lfWeight = FW_BOLD;
+		assets.hfontBuiltOnNTBold = ginaGdiCache::Get()->AcquireFont(&lf);
+	}
+
+	dbgprintf(L"CLH_GINA: Built branding assets for %d DPI", dpi);
+	_brandingAssets.push_back(assets);
+	return assets;
 }
 
-void ginaManager::MoveChildrenForBranding(HWND hwnd, BOOL fLarge)
+void ginaManager::FreeBrandingAssets()
+{
+	std::lock_guard<std::mutex> lock(_assetsMutex);
+	for (ginaBrandingAssets& assets : _brandingAssets)
+	{
+		// Only the scaled copies are owned here
+		if (assets.hSmallBranding != hSmallBranding)
+			DeleteObject(assets.hSmallBranding);
+		if (assets.hLargeBranding != hLargeBranding && assets.hLargeBranding != assets.hSmallBranding)
+			DeleteObject(assets.hLargeBranding);
+		if (assets.hBar != hBar)
+			DeleteObject(assets.hBar);
+		ginaGdiCache::Get()->Release(assets.hfontBuiltOnNT);
+		ginaGdiCache::Get()->Release(assets.hfontBuiltOnNTBold);
+	}
+	_brandingAssets.clear();
+}
+
+int ginaManager::GetBrandingHeight(BOOL fLarge, int dpi)
+{
+	ginaBrandingAssets assets = GetBrandingAssets(dpi);
+	return assets.sizeBar.cy + (fLarge ? assets.sizeLargeBrand.cy : assets.sizeSmallBrand.cy);
+}
+
+void ginaManager::MoveChildren(HWND hwnd, int dy)
 {
 	RECT rc;
-	int dy = _sizeBar.cy + (fLarge ? _sizeLargeBrand.cy : _sizeSmallBrand.cy);
+	int cChildren = 0;
+	for (HWND hwndSibling = GetWindow(hwnd, GW_CHILD); hwndSibling; hwndSibling = GetWindow(hwndSibling, GW_HWNDNEXT))
+	{
+		cChildren++;
+	}
 
+	HDWP hdwp = BeginDeferWindowPos(cChildren);
 	for (HWND hwndSibling = GetWindow(hwnd, GW_CHILD); hwndSibling; hwndSibling = GetWindow(hwndSibling, GW_HWNDNEXT))
 	{
 		GetWindowRect(hwndSibling, &rc);
 		MapWindowPoints(NULL, hwnd, (LPPOINT)&rc, 2);
 		OffsetRect(&rc, 0, dy);
 
-		SetWindowPos(hwndSibling, NULL,
-			rc.left, rc.top, 0, 0,
-			SWP_NOZORDER | SWP_NOSIZE);
+		if (hdwp)
+		{
+			hdwp = DeferWindowPos(hdwp, hwndSibling, NULL,
+				rc.left, rc.top, 0, 0,
+				SWP_NOZORDER | SWP_NOSIZE | SWP_NOACTIVATE);
+		}
+		if (!hdwp)
+		{
+			SetWindowPos(hwndSibling, NULL,
+				rc.left, rc.top, 0, 0,
+				SWP_NOZORDER | SWP_NOSIZE | SWP_NOACTIVATE);
+		}
+	}
+	if (hdwp)
+	{
+		EndDeferWindowPos(hdwp);
 	}
 
 	GetWindowRect(hwnd, &rc);
@@ -280,16 +558,146 @@ void ginaManager::MoveChildrenForBranding(HWND hwnd, BOOL fLarge)
 		SWP_NOZORDER | SWP_NOMOVE);
 }
 
-void ginaManager::PaintBranding(HDC hdc, RECT *prc, BOOL fLarge /* = FALSE */, int iBarOffset /* = 0 */)
+void ginaManager::MoveChildrenForBranding(HWND hwnd, BOOL fLarge)
 {
-	HBITMAP hbm = fLarge ? hLargeBranding : hSmallBranding;
-	PSIZE psize = fLarge ? &_sizeLargeBrand : &_sizeSmallBrand;
-	HDC hdcMem = CreateCompatibleDC(hdc);
+	int dpi = GetWindowDpi(hwnd);
+	MoveChildren(hwnd, GetBrandingHeight(fLarge, dpi));
+	SetPropW(hwnd, BRANDING_DPI_PROP, (HANDLE)(INT_PTR)dpi);
+}
 
-	// Paint BG color
-	RECT rcFill = *prc;
-	rcFill.bottom = rcFill.top + psize->cy;
+void ginaManager::MoveChildrenForBranding(HWND hwnd, dlgLayout* pLayout, BOOL fLarge)
+{
+	int dpi = GetWindowDpi(hwnd);
+	int dy = GetBrandingHeight(fLarge, dpi);
+	pLayout->OffsetAll(0, dy);
+	pLayout->Resize(0, dy);
+	SetPropW(hwnd, BRANDING_DPI_PROP, (HANDLE)(INT_PTR)dpi);
+}
 
+void ginaManager::OnDpiChanged(HWND hwnd, WPARAM wParam, LPARAM lParam, BOOL fLarge)
+{
+	int dpiOld = (int)(INT_PTR)GetPropW(hwnd, BRANDING_DPI_PROP);
+	int dpiNew = HIWORD(wParam);
+	RECT* prcNew = (RECT*)lParam;
+	SetWindowPos(hwnd, NULL,
+		prcNew->left, prcNew->top,
+		prcNew->right - prcNew->left, prcNew->bottom - prcNew->top,
+		SWP_NOZORDER | SWP_NOACTIVATE);
+
+	if (dpiOld && dpiNew && dpiOld != dpiNew)
+	{
+		// Per-monitor v2 dialogs get their children rescaled by the system, the branding offset along with them,
+		// so only the rounding difference is left to fix; otherwise the whole old offset is still in place
+		typedef DPI_AWARENESS_CONTEXT(WINAPI* lpGetThreadDpiAwarenessContext)(void);
+		typedef BOOL(WINAPI* lpAreDpiAwarenessContextsEqual)(DPI_AWARENESS_CONTEXT, DPI_AWARENESS_CONTEXT);
+		static HMODULE hUser32 = GetModuleHandleW(L"user32.dll");
+		static lpGetThreadDpiAwarenessContext GetThreadDpiAwarenessContextW10
+			= (lpGetThreadDpiAwarenessContext)GetProcAddress(hUser32, "GetThreadDpiAwarenessContext");
+		static lpAreDpiAwarenessContextsEqual AreDpiAwarenessContextsEqualW10
+			= (lpAreDpiAwarenessContextsEqual)GetProcAddress(hUser32, "AreDpiAwarenessContextsEqual");
+
+		int dyOld = GetBrandingHeight(fLarge, dpiOld);
+		if (GetThreadDpiAwarenessContextW10 && AreDpiAwarenessContextsEqualW10
+			&& AreDpiAwarenessContextsEqualW10(GetThreadDpiAwarenessContextW10(), DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2))
+		{
+			dyOld = MulDiv(dyOld, dpiNew, dpiOld);
+		}
+
+		int dy = GetBrandingHeight(fLarge, dpiNew) - dyOld;
+		if (dy)
+		{
+			MoveChildren(hwnd, dy);
+		}
+		SetPropW(hwnd, BRANDING_DPI_PROP, (HANDLE)(INT_PTR)dpiNew);
+		dbgprintf(L"CLH_GINA: Branding moved from %d to %d DPI, children shifted by %d", dpiOld, dpiNew, dy);
+	}
+
+	InvalidateRect(hwnd, NULL, TRUE);
+}
+
+void ginaManager::PaintBranding(HDC hdc, RECT *prc, BOOL fLarge /* = FALSE */, int dpi /* = 0 */)
+{
+	int cx = prc->right - prc->left;
+	if (cx <= 0)
+		return;
+
+	if (!dpi)
+	{
+		HWND hwnd = WindowFromDC(hdc);
+		dpi = hwnd ? GetWindowDpi(hwnd) : GetDeviceCaps(hdc, LOGPIXELSX);
+	}
+	ginaBrandingAssets assets = GetBrandingAssets(dpi);
+	PSIZE psize = fLarge ? &assets.sizeLargeBrand : &assets.sizeSmallBrand;
+
+	std::lock_guard<std::mutex> lock(_brandingMutex);
+
+	ginaBrandingSurface* pSurface = NULL;
+	for (ginaBrandingSurface& surface : _brandingCache)
+	{
+		if (surface.cx == cx && surface.fLarge == fLarge && surface.dpi == dpi)
+		{
+			pSurface = &surface;
+			break;
+		}
+	}
+
+	if (!pSurface)
+	{
+		// Dialogs only come in a few widths, don't let odd sizes pile up
+		if (_brandingCache.size() >= 8)
+		{
+			ginaBrandingSurface& oldest = _brandingCache.front();
+			SelectObject(oldest.hdc, oldest.hbmOld);
+			DeleteObject(oldest.hbm);
+			DeleteDC(oldest.hdc);
+			_brandingCache.erase(_brandingCache.begin());
+		}
+
+		ginaBrandingSurface surface = { cx, fLarge, dpi, NULL, NULL, NULL };
+		if (!RenderBranding(hdc, &surface))
+			return;
+		_brandingCache.push_back(surface);
+		pSurface = &_brandingCache.back();
+	}
+
+	// The status view draws its moving bar over this itself
+	BitBlt(hdc, prc->left, prc->top, cx, psize->cy + assets.sizeBar.cy, pSurface->hdc, 0, 0, SRCCOPY);
+}
+
+BOOL ginaManager::RenderBranding(HDC hdcRef, ginaBrandingSurface* pSurface)
+{
+	ginaBrandingAssets assets = GetBrandingAssets(pSurface->dpi);
+	HBITMAP hbm = pSurface->fLarge ? assets.hLargeBranding : assets.hSmallBranding;
+	PSIZE psize = pSurface->fLarge ? &assets.sizeLargeBrand : &assets.sizeSmallBrand;
+	int cx = pSurface->cx;
+	int cy = psize->cy + assets.sizeBar.cy;
+
+	BITMAPINFO bmi = { 0 };
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = cx;
+	bmi.bmiHeader.biHeight = -cy;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	void* pvBits;
+	pSurface->hdc = CreateCompatibleDC(hdcRef);
+	pSurface->hbm = CreateDIBSection(hdcRef, &bmi, DIB_RGB_COLORS, &pvBits, NULL, 0);
+	if (!pSurface->hdc || !pSurface->hbm)
+	{
+		if (pSurface->hbm)
+			DeleteObject(pSurface->hbm);
+		if (pSurface->hdc)
+			DeleteDC(pSurface->hdc);
+		return FALSE;
+	}
+	pSurface->hbmOld = (HBITMAP)SelectObject(pSurface->hdc, pSurface->hbm);
+
+	HDC hdc = pSurface->hdc;
+	HDC hdcMem = CreateCompatibleDC(hdcRef);
+
+	// Paint BG color
+	RECT rcFill = { 0, 0, cx, psize->cy };
 	HBRUSH hbrFill = CreateSolidBrush(_crBrandBG);
 	FillRect(hdc, &rcFill, hbrFill);
 	DeleteObject(hbrFill);
@@ -297,7 +705,7 @@ void ginaManager::PaintBranding(HDC hdc, RECT *prc, BOOL fLarge /* = FALSE */, i
 	// Paint brand image
 	int xBrand = 0;
 	if (_fCenterBrand)
-		xBrand = ((prc->right - prc->left) - psize->cx) / 2;
+		xBrand = (cx - psize->cx) / 2;
 
 	HBITMAP hbmOld = (HBITMAP)SelectObject(hdcMem, hbm);
 	BitBlt(
@@ -312,88 +720,53 @@ void ginaManager::PaintBranding(HDC hdc, RECT *prc, BOOL fLarge /* = FALSE */, i
 	SelectObject(hdcMem, hbmOld);
 
 	// Paint bar image
-	hbmOld = (HBITMAP)SelectObject(hdcMem, hBar);
+	hbmOld = (HBITMAP)SelectObject(hdcMem, assets.hBar);
 	StretchBlt(
 		hdc,
-		iBarOffset, psize->cy,
-		prc->right - prc->left,
-		_sizeBar.cy,
+		0, psize->cy,
+		cx,
+		assets.sizeBar.cy,
 		hdcMem,
 		0, 0,
-		_sizeBar.cx,
-		_sizeBar.cy,
+		assets.sizeBar.cx,
+		assets.sizeBar.cy,
 		SRCCOPY
 	);
-	if (iBarOffset)
-	{
-		StretchBlt(
-			hdc,
-			iBarOffset - (prc->right - prc->left), psize->cy,
-			prc->right - prc->left,
-			_sizeBar.cy,
-			hdcMem,
-			0, 0,
-			_sizeBar.cx,
-			_sizeBar.cy,
-			SRCCOPY
-		);
-	}
 	SelectObject(hdcMem, hbmOld);
+	DeleteDC(hdcMem);
 
 	// Paint "Built on NT Technology" text
-	if (fLarge && _szBuiltOnNT[0] && _hfontBuiltOnNT)
+	if (pSurface->fLarge && !_builtOnNTRuns.empty() && assets.hfontBuiltOnNT)
 	{
-		int x = prc->left + xBrand + MulDiv(186, GetDeviceCaps(hdc, LOGPIXELSX), 96);
-		int y = prc->top + MulDiv(68, GetDeviceCaps(hdc, LOGPIXELSY), 96);
+		int x = xBrand + MulDiv(186, pSurface->dpi, 96);
+		int y = MulDiv(68, pSurface->dpi, 96);
 		MoveToEx(hdc, x, y, nullptr);
 
 		UINT uAlignOld = SetTextAlign(hdc, TA_UPDATECP);
-		HFONT hfontOld = (HFONT)SelectObject(hdc, _hfontBuiltOnNT);
-
-		LPWSTR pszText = _szBuiltOnNT;
-		LPWSTR pszCurText = pszText;
-		int iChunkLength = 0;
-		BOOL fBold = FALSE;
-		BOOL fStillDrawing = TRUE;
-		do
+		HFONT hfontOld = (HFONT)SelectObject(hdc, assets.hfontBuiltOnNT);
+		for (const ginaTextRun& run : _builtOnNTRuns)
 		{
-			BOOL fPaint = TRUE;
-			if (!_wcsnicmp(pszText, L"<B>", 3))
-			{
-				fBold = TRUE;
-				pszText += 3;
-			}
-			else if (!_wcsnicmp(pszText, L"</B>", 4))
-			{
-				fBold = FALSE;
-				pszText += 4;
-			}
-			else if (*pszText)
-			{
-				iChunkLength++;
-				pszText++;
-				fPaint = FALSE;
-			}
-			else
-			{
-				fStillDrawing = FALSE;
-			}
-
-			if (fPaint)
-			{
-				TextOutW(hdc, 0, 0, pszCurText, iChunkLength);
-				iChunkLength = 0;
-				pszCurText = pszText;
-				SelectObject(hdc, fBold ? _hfontBuiltOnNTBold : _hfontBuiltOnNT);
-			}
+			SelectObject(hdc, run.fBold && assets.hfontBuiltOnNTBold ? assets.hfontBuiltOnNTBold : assets.hfontBuiltOnNT);
+			TextOutW(hdc, 0, 0, run.text.c_str(), (int)run.text.length());
 		}
-		while (fStillDrawing);
-
 		SelectObject(hdc, hfontOld);
 		SetTextAlign(hdc, uAlignOld);
 	}
 
-	DeleteDC(hdcMem);
+	GdiFlush();
+	return TRUE;
+}
+
+void ginaManager::InvalidateBrandingCache()
+{
+	std::lock_guard<std::mutex> lock(_brandingMutex);
+	for (ginaBrandingSurface& surface : _brandingCache)
+	{
+		SelectObject(surface.hdc, surface.hbmOld);
+		DeleteObject(surface.hbm);
+		DeleteDC(surface.hdc);
+	}
+	_brandingCache.clear();
 }
 
 void ginaManager::CloseAllDialogs()
@@ -407,6 +780,8 @@ void ginaManager::CloseAllDialogs()
 
 void ginaManager::PostThemeChange()
 {
+	InvalidateBrandingCache();
+
 	HWND hWnds[] = {
 		wallHost::Get()->hWnd,
 		ginaSelectedCredentialView::Get()->hDlg,
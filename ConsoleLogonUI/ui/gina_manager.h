@@ -1,5 +1,11 @@
 #pragma once
 #include <windows.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include "util/pe_resources.h"
+#include "util/dlg_template.h"
+#include "gina_strings.h"
 
 //#define SHOWCONSOLE
 
@@ -51,6 +57,10 @@
 #include "gina_selectedcredentialview.h"
 #include "gina_statusview.h"
 #include "gina_securitycontrol.h"
+#include "gina_viewstate.h"
+#include "gina_gdicache.h"
+#include "gina_watchdog.h"
+#include "gina_dlgpool.h"
 
 enum WINDOWTHEME
 {
@@ -60,11 +70,42 @@ enum WINDOWTHEME
 	WT_COUNT
 };
 
+// Piece of the "Built on NT Technology" text, split at its <B> markup
+struct ginaTextRun {
+	std::wstring text;
+	BOOL fBold;
+};
+
+// Branding images and text fonts for one DPI, scaled once with the resampler so painting never stretches them
+// At 96 DPI the images are the loaded ones
+struct ginaBrandingAssets {
+	int dpi;
+	HBITMAP hLargeBranding;
+	HBITMAP hSmallBranding;
+	HBITMAP hBar;
+	SIZE sizeLargeBrand;
+	SIZE sizeSmallBrand;
+	SIZE sizeBar;
+	HFONT hfontBuiltOnNT;
+	HFONT hfontBuiltOnNTBold;
+};
+
+// Fully painted branding header (background, brand, bar and text) for one dialog width
+struct ginaBrandingSurface {
+	int cx;
+	BOOL fLarge;
+	int dpi;
+	HDC hdc;
+	HBITMAP hbm;
+	HBITMAP hbmOld;
+};
+
 struct ginaConfig {
 	BOOL showConsole;
 	WINDOWTHEME classicTheme;
 	BOOL hideStatusView;
 	BOOL hideCapsLockBalloon;
+	BOOL poolDialogs;
 };
 
 class ginaManager
@@ -72,7 +113,10 @@ class ginaManager
 public:
 	HINSTANCE hInstance;
 	HMODULE hGinaDll;
+	// Index over the mapped msgina.dll image, valid while hGinaDll is loaded
+	peResources ginaResources;
 
+	// As loaded, sizes are at 96 DPI; paint with GetBrandingAssets instead
 	HBITMAP  hLargeBranding;
 	HBITMAP  hSmallBranding;
 	HBITMAP  hBar;
@@ -82,9 +126,14 @@ public:
 	COLORREF _crBrandBG;
 	BOOL     _fCenterBrand;
 
-	HFONT _hfontBuiltOnNT;
-	HFONT _hfontBuiltOnNTBold;
+	LOGFONTW _lfBuiltOnNT; // lfHeight at 96 DPI, no face name without the text
 	WCHAR _szBuiltOnNT[MAX_PATH];
+	std::vector<ginaTextRun> _builtOnNTRuns;
+
+	std::mutex _brandingMutex;
+	std::vector<ginaBrandingSurface> _brandingCache;
+	std::mutex _assetsMutex;
+	std::vector<ginaBrandingAssets> _brandingAssets;
 
 	int ginaVersion;
 
@@ -99,11 +148,27 @@ public:
 	void LoadGina();
 	void UnloadGina();
 
+	// Controls of a dialog made from msgina template resId, laid out in memory and moved in one batch by ApplyLayout
+	BOOL LoadLayout(HWND hDlg, int resId, dlgLayout* pLayout);
+	void ApplyLayout(HWND hDlg, dlgLayout* pLayout);
+
+	ginaBrandingAssets GetBrandingAssets(int dpi);
+	int GetBrandingHeight(BOOL fLarge, int dpi);
 	void MoveChildrenForBranding(HWND hwnd, BOOL fLarge);
-	void PaintBranding(HDC hdc, RECT *prc, BOOL fLarge = FALSE, int iBarOffset = 0);
+	void MoveChildrenForBranding(HWND hwnd, dlgLayout* pLayout, BOOL fLarge);
+	// dpi 0 takes it from the window hdc belongs to
+	void PaintBranding(HDC hdc, RECT *prc, BOOL fLarge = FALSE, int dpi = 0);
+	void InvalidateBrandingCache();
+	// WM_DPICHANGED of a dialog with branding
+	void OnDpiChanged(HWND hwnd, WPARAM wParam, LPARAM lParam, BOOL fLarge);
 
 	void CloseAllDialogs();
 	void PostThemeChange();
+
+private:
+	BOOL RenderBranding(HDC hdcRef, ginaBrandingSurface* pSurface);
+	void FreeBrandingAssets();
+	void MoveChildren(HWND hwnd, int dy);
 };
 
 int GetRes(int nt4, int xp = -1);
@@ -13,7 +13,6 @@ std::vector<MessageOptionControlWrapper> controls;
 
 std::wstring gMessage;
 
-std::atomic<bool> isMessageViewActive(false);
 std::mutex messageViewMutex;
 
 void external::MessageView_SetActive()
@@ -24,14 +23,16 @@ void external::MessageView_SetActive()
 	}
 
 	std::thread([=] {
-		if (isMessageViewActive.exchange(true)) {
+		GINATRANSITION transition = ginaViewState::Get()->Enter(GV_MESSAGE);
+		if (transition == GT_DENY) {
 			return;
 		}
 
-		ginaManager::Get()->CloseAllDialogs();
+		if (transition == GT_REPLACE) {
+			ginaManager::Get()->CloseAllDialogs();
+		}
 
-		wchar_t title[256];
-		LoadStringW(ginaManager::Get()->hGinaDll, GINA_STR_LOGON_MESSAGE_TITLE, title, 256);
+		const wchar_t* title = ginaStrings::Get()->Text(GINA_STR_LOGON_MESSAGE_TITLE);
 		
 		int btnCount = controls.size();
 		int res = 0;
@@ -49,6 +50,10 @@ void external::MessageView_SetActive()
 				}).detach();
 		}
 
+		// MessageBoxW only returns once dismissed, so this is as close to visible as we get
+		ginaViewState::Get()->Shown(GV_MESSAGE);
+		// Beats from the message box's own loop
+		ginaWatchdogBeat beat(GV_MESSAGE);
 		long mbIcon = ginaManager::Get()->ginaVersion == GINA_VER_NT4 ? MB_ICONERROR : MB_ICONEXCLAMATION;
 		if (btnCount <= 1)
 		{
@@ -82,7 +87,7 @@ void external::MessageView_SetActive()
 		{
 			ShowConsoleUI();
 		}
-		isMessageViewActive = false;
+		ginaViewState::Get()->Leave(GV_MESSAGE);
 	}).detach();
 }
 
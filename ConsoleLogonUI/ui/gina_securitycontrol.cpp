@@ -35,16 +35,27 @@ void external::SecurityControl_ButtonsReady()
 	ginaManager::Get()->CloseAllDialogs();
 
 	std::thread([=] {
-		if (ginaSecurityControl::Get()->isActive.exchange(true)) {
+		GINATRANSITION transition = ginaViewState::Get()->Enter(GV_SECURITYCONTROL);
+		if (transition == GT_DENY) {
 			return;
 		}
 
-		ginaManager::Get()->CloseAllDialogs();
+		if (transition == GT_REPLACE) {
+			ginaManager::Get()->CloseAllDialogs();
+		}
+
+		if (ginaDialogPool::Get()->Show(GV_SECURITYCONTROL)) {
+			ginaViewState::Get()->Shown(GV_SECURITYCONTROL);
+			ginaDialogPool::Get()->WaitHidden(GV_SECURITYCONTROL);
+			ginaViewState::Get()->Leave(GV_SECURITYCONTROL);
+			return;
+		}
 
 		ginaSecurityControl::Get()->Create();
 		ginaSecurityControl::Get()->Show();
+		ginaViewState::Get()->Shown(GV_SECURITYCONTROL);
 		ginaSecurityControl::Get()->BeginMessageLoop();
-		ginaSecurityControl::Get()->isActive = false;
+		ginaViewState::Get()->Leave(GV_SECURITYCONTROL);
 	}).detach();
 }
 
@@ -73,6 +84,11 @@ void ginaSecurityControl::Create()
 
 void ginaSecurityControl::Destroy()
 {
+	// The pooled dialog is kept for the next time
+	if (ginaDialogPool::Get()->Hide(GV_SECURITYCONTROL))
+	{
+		return;
+	}
 	ginaSecurityControl* dlg = ginaSecurityControl::Get();
 	EndDialog(dlg->hDlg, 0);
 	PostMessage(dlg->hDlg, WM_DESTROY, 0, 0);
@@ -92,10 +108,35 @@ void ginaSecurityControl::Hide()
 	ShowWindow(dlg->hDlg, SW_HIDE);
 }
 
+void ginaSecurityControl::PoolShow(HWND hDlg)
+{
+	// The logged on user may have changed since the dialog was last up
+	UpdateInfo(hDlg);
+	Show();
+}
+
+void ginaSecurityControl::UpdateInfo(HWND hDlg)
+{
+	WCHAR _wszUserName[MAX_PATH], _wszDomainName[MAX_PATH];
+	WCHAR szText[1024];
+	GetLoggedOnUserInfo(_wszUserName, MAX_PATH, _wszDomainName, MAX_PATH);
+	swprintf_s(szText, ginaStrings::Get()->Text(GINA_STR_LOGON_NAME), _wszUserName, _wszDomainName, _wszUserName);
+	SetDlgItemTextW(hDlg, GetRes(IDC_SECURITY_LOGONNAME), szText);
+
+	SYSTEMTIME _logonTime;
+	WCHAR szDate[128], szTime[128], szDateText[256];
+	GetUserLogonTime(&_logonTime);
+	GetDateFormatEx(LOCALE_NAME_USER_DEFAULT, NULL, &_logonTime, NULL, szDate, 128, NULL);
+	GetTimeFormatEx(LOCALE_NAME_USER_DEFAULT, NULL, &_logonTime, NULL, szTime, 128);
+	swprintf_s(szDateText, L"%s %s", szDate, szTime);
+	SetDlgItemTextW(hDlg, GetRes(IDC_SECURITY_DATE), szDateText);
+}
+
 void ginaSecurityControl::BeginMessageLoop()
 {
 	ginaSecurityControl* dlg = ginaSecurityControl::Get();
 	MSG msg;
+	ginaWatchdogBeat beat(GV_SECURITYCONTROL);
 	while (GetMessageW(&msg, NULL, 0, 0))
 	{
 		if (!IsDialogMessageW(dlg->hDlg, &msg))
@@ -112,22 +153,12 @@ int CALLBACK ginaSecurityControl::DlgProc(HWND hWnd, UINT message, WPARAM wParam
 	{
 	case WM_INITDIALOG:
 	{
-		ginaManager::Get()->CloseAllDialogs();
-
-		WCHAR _wszUserName[MAX_PATH], _wszDomainName[MAX_PATH];
-		WCHAR szFormat[256], szText[1024];
-		GetLoggedOnUserInfo(_wszUserName, MAX_PATH, _wszDomainName, MAX_PATH);
-		LoadStringW(ginaManager::Get()->hGinaDll, GINA_STR_LOGON_NAME, szFormat, 256);
-		swprintf_s(szText, szFormat, _wszUserName, _wszDomainName, _wszUserName);
-		SetDlgItemTextW(hWnd, GetRes(IDC_SECURITY_LOGONNAME), szText);
-
-		SYSTEMTIME _logonTime;
-		WCHAR szDate[128], szTime[128], szDateText[256];
-		GetUserLogonTime(&_logonTime);
-		GetDateFormatEx(LOCALE_NAME_USER_DEFAULT, NULL, &_logonTime, NULL, szDate, 128, NULL);
-		GetTimeFormatEx(LOCALE_NAME_USER_DEFAULT, NULL, &_logonTime, NULL, szTime, 128);
-		swprintf_s(szDateText, L"%s %s", szDate, szTime);
-		SetDlgItemTextW(hWnd, GetRes(IDC_SECURITY_DATE), szDateText);
+		// Warming up the pooled dialog must not close whatever is up
+		if (lParam != GINA_DLG_POOLED)
+		{
+			ginaManager::Get()->CloseAllDialogs();
+			UpdateInfo(hWnd);
+		}
 
 		ginaManager::Get()->MoveChildrenForBranding(hWnd, FALSE);
 
@@ -149,9 +180,8 @@ int CALLBACK ginaSecurityControl::DlgProc(HWND hWnd, UINT message, WPARAM wParam
 		{
 			if (GetAsyncKeyState(VK_CONTROL) & 0x8000)
 			{
-				wchar_t title[256], desc[256];
-				LoadStringW(ginaManager::Get()->hGinaDll, GINA_STR_EMERGENCY_RESTART_TITLE, title, 256);
-				LoadStringW(ginaManager::Get()->hGinaDll, GINA_STR_EMERGENCY_RESTART_DESC, desc, 256);
+				const wchar_t* title = ginaStrings::Get()->Text(GINA_STR_EMERGENCY_RESTART_TITLE);
+				const wchar_t* desc = ginaStrings::Get()->Text(GINA_STR_EMERGENCY_RESTART_DESC);
 				if (MessageBoxW(hWnd, desc, title, MB_YESNO | MB_ICONERROR) == IDYES)
 				{
 					EmergencyRestart();
@@ -208,6 +238,11 @@ int CALLBACK ginaSecurityControl::DlgProc(HWND hWnd, UINT message, WPARAM wParam
 		PostQuitMessage(0); // Trigger exit thread
 		break;
 	}
+	case WM_DPICHANGED:
+	{
+		ginaManager::Get()->OnDpiChanged(hWnd, wParam, lParam, FALSE);
+		break;
+	}
 	case WM_DESTROY:
 	{
 		PostQuitMessage(0); // Trigger exit thread
@@ -35,12 +35,14 @@ class ginaSecurityControl
 {
 public:
 	HWND hDlg;
-	std::atomic<bool> isActive;
 	static ginaSecurityControl* Get();
 	static void Create();
 	static void Destroy();
 	static void Show();
 	static void Hide();
+	// ginaDialogPool callback
+	static void PoolShow(HWND hDlg);
+	static void UpdateInfo(HWND hDlg);
 	static void BeginMessageLoop();
 	static int CALLBACK DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 };
\ No newline at end of file
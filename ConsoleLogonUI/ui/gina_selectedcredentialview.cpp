@@ -33,48 +33,35 @@ void external::SelectedCredentialView_SetActive(const wchar_t* accountNameToDisp
 	g_accountName = accountNameToDisplay;
 
 	std::thread([=] {
-		if (flag == 2) {
-			if (ginaChangePwdView::Get()->isActive.exchange(true)) {
-				return;
-			}
+		GINAVIEW view = flag == 2 ? GV_CHANGEPWD : IsSystemUser() ? GV_SELECTEDCREDENTIAL : GV_LOCKED;
+		GINATRANSITION transition = ginaViewState::Get()->Enter(view);
+		if (transition == GT_DENY) {
+			return;
 		}
-		else {
-			if (IsSystemUser()) {
-				if (ginaSelectedCredentialView::Get()->isActive.exchange(true)) {
-					return;
-				}
-			}
-			else {
-				if (ginaSelectedCredentialViewLocked::Get()->isActive.exchange(true)) {
-					return;
-				}
-			}
+
+		if (transition == GT_REPLACE) {
+			ginaManager::Get()->CloseAllDialogs();
 		}
 
-		if (flag == 2) {
+		if (view == GV_CHANGEPWD) {
 			ginaChangePwdView::Get()->Create();
 			ginaChangePwdView::Get()->Show();
+			ginaViewState::Get()->Shown(view);
 			ginaChangePwdView::Get()->BeginMessageLoop();
-			ginaChangePwdView::Get()->isActive = false;
+		}
+		else if (view == GV_SELECTEDCREDENTIAL) {
+			ginaSelectedCredentialView::Get()->Create();
+			ginaSelectedCredentialView::Get()->Show();
+			ginaViewState::Get()->Shown(view);
+			ginaSelectedCredentialView::Get()->BeginMessageLoop();
 		}
 		else {
-			ginaManager::Get()->CloseAllDialogs();
-			
-			if (IsSystemUser())
-			{
-				ginaSelectedCredentialView::Get()->Create();
-				ginaSelectedCredentialView::Get()->Show();
-				ginaSelectedCredentialView::Get()->BeginMessageLoop();
-				ginaSelectedCredentialView::Get()->isActive = false;
-			}
-			else
-			{
-				ginaSelectedCredentialViewLocked::Get()->Create();
-				ginaSelectedCredentialViewLocked::Get()->Show();
-				ginaSelectedCredentialViewLocked::Get()->BeginMessageLoop();
-				ginaSelectedCredentialViewLocked::Get()->isActive = false;
-			}
+			ginaSelectedCredentialViewLocked::Get()->Create();
+			ginaSelectedCredentialViewLocked::Get()->Show();
+			ginaViewState::Get()->Shown(view);
+			ginaSelectedCredentialViewLocked::Get()->BeginMessageLoop();
 		}
+		ginaViewState::Get()->Leave(view);
 	}).detach();
 }
 
@@ -188,6 +175,7 @@ void ginaSelectedCredentialView::BeginMessageLoop()
 {
 	ginaSelectedCredentialView* dlg = ginaSelectedCredentialView::Get();
 	MSG msg;
+	ginaWatchdogBeat beat(GV_SELECTEDCREDENTIAL);
 	while (GetMessageW(&msg, NULL, 0, 0))
 	{
 		if (!IsDialogMessageW(dlg->hDlg, &msg))
@@ -204,9 +192,9 @@ int CALLBACK ginaSelectedCredentialView::DlgProc(HWND hWnd, UINT message, WPARAM
 	{
 	case WM_INITDIALOG:
 	{
-		RECT dlgRect;
-		GetWindowRect(hWnd, &dlgRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&dlgRect, 2);
+		// Work out where everything goes from the template first, then move the controls in one go
+		dlgLayout layout;
+		ginaManager::Get()->LoadLayout(hWnd, GetRes(GINA_DLG_USER_SELECT), &layout);
 		int dlgHeightToReduce = 0;
 		int bottomBtnYToMove = 0;
 
@@ -214,65 +202,39 @@ int CALLBACK ginaSelectedCredentialView::DlgProc(HWND hWnd, UINT message, WPARAM
 		HWND hIcon = GetDlgItem(hWnd, IDC_CREDVIEW_ICON);
 		if (hIcon)
 		{
-			SendMessageW(hIcon, STM_SETICON, (WPARAM)LoadImageW(ginaManager::Get()->hGinaDll, MAKEINTRESOURCEW(IDI_LOGON), IMAGE_ICON, 64, 64, LR_DEFAULTCOLOR), 0);
+			SendMessageW(hIcon, STM_SETICON, (WPARAM)ginaGdiCache::Get()->AcquireIcon(NULL, IDI_LOGON, 64, GetWindowDpi(hWnd)), 0);
 		}
 
 		// Hide the legal announcement (2000+)
-		HWND hLegalAnnouncement = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LEGAL));
-		if (hLegalAnnouncement)
+		dlgItem* pLegal = layout.Find(GetRes(IDC_CREDVIEW_LEGAL));
+		if (pLegal)
 		{
-			RECT legalRect;
-			GetWindowRect(hLegalAnnouncement, &legalRect);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&legalRect, 2);
-			dlgHeightToReduce = legalRect.bottom - legalRect.top;
-			ShowWindow(hLegalAnnouncement, SW_HIDE);
+			dlgHeightToReduce = pLegal->cy;
+			layout.Hide(pLegal->id);
 
 			// And move all other controls up
-			HWND hChild = GetWindow(hWnd, GW_CHILD);
-			while (hChild != NULL)
-			{
-				if (hChild != hLegalAnnouncement)
-				{
-					RECT childRect;
-					GetWindowRect(hChild, &childRect);
-					MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&childRect, 2);
-					if (childRect.top > 6)
-					{
-						SetWindowPos(hChild, NULL, childRect.left, childRect.top - legalRect.bottom, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
-					}
-				}
-				hChild = GetWindow(hChild, GW_HWNDNEXT);
-			}
+			layout.OffsetBelow(6, -(pLegal->y + pLegal->cy), pLegal->id);
 		}
 
 		// Hide the XP-specific locked message for the pre-logon dialog
 		// (Used in XP when the Welcome screen is disabled and tsdiscon.exe is used)
-		HWND hLockedGroupBox = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_XP_LOCKED_GROUP));
-		if (hLockedGroupBox)
+		dlgItem* pLockedGroupBox = layout.Find(GetRes(IDC_CREDVIEW_XP_LOCKED_GROUP));
+		if (pLockedGroupBox)
 		{
-			ShowWindow(hLockedGroupBox, SW_HIDE);
-			RECT lockedRect;
-			GetWindowRect(hLockedGroupBox, &lockedRect);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&lockedRect, 2);
-			HWND hLockedInfo = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_XP_LOCKED_INFO));
-			HWND hLockedUsernameInfo = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_USERNAME_INFO));
-			HWND hLockedIcon = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_ICON));
-			ShowWindow(hLockedInfo, SW_HIDE);
-			ShowWindow(hLockedUsernameInfo, SW_HIDE);
-			ShowWindow(hLockedIcon, SW_HIDE);
-			dlgHeightToReduce += lockedRect.bottom - lockedRect.top;
+			layout.Hide(pLockedGroupBox->id);
+			layout.Hide(GetRes(IDC_CREDVIEW_XP_LOCKED_INFO));
+			layout.Hide(GetRes(IDC_CREDVIEW_LOCKED_USERNAME_INFO));
+			layout.Hide(GetRes(IDC_CREDVIEW_LOCKED_ICON));
+			dlgHeightToReduce += pLockedGroupBox->cy;
 		}
 
 		// Hide the domain chooser
-		HWND hDomainChooser = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_DOMAIN));
-		HWND hDomainChooserLabel = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_DOMAIN_LABEL));
-		RECT domainRect;
-		GetWindowRect(hDomainChooser, &domainRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&domainRect, 2);
-		ShowWindow(hDomainChooser, SW_HIDE);
-		ShowWindow(hDomainChooserLabel, SW_HIDE);
-		dlgHeightToReduce += domainRect.bottom - domainRect.top + 8;
-		bottomBtnYToMove = domainRect.bottom - domainRect.top + 8;
+		dlgItem* pDomainChooser = layout.Find(GetRes(IDC_CREDVIEW_DOMAIN));
+		int domainHeight = pDomainChooser ? pDomainChooser->cy : 0;
+		layout.Hide(GetRes(IDC_CREDVIEW_DOMAIN));
+		layout.Hide(GetRes(IDC_CREDVIEW_DOMAIN_LABEL));
+		dlgHeightToReduce += domainHeight + 8;
+		bottomBtnYToMove = domainHeight + 8;
 
 		// Hide the caps-lock warning balloon
 		if (ginaManager::Get()->config.hideCapsLockBalloon)
@@ -282,29 +244,25 @@ int CALLBACK ginaSelectedCredentialView::DlgProc(HWND hWnd, UINT message, WPARAM
 		}
 
 		// Hide the dial-up checkbox
-		HWND hDialup = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_DIALUP));
-		RECT dialupRect;
-		GetWindowRect(hDialup, &dialupRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&dialupRect, 2);
-		ShowWindow(hDialup, SW_HIDE);
-		dlgHeightToReduce += dialupRect.bottom - dialupRect.top + 8;
-		bottomBtnYToMove += dialupRect.bottom - dialupRect.top;
+		dlgItem* pDialup = layout.Find(GetRes(IDC_CREDVIEW_DIALUP));
+		int dialupHeight = pDialup ? pDialup->cy : 0;
+		layout.Hide(GetRes(IDC_CREDVIEW_DIALUP));
+		dlgHeightToReduce += dialupHeight + 8;
+		bottomBtnYToMove += dialupHeight;
 
 		// Move the OK, Cancel, Shutdown, Options, and language icon controls up (2000+)
-		HWND hOK = GetDlgItem(hWnd, IDC_OK);
-		HWND hCancel = GetDlgItem(hWnd, IDC_CANCEL);
 		if (ginaManager::Get()->ginaVersion >= GINA_VER_2K)
 		{
-			HWND hShutdown = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_SHUTDOWN));
-			HWND hOptions = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_OPTIONS));
-			HWND hLanguageIcon = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LANGUAGE));
-			HWND controlsToMove[] = { hOK, hCancel, hShutdown, hOptions, hLanguageIcon };
-			for (int i = 0; i < sizeof(controlsToMove) / sizeof(HWND); i++)
+			int controlsToMove[] = {
+				IDC_OK,
+				IDC_CANCEL,
+				GetRes(IDC_CREDVIEW_SHUTDOWN),
+				GetRes(IDC_CREDVIEW_OPTIONS),
+				GetRes(IDC_CREDVIEW_LANGUAGE)
+			};
+			for (int i = 0; i < sizeof(controlsToMove) / sizeof(int); i++)
 			{
-				RECT controlRect;
-				GetWindowRect(controlsToMove[i], &controlRect);
-				MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&controlRect, 2);
-				SetWindowPos(controlsToMove[i], NULL, controlRect.left, controlRect.top - bottomBtnYToMove, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
+				layout.Offset(controlsToMove[i], 0, -bottomBtnYToMove);
 			}
 		}
 		else
@@ -316,7 +274,7 @@ int CALLBACK ginaSelectedCredentialView::DlgProc(HWND hWnd, UINT message, WPARAM
 		// DIsable the Cancel button
 		if (!IsFriendlyLogonUI())
 		{
-			EnableWindow(hCancel, FALSE);
+			EnableWindow(GetDlgItem(hWnd, IDC_CANCEL), FALSE);
 		}
 
 		HWND optBtn = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_OPTIONS));
@@ -324,39 +282,25 @@ int CALLBACK ginaSelectedCredentialView::DlgProc(HWND hWnd, UINT message, WPARAM
 		{
 			// Load the options button state
 			BOOL isShutdownVisible = GetConfigInt(L"OptionsExpanded", 0);
-			if (!isShutdownVisible)
+			dlgItem* pShutdown = layout.Find(GetRes(IDC_CREDVIEW_SHUTDOWN));
+			if (!isShutdownVisible && pShutdown)
 			{
-				HWND hShutdown = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_SHUTDOWN));
-				ShowWindow(hShutdown, SW_HIDE);
-				RECT shutdownRect;
-				GetWindowRect(hShutdown, &shutdownRect);
-				MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&shutdownRect, 2);
-				HWND controlsToMove[] = {
-					hOK,
-					hCancel
-				};
-				for (int i = 0; i < sizeof(controlsToMove) / sizeof(HWND); i++)
-				{
-					RECT controlRect;
-					GetWindowRect(controlsToMove[i], &controlRect);
-					MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&controlRect, 2);
-					SetWindowPos(controlsToMove[i], NULL, controlRect.left + shutdownRect.right - shutdownRect.left, controlRect.top, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
-				}
+				layout.Hide(pShutdown->id);
+				layout.Offset(IDC_OK, pShutdown->cx, 0);
+				layout.Offset(IDC_CANCEL, pShutdown->cx, 0);
 			}
-			wchar_t optBtnStr[256];
-			LoadStringW(ginaManager::Get()->hGinaDll, isShutdownVisible ? GINA_STR_OPTBTN_COLLAPSE : GINA_STR_OPTBTN_EXPAND, optBtnStr, 256);
-			SetDlgItemTextW(hWnd, GetRes(IDC_CREDVIEW_OPTIONS), optBtnStr);
+			SetDlgItemTextW(hWnd, GetRes(IDC_CREDVIEW_OPTIONS), ginaStrings::Get()->Text(isShutdownVisible ? GINA_STR_OPTBTN_COLLAPSE : GINA_STR_OPTBTN_EXPAND));
 		}
 
 		// Resize the dialog (2000+)
-		SetWindowPos(hWnd, NULL, 0, 0, dlgRect.right - dlgRect.left, dlgRect.bottom - dlgRect.top - dlgHeightToReduce, SWP_NOZORDER | SWP_NOMOVE);
+		layout.Resize(0, -dlgHeightToReduce);
+		ginaManager::Get()->MoveChildrenForBranding(hWnd, &layout, TRUE);
+		ginaManager::Get()->ApplyLayout(hWnd, &layout);
 
 		// Set the focus to the password field
 		SetFocus(GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_PASSWORD)));
 		SendMessage(GetDlgItem(hWnd, IDC_OK), BM_SETSTYLE, BS_DEFPUSHBUTTON, TRUE);
 
-		ginaManager::Get()->MoveChildrenForBranding(hWnd, TRUE);
-
 		break;
 	}
 	case WM_COMMAND:
@@ -422,11 +366,8 @@ int CALLBACK ginaSelectedCredentialView::DlgProc(HWND hWnd, UINT message, WPARAM
 				SetWindowPos(controlsToMove[i], NULL, isShutdownVisible ? controlRect.left + shutdownRect.right - shutdownRect.left : controlRect.left - shutdownRect.right + shutdownRect.left, controlRect.top, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
 			}
 			// Update the button string
-			HMODULE hGinaDll = ginaManager::Get()->hGinaDll;
-			wchar_t optBtnStr[256];
-			LoadStringW(hGinaDll, isShutdownVisible ? GINA_STR_OPTBTN_EXPAND : GINA_STR_OPTBTN_COLLAPSE, optBtnStr, 256);
-			SetDlgItemTextW(hWnd, 1514, optBtnStr);
-			SetConfigInt(L"OptionsExpanded", isShutdownVisible ? 0 : 1);
+			SetDlgItemTextW(hWnd, 1514, ginaStrings::Get()->Text(isShutdownVisible ? GINA_STR_OPTBTN_EXPAND : GINA_STR_OPTBTN_COLLAPSE));
+			SetConfigIntLater(L"OptionsExpanded", isShutdownVisible ? 0 : 1);
 		}
 		break;
 	}
@@ -440,8 +381,14 @@ int CALLBACK ginaSelectedCredentialView::DlgProc(HWND hWnd, UINT message, WPARAM
 		EndPaint(hWnd, &ps);
 		return 0;
 	}
+	case WM_DPICHANGED:
+	{
+		ginaManager::Get()->OnDpiChanged(hWnd, wParam, lParam, TRUE);
+		break;
+	}
 	case WM_DESTROY:
 	{
+		ginaGdiCache::Get()->ReleaseControlIcon(GetDlgItem(hWnd, IDC_CREDVIEW_ICON));
 		PostQuitMessage(0); // Trigger exit thread
 		break;
 	}
@@ -479,10 +426,9 @@ void ginaSelectedCredentialViewLocked::Create()
 		ginaManager::Get()->PostThemeChange();
 	}
 	WCHAR _wszUserName[MAX_PATH], _wszDomainName[MAX_PATH];
-	WCHAR szFormat[256], szText[1024];
+	WCHAR szText[1024];
 	GetLoggedOnUserInfo(_wszUserName, MAX_PATH, _wszDomainName, MAX_PATH);
-	LoadStringW(ginaManager::Get()->hGinaDll, GINA_STR_CREDVIEW_LOCKED_USERNAME_INFO, szFormat, 256);
-	swprintf_s(szText, szFormat, _wszDomainName, _wszUserName, _wszUserName);
+	swprintf_s(szText, ginaStrings::Get()->Text(GINA_STR_CREDVIEW_LOCKED_USERNAME_INFO), _wszDomainName, _wszUserName, _wszUserName);
 	SetDlgItemTextW(ginaSelectedCredentialViewLocked::Get()->hDlg, GetRes(IDC_CREDVIEW_LOCKED_USERNAME_INFO), szText);
 	SetDlgItemTextW(ginaSelectedCredentialViewLocked::Get()->hDlg, GetRes(IDC_CREDVIEW_LOCKED_USERNAME), _wszUserName);
 }
@@ -513,6 +459,7 @@ void ginaSelectedCredentialViewLocked::BeginMessageLoop()
 {
 	ginaSelectedCredentialViewLocked* dlg = ginaSelectedCredentialViewLocked::Get();
 	MSG msg;
+	ginaWatchdogBeat beat(GV_LOCKED);
 	while (GetMessageW(&msg, NULL, 0, 0))
 	{
 
@@ -530,27 +477,23 @@ int CALLBACK ginaSelectedCredentialViewLocked::DlgProc(HWND hWnd, UINT message,
 	{
 	case WM_INITDIALOG:
 	{
-		RECT dlgRect;
-		GetWindowRect(hWnd, &dlgRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&dlgRect, 2);
+		dlgLayout layout;
+		ginaManager::Get()->LoadLayout(hWnd, GetRes(GINA_DLG_USER_SELECT_LOCKED), &layout);
 		int dlgHeightToReduce = 0;
 		int bottomBtnYToMove = 0;
 
 		// Load the icon
 		HWND hIcon = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_ICON));
 		int iconSize = ginaManager::Get()->ginaVersion == GINA_VER_NT4 ? 64 : 32;
-		SendMessageW(hIcon, STM_SETICON, (WPARAM)LoadImageW(ginaManager::Get()->hGinaDll, MAKEINTRESOURCEW(GetRes(IDI_LOCKED)), IMAGE_ICON, iconSize, iconSize, LR_DEFAULTCOLOR), 0);
+		SendMessageW(hIcon, STM_SETICON, (WPARAM)ginaGdiCache::Get()->AcquireIcon(NULL, GetRes(IDI_LOCKED), iconSize, GetWindowDpi(hWnd)), 0);
 
 		// Hide the domain chooser
-		HWND hDomainChooser = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_DOMAIN));
-		HWND hDomainChooserLabel = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_DOMAIN_LABEL));
-		RECT domainRect;
-		GetWindowRect(hDomainChooser, &domainRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&domainRect, 2);
-		ShowWindow(hDomainChooser, SW_HIDE);
-		ShowWindow(hDomainChooserLabel, SW_HIDE);
-		dlgHeightToReduce = domainRect.bottom - domainRect.top + 8;
-		bottomBtnYToMove = domainRect.bottom - domainRect.top + 8;
+		dlgItem* pDomainChooser = layout.Find(GetRes(IDC_CREDVIEW_LOCKED_DOMAIN));
+		int domainHeight = pDomainChooser ? pDomainChooser->cy : 0;
+		layout.Hide(GetRes(IDC_CREDVIEW_LOCKED_DOMAIN));
+		layout.Hide(GetRes(IDC_CREDVIEW_LOCKED_DOMAIN_LABEL));
+		dlgHeightToReduce = domainHeight + 8;
+		bottomBtnYToMove = domainHeight + 8;
 
 		// Disable Cancel button
 		EnableWindow(GetDlgItem(hWnd, IDCANCEL), FALSE);
@@ -563,37 +506,25 @@ int CALLBACK ginaSelectedCredentialViewLocked::DlgProc(HWND hWnd, UINT message,
 		}
 
 		// Hide the options button and move the OK and Cancel buttons right (2000+)
-		HWND hOptions = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_OPTIONS));
-		if (hOptions)
+		dlgItem* pOptions = layout.Find(GetRes(IDC_CREDVIEW_LOCKED_OPTIONS));
+		if (pOptions)
 		{
-			RECT optionsRect;
-			GetWindowRect(hOptions, &optionsRect);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&optionsRect, 2);
-			ShowWindow(hOptions, SW_HIDE);
-			HWND hOK = GetDlgItem(hWnd, IDC_OK);
-			HWND hCancel = GetDlgItem(hWnd, IDC_CANCEL);
-			RECT okRect, cancelRect;
-			GetWindowRect(hOK, &okRect);
-			GetWindowRect(hCancel, &cancelRect);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&okRect, 2);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&cancelRect, 2);
-
-			// Move the OK and Cancel buttons appropriately
-			SetWindowPos(hOK, NULL, okRect.left + optionsRect.right - optionsRect.left, okRect.top - bottomBtnYToMove, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
-			SetWindowPos(hCancel, NULL, cancelRect.left + optionsRect.right - optionsRect.left, cancelRect.top - bottomBtnYToMove, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
+			layout.Hide(pOptions->id);
+			layout.Offset(IDC_OK, pOptions->cx, -bottomBtnYToMove);
+			layout.Offset(IDC_CANCEL, pOptions->cx, -bottomBtnYToMove);
 		}
 
 		if (ginaManager::Get()->ginaVersion >= GINA_VER_2K)
 		{
-			SetWindowPos(hWnd, NULL, 0, 0, dlgRect.right - dlgRect.left, dlgRect.bottom - dlgRect.top - dlgHeightToReduce, SWP_NOZORDER | SWP_NOMOVE);
+			layout.Resize(0, -dlgHeightToReduce);
 		}
+		ginaManager::Get()->MoveChildrenForBranding(hWnd, &layout, FALSE);
+		ginaManager::Get()->ApplyLayout(hWnd, &layout);
 
 		// Set the focus to the password field
 		SetFocus(GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_PASSWORD)));
 		SendMessage(GetDlgItem(hWnd, IDC_OK), BM_SETSTYLE, BS_DEFPUSHBUTTON, TRUE);
 
-		ginaManager::Get()->MoveChildrenForBranding(hWnd, FALSE);
-
 		break;
 	}
 	case WM_COMMAND:
@@ -643,8 +574,14 @@ int CALLBACK ginaSelectedCredentialViewLocked::DlgProc(HWND hWnd, UINT message,
 		EndPaint(hWnd, &ps);
 		return 0;
 	}
+	case WM_DPICHANGED:
+	{
+		ginaManager::Get()->OnDpiChanged(hWnd, wParam, lParam, FALSE);
+		break;
+	}
 	case WM_DESTROY:
 	{
+		ginaGdiCache::Get()->ReleaseControlIcon(GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_ICON)));
 		PostQuitMessage(0); // Trigger exit thread
 		break;
 	}
@@ -699,6 +636,7 @@ void ginaChangePwdView::BeginMessageLoop()
 {
 	ginaChangePwdView* dlg = ginaChangePwdView::Get();
 	MSG msg;
+	ginaWatchdogBeat beat(GV_CHANGEPWD);
 	while (GetMessageW(&msg, NULL, 0, 0))
 	{
 		if (!IsDialogMessageW(dlg->hDlg, &msg))
@@ -723,9 +661,7 @@ int CALLBACK ginaChangePwdView::DlgProc(HWND hWnd, UINT message, WPARAM wParam,
 		// Append '(this computer)' to the domain field (2000+)
 		if (ginaManager::Get()->ginaVersion >= GINA_VER_2K)
 		{
-			wchar_t thisComputer[256];
-			LoadStringW(ginaManager::Get()->hGinaDll, GINA_STR_THIS_COMPUTER, thisComputer, 256);
-			wcscat_s(lpDomain, thisComputer);
+			wcscat_s(lpDomain, ginaStrings::Get()->Text(GINA_STR_THIS_COMPUTER));
 		}
 		// Only put the domain name in NT4
 		SetDlgItemTextW(hWnd, GetRes(IDC_CHPW_DOMAIN), lpDomain);
@@ -734,7 +670,11 @@ int CALLBACK ginaChangePwdView::DlgProc(HWND hWnd, UINT message, WPARAM wParam,
 		SetFocus(GetDlgItem(hWnd, GetRes(IDC_CHPW_OLD_PASSWORD)));
 		SendMessage(GetDlgItem(hWnd, IDC_OK), BM_SETSTYLE, BS_DEFPUSHBUTTON, TRUE);
 
-		ginaManager::Get()->MoveChildrenForBranding(hWnd, FALSE);
+		// Nothing is hidden here, the branding offset still goes through the layout so the controls move in one batch
+		dlgLayout layout;
+		ginaManager::Get()->LoadLayout(hWnd, GetRes(GINA_DLG_CHANGE_PWD), &layout);
+		ginaManager::Get()->MoveChildrenForBranding(hWnd, &layout, FALSE);
+		ginaManager::Get()->ApplyLayout(hWnd, &layout);
 
 		break;
 	}
@@ -754,10 +694,10 @@ int CALLBACK ginaChangePwdView::DlgProc(HWND hWnd, UINT message, WPARAM wParam,
 
 			if (wcscmp(newPassword, confirmPassword) != 0)
 			{
-				wchar_t title[256], msg[256];
-				LoadStringW(ginaManager::Get()->hGinaDll, GINA_STR_CHPW_TITLE, title, 256);
+				wchar_t title[256];
+				wcscpy_s(title, ginaStrings::Get()->Text(GINA_STR_CHPW_TITLE));
 				wcscat_s(title, 256, L" "); // Just to let MakeWindowClassicAsync differentiate the message box and this dialog
-				LoadStringW(ginaManager::Get()->hGinaDll, GINA_STR_CHPW_CONFIRM_MISMATCH, msg, 256);
+				const wchar_t* msg = ginaStrings::Get()->Text(GINA_STR_CHPW_CONFIRM_MISMATCH);
 
 				if (ginaManager::Get()->config.classicTheme)
 				{
@@ -812,6 +752,11 @@ int CALLBACK ginaChangePwdView::DlgProc(HWND hWnd, UINT message, WPARAM wParam,
 		EndPaint(hWnd, &ps);
 		return 0;
 	}
+	case WM_DPICHANGED:
+	{
+		ginaManager::Get()->OnDpiChanged(hWnd, wParam, lParam, FALSE);
+		break;
+	}
 	case WM_DESTROY:
 	{
 		PostQuitMessage(0); // Trigger exit thread
@@ -71,7 +71,6 @@ class ginaSelectedCredentialView
 {
 public:
 	HWND hDlg;
-	std::atomic <bool> isActive;
 	static ginaSelectedCredentialView* Get();
 	static void Create();
 	static void Destroy();
@@ -85,7 +84,6 @@ class ginaSelectedCredentialViewLocked
 {
 public:
 	HWND hDlg;
-	std::atomic <bool> isActive;
 	static ginaSelectedCredentialViewLocked* Get();
 	static void Create();
 	static void Destroy();
@@ -99,7 +97,6 @@ class ginaChangePwdView
 {
 public:
 	HWND hDlg;
-	std::atomic <bool> isActive;
 	static ginaChangePwdView* Get();
 	static void Create();
 	static void Destroy();
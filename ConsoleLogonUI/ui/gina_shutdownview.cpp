@@ -10,8 +10,6 @@
 
 #pragma comment(lib, "PowrProf.lib")
 
-std::atomic<bool> isShutdownViewActive(false);
-std::atomic<bool> isLogoffViewActive(false);
 
 std::mutex shutdownViewMutex;
 std::mutex logoffViewMutex;
@@ -24,7 +22,7 @@ void ShowShutdownDialog(HWND parent)
 	std::lock_guard<std::mutex> lock(shutdownViewMutex);
 	
 	std::thread([=] {
-		if (isShutdownViewActive.exchange(true)) {
+		if (ginaViewState::Get()->Enter(GV_SHUTDOWN) == GT_DENY) {
 			return;
 		}
 		if (parent) {
@@ -32,8 +30,9 @@ void ShowShutdownDialog(HWND parent)
 		}
 		ginaShutdownView::Get()->Create(parent);
 		ginaShutdownView::Get()->Show();
+		ginaViewState::Get()->Shown(GV_SHUTDOWN);
 		ginaShutdownView::Get()->BeginMessageLoop();
-		isShutdownViewActive = false;
+		ginaViewState::Get()->Leave(GV_SHUTDOWN);
 		if (parent) {
 			EnableWindow(parent, TRUE);
 		}
@@ -48,7 +47,7 @@ void ShowLogoffDialog(HWND parent)
 	std::lock_guard<std::mutex> lock(logoffViewMutex);
 	
 	std::thread([=] {
-		if (isLogoffViewActive.exchange(true)) {
+		if (ginaViewState::Get()->Enter(GV_LOGOFF) == GT_DENY) {
 			return;
 		}
 		if (parent) {
@@ -56,8 +55,9 @@ void ShowLogoffDialog(HWND parent)
 		}
 		ginaLogoffView::Get()->Create(parent);
 		ginaLogoffView::Get()->Show();
+		ginaViewState::Get()->Shown(GV_LOGOFF);
 		ginaLogoffView::Get()->BeginMessageLoop();
-		isLogoffViewActive = false;
+		ginaViewState::Get()->Leave(GV_LOGOFF);
 		if (parent) {
 			EnableWindow(parent, TRUE);
 		}
@@ -111,6 +111,7 @@ void ginaShutdownView::BeginMessageLoop()
 {
 	ginaShutdownView* dlg = ginaShutdownView::Get();
 	MSG msg;
+	ginaWatchdogBeat beat(GV_SHUTDOWN);
 	while (GetMessageW(&msg, NULL, 0, 0))
 	{
 		if (!IsDialogMessageW(dlg->hDlg, &msg))
@@ -121,29 +122,44 @@ void ginaShutdownView::BeginMessageLoop()
 	}
 }
 
+static int ShutdownDescId(int index)
+{
+	switch (index)
+	{
+	case 0:
+		return GINA_STR_LOGOFF_DESC;
+	case 1:
+		return GINA_STR_SHUTDOWN_DESC;
+	case 2:
+		return GINA_STR_RESTART_DESC;
+	case 3:
+		return GINA_STR_SLEEP_DESC;
+	case 4:
+		return GINA_STR_HIBERNATE_DESC;
+	}
+	return 0;
+}
+
 int CALLBACK ginaShutdownView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
 	switch (message)
 	{
 	case WM_INITDIALOG:
 	{
-		HINSTANCE hGinaDll = ginaManager::Get()->hGinaDll;
+		// Work out where everything goes from the template first, then move the controls in one go
+		dlgLayout layout;
+		ginaManager::Get()->LoadLayout(hWnd, GetRes(GINA_DLG_SHUTDOWN), &layout);
 
 		// Load the icon (shutdown icon in msgina.dll for 2000+, generic MB_ICONINFORMATION icon for NT4)
 		HWND hShutdownIcon = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_ICON));
 		HICON hIcon = NULL;
 		if (ginaManager::Get()->ginaVersion == GINA_VER_NT4)
 		{
-			HINSTANCE hShell32 = LoadLibraryW(L"shell32.dll");
-			if (hShell32)
-			{
-				hIcon = (HICON)LoadImageW(hShell32, MAKEINTRESOURCEW(SHELL32_INFO), IMAGE_ICON, 0, 0, LR_DEFAULTSIZE | LR_VGACOLOR);
-				FreeLibrary(hShell32);
-			}
+			hIcon = ginaGdiCache::Get()->AcquireIcon(L"shell32.dll", SHELL32_INFO, 0, 0, LR_VGACOLOR);
 		}
 		else
 		{
-			hIcon = LoadIconW(hGinaDll, MAKEINTRESOURCEW(IDI_SHUTDOWN));
+			hIcon = ginaGdiCache::Get()->AcquireIcon(NULL, IDI_SHUTDOWN, 0, 0);
 		}
 		if (hIcon)
 		{
@@ -154,102 +170,68 @@ int CALLBACK ginaShutdownView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, L
 		HWND hShutdownCombo = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_COMBO));
 		if (hShutdownCombo)
 		{
-			wchar_t shutdownStr[256];
+			ginaStrings* strings = ginaStrings::Get();
 			if (!IsSystemUser())
 			{
-				wchar_t logoffStr[256], username[MAX_PATH], domain[MAX_PATH];
+				wchar_t shutdownStr[256], username[MAX_PATH], domain[MAX_PATH];
 				GetLoggedOnUserInfo(username, MAX_PATH, domain, MAX_PATH);
-				LoadStringW(hGinaDll, GINA_STR_LOGOFF, logoffStr, 256);
-				swprintf_s(shutdownStr, logoffStr, username);
+				swprintf_s(shutdownStr, strings->Text(GINA_STR_LOGOFF), username);
 				SendMessageW(hShutdownCombo, CB_ADDSTRING, 0, (LPARAM)shutdownStr);
 			}
-			LoadStringW(hGinaDll, GINA_STR_SHUTDOWN, shutdownStr, 256);
-			SendMessageW(hShutdownCombo, CB_ADDSTRING, 0, (LPARAM)shutdownStr);
-			LoadStringW(hGinaDll, GINA_STR_RESTART, shutdownStr, 256);
-			SendMessageW(hShutdownCombo, CB_ADDSTRING, 0, (LPARAM)shutdownStr);
-			LoadStringW(hGinaDll, GINA_STR_SLEEP, shutdownStr, 256);
-			SendMessageW(hShutdownCombo, CB_ADDSTRING, 0, (LPARAM)shutdownStr);
-			LoadStringW(hGinaDll, GINA_STR_HIBERNATE, shutdownStr, 256);
-			SendMessageW(hShutdownCombo, CB_ADDSTRING, 0, (LPARAM)shutdownStr);
-			// Set the default selection to Restart
-			SendMessageW(hShutdownCombo, CB_SETCURSEL, IsSystemUser() ? 1 : 2, 0);
-
-			wchar_t shutdownDesc[256];
-			LoadStringW(hGinaDll, GINA_STR_RESTART_DESC, shutdownDesc, 256);
-			SetDlgItemTextW(hWnd, GetRes(IDC_SHUTDOWN_DESC), shutdownDesc);
+			SendMessageW(hShutdownCombo, CB_ADDSTRING, 0, (LPARAM)strings->Text(GINA_STR_SHUTDOWN));
+			SendMessageW(hShutdownCombo, CB_ADDSTRING, 0, (LPARAM)strings->Text(GINA_STR_RESTART));
+			SendMessageW(hShutdownCombo, CB_ADDSTRING, 0, (LPARAM)strings->Text(GINA_STR_SLEEP));
+			SendMessageW(hShutdownCombo, CB_ADDSTRING, 0, (LPARAM)strings->Text(GINA_STR_HIBERNATE));
+			// Start with the last choice, Restart the first time; Log off isn't there without a user
+			int choice = GetConfigInt(L"ShutdownChoice", 2);
+			if (choice < 0 || choice > 4 || (choice == 0 && IsSystemUser()))
+				choice = 2;
+			SendMessageW(hShutdownCombo, CB_SETCURSEL, IsSystemUser() ? choice - 1 : choice, 0);
+
+			SetDlgItemTextW(hWnd, GetRes(IDC_SHUTDOWN_DESC), strings->Text(ShutdownDescId(choice)));
 		}
 
 		// Hide help button and move the OK and Cancel buttons (2000+)
-		HWND hHelpBtn = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_HELP));
-		if (hHelpBtn)
+		dlgItem* pHelpBtn = layout.Find(GetRes(IDC_SHUTDOWN_HELP));
+		if (pHelpBtn)
 		{
-			ShowWindow(hHelpBtn, SW_HIDE);
-			HWND hOkBtn = GetDlgItem(hWnd, IDC_OK);
-			HWND hCancelBtn = GetDlgItem(hWnd, IDC_CANCEL);
-			RECT helpRect, okRect, cancelRect;
-			GetWindowRect(hHelpBtn, &helpRect);
-			GetWindowRect(hOkBtn, &okRect);
-			GetWindowRect(hCancelBtn, &cancelRect);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&helpRect, 2);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&okRect, 2);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&cancelRect, 2);
-			SetWindowPos(hOkBtn, NULL, okRect.left + helpRect.right - helpRect.left + 8, okRect.top, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
-			SetWindowPos(hCancelBtn, NULL, cancelRect.left + helpRect.right - helpRect.left + 8, cancelRect.top, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
+			layout.Hide(pHelpBtn->id);
+			layout.Offset(IDC_OK, pHelpBtn->cx + 8, 0);
+			layout.Offset(IDC_CANCEL, pHelpBtn->cx + 8, 0);
 		}
 
 		// Hide the shutdown tracker (XP only)
-		HWND hShutdownTracker = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_TRACKER_GROUP));
-		if (hShutdownTracker)
+		dlgItem* pShutdownTracker = layout.Find(GetRes(IDC_SHUTDOWN_TRACKER_GROUP));
+		if (pShutdownTracker)
 		{
-			ShowWindow(hShutdownTracker, SW_HIDE);
-			HWND hShutdownTrackerDesc = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_TRACKER_DESC));
-			HWND hShutdownTrackerBooted = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_TRACKER_BOOTED));
-			HWND hShutdownTrackerOptionsLabel = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_TRACKER_OPTIONS_LABEL));
-			HWND hShutdownTrackerOptionsCombo = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_TRACKER_OPTIONS_COMBO));
-			HWND hShutdownTrackerOptionsDesc = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_TRACKER_OPTIONS_DESC));
-			HWND hShutdownTrackerDescLabel = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_TRACKER_DESC_LABEL));
-			HWND hShutdownTrackerDescEdit = GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_TRACKER_DESC_EDIT));
-			ShowWindow(hShutdownTrackerDesc, SW_HIDE);
-			ShowWindow(hShutdownTrackerBooted, SW_HIDE);
-			ShowWindow(hShutdownTrackerOptionsLabel, SW_HIDE);
-			ShowWindow(hShutdownTrackerOptionsCombo, SW_HIDE);
-			ShowWindow(hShutdownTrackerOptionsDesc, SW_HIDE);
-			ShowWindow(hShutdownTrackerDescLabel, SW_HIDE);
-			ShowWindow(hShutdownTrackerDescEdit, SW_HIDE);
-
-			RECT trackerRect;
-			GetWindowRect(hShutdownTracker, &trackerRect);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&trackerRect, 2);
-			int trackerHeight = trackerRect.bottom - trackerRect.top;
-			RECT dlgRect;
-			GetWindowRect(hWnd, &dlgRect);
-
-			RECT okRect, cancelRect;
-			HWND hOkBtn = GetDlgItem(hWnd, IDC_OK);
-			HWND hCancelBtn = GetDlgItem(hWnd, IDC_CANCEL);
-			GetWindowRect(hOkBtn, &okRect);
-			GetWindowRect(hCancelBtn, &cancelRect);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&okRect, 2);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&cancelRect, 2);
-			SetWindowPos(hOkBtn, NULL, okRect.left, okRect.top - trackerHeight, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
-			SetWindowPos(hCancelBtn, NULL, cancelRect.left, cancelRect.top - trackerHeight, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
-
-			RECT dlgRectNew;
-			GetWindowRect(hWnd, &dlgRectNew);
-			int dlgHeight = dlgRectNew.bottom - dlgRectNew.top;
-			SetWindowPos(hWnd, NULL, dlgRectNew.left, dlgRectNew.top, dlgRectNew.right - dlgRectNew.left, dlgHeight - trackerHeight, SWP_NOZORDER);
+			int trackerHeight = pShutdownTracker->cy;
+			int trackerControls[] = {
+				GetRes(IDC_SHUTDOWN_TRACKER_GROUP),
+				GetRes(IDC_SHUTDOWN_TRACKER_DESC),
+				GetRes(IDC_SHUTDOWN_TRACKER_BOOTED),
+				GetRes(IDC_SHUTDOWN_TRACKER_OPTIONS_LABEL),
+				GetRes(IDC_SHUTDOWN_TRACKER_OPTIONS_COMBO),
+				GetRes(IDC_SHUTDOWN_TRACKER_OPTIONS_DESC),
+				GetRes(IDC_SHUTDOWN_TRACKER_DESC_LABEL),
+				GetRes(IDC_SHUTDOWN_TRACKER_DESC_EDIT)
+			};
+			for (int i = 0; i < sizeof(trackerControls) / sizeof(int); i++)
+			{
+				layout.Hide(trackerControls[i]);
+			}
+
+			layout.Offset(IDC_OK, 0, -trackerHeight);
+			layout.Offset(IDC_CANCEL, 0, -trackerHeight);
+			layout.Resize(0, -trackerHeight);
 		}
 
 		// Hide power off option (no one uses non-ACPI systems anymore) (NT4 only)
 		// And hide duplicate OK and Cancel buttons
-		HWND hPowerOff = GetDlgItem(hWnd, IDC_SHUTDOWN_POWEROFF);
-		if (hPowerOff)
+		if (layout.Find(IDC_SHUTDOWN_POWEROFF))
 		{
-			HWND hOK = GetDlgItem(hWnd, IDC_SHUTDOWN_OK);
-			HWND hCancel = GetDlgItem(hWnd, IDC_SHUTDOWN_CANCEL);
-			ShowWindow(hPowerOff, SW_HIDE);
-			ShowWindow(hOK, SW_HIDE);
-			ShowWindow(hCancel, SW_HIDE);
+			layout.Hide(IDC_SHUTDOWN_POWEROFF);
+			layout.Hide(IDC_SHUTDOWN_OK);
+			layout.Hide(IDC_SHUTDOWN_CANCEL);
 		}
 
 		// Check the shutdown checkbox
@@ -259,7 +241,8 @@ int CALLBACK ginaShutdownView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, L
 			SendMessageW(hShutdown, BM_SETCHECK, BST_CHECKED, 0);
 		}
 
-		ginaManager::Get()->MoveChildrenForBranding(hWnd, FALSE);
+		ginaManager::Get()->MoveChildrenForBranding(hWnd, &layout, FALSE);
+		ginaManager::Get()->ApplyLayout(hWnd, &layout);
 
 		return TRUE;
 	}
@@ -273,32 +256,11 @@ int CALLBACK ginaShutdownView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, L
 			{
 				index += 1;
 			}
-			int descId = 0;
-			switch (index)
-			{
-			case 0:
-				descId = GINA_STR_LOGOFF_DESC;
-				break;
-			case 1:
-				descId = GINA_STR_SHUTDOWN_DESC;
-				break;
-			case 2:
-				descId = GINA_STR_RESTART_DESC;
-				break;
-			case 3:
-				descId = GINA_STR_SLEEP_DESC;
-				break;
-			case 4:
-				descId = GINA_STR_HIBERNATE_DESC;
-				break;
-			}
-			wchar_t shutdownDesc[256];
-			LoadStringW(ginaManager::Get()->hGinaDll, descId, shutdownDesc, 256);
-			SetDlgItemTextW(hWnd, GetRes(IDC_SHUTDOWN_DESC), shutdownDesc);
+			SetDlgItemTextW(hWnd, GetRes(IDC_SHUTDOWN_DESC), ginaStrings::Get()->Text(ShutdownDescId(index)));
 		}
 		else if (LOWORD(wParam) == IDC_OK)
 		{
-			if (ginaSecurityControl::Get()->isActive)
+			if (ginaViewState::Get()->IsActive(GV_SECURITYCONTROL))
 			{
 				// Go back to the desktop if on the Ctrl+Alt+Del screen
 				KEY_EVENT_RECORD rec;
@@ -315,6 +277,10 @@ int CALLBACK ginaShutdownView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, L
 					index += 1;
 				}
 
+				// Written now, nothing is left running to write it later
+				SetConfigIntLater(L"ShutdownChoice", index);
+				FlushConfig();
+
 				switch (index)
 				{
 				case 0:
@@ -374,8 +340,14 @@ int CALLBACK ginaShutdownView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, L
 		EndDialog(hWnd, 0);
 		break;
 	}
+	case WM_DPICHANGED:
+	{
+		ginaManager::Get()->OnDpiChanged(hWnd, wParam, lParam, FALSE);
+		break;
+	}
 	case WM_DESTROY:
 	{
+		ginaGdiCache::Get()->ReleaseControlIcon(GetDlgItem(hWnd, GetRes(IDC_SHUTDOWN_ICON)));
 		PostQuitMessage(0); // Trigger exit thread
 		break;
 	}
@@ -430,6 +402,7 @@ void ginaLogoffView::BeginMessageLoop()
 {
 	ginaLogoffView* dlg = ginaLogoffView::Get();
 	MSG msg;
+	ginaWatchdogBeat beat(GV_LOGOFF);
 	while (GetMessageW(&msg, NULL, 0, 0))
 	{
 		if (!IsDialogMessageW(dlg->hDlg, &msg))
@@ -446,23 +419,16 @@ int CALLBACK ginaLogoffView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 	{
 	case WM_INITDIALOG:
 	{
-		HINSTANCE hGinaDll = ginaManager::Get()->hGinaDll;
-
 		// Load the icon (logoff icon in msgina.dll for 2000+, generic MB_ICONINFORMATION icon for NT4)
 		HWND hLogoffIcon = GetDlgItem(hWnd, GetRes(IDC_LOGOFF_ICON));
 		HICON hIcon = NULL;
 		if (ginaManager::Get()->ginaVersion == GINA_VER_NT4)
 		{
-			HINSTANCE hShell32 = LoadLibraryW(L"shell32.dll");
-			if (hShell32)
-			{
-				hIcon = (HICON)LoadImageW(hShell32, MAKEINTRESOURCEW(SHELL32_INFO), IMAGE_ICON, 0, 0, LR_DEFAULTSIZE | LR_VGACOLOR);
-				FreeLibrary(hShell32);
-			}
+			hIcon = ginaGdiCache::Get()->AcquireIcon(L"shell32.dll", SHELL32_INFO, 0, 0, LR_VGACOLOR);
 		}
 		else
 		{
-			hIcon = LoadIconW(hGinaDll, MAKEINTRESOURCEW(IDI_LOGOFF));
+			hIcon = ginaGdiCache::Get()->AcquireIcon(NULL, IDI_LOGOFF, 0, 0);
 		}
 		if (hIcon)
 		{
@@ -487,6 +453,7 @@ int CALLBACK ginaLogoffView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 	}
 	case WM_DESTROY:
 	{
+		ginaGdiCache::Get()->ReleaseControlIcon(GetDlgItem(hWnd, GetRes(IDC_LOGOFF_ICON)));
 		PostQuitMessage(0); // Trigger exit thread
 		break;
 	}
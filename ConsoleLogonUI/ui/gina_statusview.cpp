@@ -29,18 +29,29 @@ void external::StatusView_SetActive(const wchar_t* text)
 	std::thread([=] {
 		//ginaManager::Get()->PostThemeChange();
 
-		if (ginaStatusView::Get()->isActive.exchange(true)) {
+		GINATRANSITION transition = ginaViewState::Get()->Enter(GV_STATUS);
+		if (transition == GT_DENY) {
 			ginaSelectedCredentialView::Get()->Destroy();
 			ginaStatusView::Get()->UpdateText();
 			return;
 		}
 
-		ginaManager::Get()->CloseAllDialogs();
-		
+		if (transition == GT_REPLACE) {
+			ginaManager::Get()->CloseAllDialogs();
+		}
+
+		if (ginaDialogPool::Get()->Show(GV_STATUS)) {
+			ginaViewState::Get()->Shown(GV_STATUS);
+			ginaDialogPool::Get()->WaitHidden(GV_STATUS);
+			ginaViewState::Get()->Leave(GV_STATUS);
+			return;
+		}
+
 		ginaStatusView::Get()->Create();
 		ginaStatusView::Get()->Show();
+		ginaViewState::Get()->Shown(GV_STATUS);
 		ginaStatusView::Get()->BeginMessageLoop();
-		ginaStatusView::Get()->isActive = false;
+		ginaViewState::Get()->Leave(GV_STATUS);
 	}).detach();
 }
 
@@ -81,6 +92,11 @@ void ginaStatusView::Create()
 
 void ginaStatusView::Destroy()
 {
+	// The pooled dialog is kept for the next time
+	if (ginaDialogPool::Get()->Hide(GV_STATUS))
+	{
+		return;
+	}
 	ginaStatusView* dlg = ginaStatusView::Get();
 	EndDialog(dlg->hDlg, 0);
 	PostMessage(dlg->hDlg, WM_DESTROY, 0, 0);
@@ -104,6 +120,21 @@ void ginaStatusView::Hide()
 	ShowWindow(dlg->hDlg, SW_HIDE);
 }
 
+void ginaStatusView::PoolShow(HWND hDlg)
+{
+	SetDlgItemTextW(hDlg, GetRes(IDC_STATUS_TEXT), g_statusText.c_str());
+	Show();
+	StartTimers(hDlg);
+}
+
+void ginaStatusView::PoolHide(HWND hDlg)
+{
+	KillTimer(hDlg, IDT_STATUS_BAR);
+	KillTimer(hDlg, IDT_STATUS_STATE);
+	// The bar starts over from the left next time
+	FreeBar();
+}
+
 void ginaStatusView::UpdateText()
 {
 	ginaStatusView* dlg = ginaStatusView::Get();
@@ -114,6 +145,7 @@ void ginaStatusView::BeginMessageLoop()
 {
 	ginaStatusView* dlg = ginaStatusView::Get();
 	MSG msg;
+	ginaWatchdogBeat beat(GV_STATUS);
 	while (GetMessageW(&msg, NULL, 0, 0))
 	{
 		TranslateMessage(&msg);
@@ -121,6 +153,139 @@ void ginaStatusView::BeginMessageLoop()
 	}
 }
 
+void ginaStatusView::StartTimers(HWND hWnd)
+{
+	if (ginaManager::Get()->ginaVersion != GINA_VER_NT4)
+	{
+		SetTimer(hWnd, IDT_STATUS_BAR, 20, NULL);
+	}
+	// Nothing here has to be checked at frame rate
+	SetTimer(hWnd, IDT_STATUS_STATE, 100, NULL);
+	CheckState(hWnd);
+}
+
+void ginaStatusView::CheckState(HWND hWnd)
+{
+	// ConsoleLogon may activate the status view after the security or credential view
+	if (ginaViewState::Get()->ShouldYield(GV_STATUS))
+	{
+		ginaStatusView::Get()->Destroy();
+		return;
+	}
+
+	if (ginaManager::Get()->initedPreLogon != IsSystemUser() && !g_appliedUserChangeOnce && !ginaViewState::Get()->IsActive(GV_LOCKED))
+	{
+		// When the classic theme is enabled (with SetWindowTheme, ThemeSection closing, etc.), the color scheme is not applied properly
+		// Windows doesn't properly notify windows about the color scheme change when logging on and off
+		// So we have to manually apply the color scheme here
+		ApplyUserColors();
+		// And make WallHost update the background image
+		PostMessage(wallHost::Get()->hWnd, WM_THEMECHANGED, 0, 0);
+		
+		g_appliedUserChangeOnce = TRUE;
+	}
+}
+
+void ginaStatusView::PaintBar(HWND hWnd, HDC hdc)
+{
+	ginaStatusView* dlg = ginaStatusView::Get();
+	ginaBrandingAssets assets = ginaManager::Get()->GetBrandingAssets(GetWindowDpi(hWnd));
+
+	LARGE_INTEGER freq, now, end;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+
+	RECT rc;
+	GetClientRect(hWnd, &rc);
+	int cx = rc.right - rc.left;
+	if (cx <= 0)
+		return;
+
+	if (dlg->barWidth != cx)
+	{
+		FreeBar();
+
+		dlg->hdcBar = CreateCompatibleDC(hdc);
+		dlg->hbmBar = CreateCompatibleBitmap(hdc, cx * 2, assets.sizeBar.cy);
+		if (!dlg->hdcBar || !dlg->hbmBar)
+		{
+			FreeBar();
+			return;
+		}
+		dlg->hbmBarOld = (HBITMAP)SelectObject(dlg->hdcBar, dlg->hbmBar);
+
+		HDC hdcMem = CreateCompatibleDC(hdc);
+		HBITMAP hbmOld = (HBITMAP)SelectObject(hdcMem, assets.hBar);
+		for (int i = 0; i < 2; i++)
+		{
+			StretchBlt(dlg->hdcBar, i * cx, 0, cx, assets.sizeBar.cy, hdcMem, 0, 0, assets.sizeBar.cx, assets.sizeBar.cy, SRCCOPY);
+		}
+		SelectObject(hdcMem, hbmOld);
+		DeleteDC(hdcMem);
+
+		dlg->barWidth = cx;
+	}
+
+	// Position comes from the elapsed time, so late or dropped timer ticks don't slow the bar down
+	if (!dlg->barStart)
+		dlg->barStart = now.QuadPart;
+	int offset = (int)(((now.QuadPart - dlg->barStart) * STATUS_BAR_PX_PER_SEC / freq.QuadPart) % cx);
+
+	BitBlt(hdc, 0, assets.sizeSmallBrand.cy, cx, assets.sizeBar.cy, dlg->hdcBar, cx - offset, 0, SRCCOPY);
+
+	QueryPerformanceCounter(&end);
+	if (dlg->lastFrame)
+	{
+		LONGLONG expected = freq.QuadPart * 20 / 1000;
+		LONGLONG jitter = now.QuadPart - dlg->lastFrame - expected;
+		if (jitter < 0)
+			jitter = -jitter;
+		dlg->totalJitter += jitter;
+		if (jitter > dlg->maxJitter)
+			dlg->maxJitter = jitter;
+		dlg->totalPaint += end.QuadPart - now.QuadPart;
+
+		if (++dlg->frames == STATUS_BAR_STATS_FRAMES)
+		{
+			dbgprintf(
+				L"CLH_GINA: Status bar %d frames, jitter avg %lld us max %lld us, paint avg %lld us",
+				dlg->frames,
+				dlg->totalJitter * 1000000 / freq.QuadPart / dlg->frames,
+				dlg->maxJitter * 1000000 / freq.QuadPart,
+				dlg->totalPaint * 1000000 / freq.QuadPart / dlg->frames
+			);
+			dlg->frames = 0;
+			dlg->totalJitter = 0;
+			dlg->maxJitter = 0;
+			dlg->totalPaint = 0;
+		}
+	}
+	dlg->lastFrame = now.QuadPart;
+}
+
+void ginaStatusView::FreeBar()
+{
+	ginaStatusView* dlg = ginaStatusView::Get();
+	if (dlg->hdcBar)
+	{
+		if (dlg->hbmBarOld)
+			SelectObject(dlg->hdcBar, dlg->hbmBarOld);
+		DeleteDC(dlg->hdcBar);
+	}
+	if (dlg->hbmBar)
+		DeleteObject(dlg->hbmBar);
+	dlg->hdcBar = NULL;
+	dlg->hbmBar = NULL;
+	dlg->hbmBarOld = NULL;
+	dlg->barWidth = 0;
+	dlg->barStart = 0;
+	dlg->lastFrame = 0;
+	dlg->frames = 0;
+	dlg->totalJitter = 0;
+	dlg->maxJitter = 0;
+	dlg->totalPaint = 0;
+}
+
 int CALLBACK ginaStatusView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
 	switch (message)
@@ -128,43 +293,54 @@ int CALLBACK ginaStatusView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 	case WM_INITDIALOG:
 	{
 		ginaManager::Get()->MoveChildrenForBranding(hWnd, FALSE);
-		SetTimer(hWnd, 20, 20, NULL);
-		[[fallthrough]];
+		// Pooled dialogs start them each time they're shown
+		if (lParam != GINA_DLG_POOLED)
+		{
+			StartTimers(hWnd);
+		}
+		break;
 	}
 	case WM_TIMER:
 	{
-		// Dirty hack around the timing issue with security view open and status view close
-		if (ginaSecurityControl::Get()->isActive || ginaSelectedCredentialView::Get()->isActive)
+		if (wParam == IDT_STATUS_STATE)
 		{
-			ginaStatusView::Get()->Destroy();
-			return 0;
+			CheckState(hWnd);
 		}
-
-		if (ginaManager::Get()->initedPreLogon != IsSystemUser() && !g_appliedUserChangeOnce && !ginaSelectedCredentialViewLocked::Get()->isActive)
+		else if (wParam == IDT_STATUS_BAR)
 		{
-			// When the classic theme is enabled (with SetWindowTheme, ThemeSection closing, etc.), the color scheme is not applied properly
-			// Windows doesn't properly notify windows about the color scheme change when logging on and off
-			// So we have to manually apply the color scheme here
-			ApplyUserColors();
-			// And make WallHost update the background image
-			PostMessage(wallHost::Get()->hWnd, WM_THEMECHANGED, 0, 0);
-			
-			g_appliedUserChangeOnce = TRUE;
+			// Only the bar strip moves
+			ginaBrandingAssets assets = ginaManager::Get()->GetBrandingAssets(GetWindowDpi(hWnd));
+			RECT rcBar;
+			GetClientRect(hWnd, &rcBar);
+			rcBar.top = assets.sizeSmallBrand.cy;
+			rcBar.bottom = rcBar.top + assets.sizeBar.cy;
+			InvalidateRect(hWnd, &rcBar, FALSE);
 		}
-
-		if (ginaManager::Get()->ginaVersion == GINA_VER_NT4)
+		break;
+	}
+	case WM_PAINT:
+	{
+		PAINTSTRUCT ps;
+		HDC hdc = BeginPaint(hWnd, &ps);
+		if (ginaManager::Get()->ginaVersion != GINA_VER_NT4)
 		{
-			break;
+			RECT rc;
+			GetClientRect(hWnd, &rc);
+			// Full repaints also need the brand above the bar
+			if (ps.rcPaint.top < ginaManager::Get()->GetBrandingAssets(GetWindowDpi(hWnd)).sizeSmallBrand.cy)
+			{
+				ginaManager::Get()->PaintBranding(hdc, &rc, FALSE);
+			}
+			PaintBar(hWnd, hdc);
 		}
-
-		RECT rect;
-		GetClientRect(hWnd, &rect);
-		int dlgWidth = rect.right - rect.left;
-		int barOffset = ginaStatusView::Get()->barOffset;
-		HDC hdc = GetDC(hWnd);
-		ginaManager::Get()->PaintBranding(hdc, &rect, FALSE, barOffset);
-		ReleaseDC(hWnd, hdc);
-		ginaStatusView::Get()->barOffset = (barOffset + 5) % dlgWidth;
+		EndPaint(hWnd, &ps);
+		return 0;
+	}
+	case WM_DPICHANGED:
+	{
+		// The strip is prescaled, build it again at the new bar height
+		FreeBar();
+		ginaManager::Get()->OnDpiChanged(hWnd, wParam, lParam, FALSE);
 		break;
 	}
 	case WM_COMMAND:
@@ -173,9 +349,10 @@ int CALLBACK ginaStatusView::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 	}
 	case WM_DESTROY:
 	{
+		FreeBar();
 		PostQuitMessage(0); // Trigger exit thread
 		break;
 	}
 	}
 	return 0;
-}
\ No newline at end of file
+}
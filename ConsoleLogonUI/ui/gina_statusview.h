@@ -5,18 +5,42 @@
 
 #define IDC_STATUS_TEXT 101, 2451
 
+#define IDT_STATUS_BAR 20
+#define IDT_STATUS_STATE 21
+
+// Same speed as the original 5 px per 20 ms tick
+#define STATUS_BAR_PX_PER_SEC 250
+// Report frame statistics about every 5 seconds
+#define STATUS_BAR_STATS_FRAMES 250
+
 class ginaStatusView
 {
 public:
 	HWND hDlg;
-	int barOffset = 0;
-	std::atomic <bool> isActive;
+	// Bar animation, the bar is tiled twice so every frame is a single blit at a moving source offset
+	HDC hdcBar = NULL;
+	HBITMAP hbmBar = NULL;
+	HBITMAP hbmBarOld = NULL;
+	int barWidth = 0;
+	LONGLONG barStart = 0;
+	LONGLONG lastFrame = 0;
+	int frames = 0;
+	LONGLONG totalJitter = 0;
+	LONGLONG maxJitter = 0;
+	LONGLONG totalPaint = 0;
 	static ginaStatusView* Get();
 	static void Create();
 	static void Destroy();
 	static void Show();
 	static void Hide();
+	// ginaDialogPool callbacks
+	static void PoolShow(HWND hDlg);
+	static void PoolHide(HWND hDlg);
 	static void UpdateText();
+	static void StartTimers(HWND hWnd);
+	static void CheckState(HWND hWnd);
+	static void PaintBar(HWND hWnd, HDC hdc);
+	static void FreeBar();
 	static void BeginMessageLoop();
 	static int CALLBACK DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
 };
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+#include "gina_strings.h"
+
+// String ids are 16 bit, tables hold 16 strings each
+#define GINA_STRING_BLOCKS 4096
+
+ginaStrings* ginaStrings::Get()
+{
+	static ginaStrings strings;
+	return &strings;
+}
+
+ginaStrings::ginaStrings()
+	: _count(0)
+{
+}
+
+void ginaStrings::Load(const peResources& resources)
+{
+	Clear();
+	_blocks.assign(GINA_STRING_BLOCKS, -1);
+
+	// Size the pool up front so the offsets handed out never move
+	size_t poolSize = 0;
+	for (const peResourceEntry& resource : resources.GetEntries())
+	{
+		if (resource.type == PE_RT_STRING)
+		{
+			poolSize += resource.span.size / 2 + 16;
+		}
+	}
+	_pool.reserve(poolSize);
+
+	for (const peResourceEntry& resource : resources.GetEntries())
+	{
+		if (resource.type != PE_RT_STRING || resource.id == 0 || resource.id > GINA_STRING_BLOCKS)
+			continue;
+
+		// Only the preferred language of each block, the entries are sorted so the first one wins
+		int block = resource.id - 1;
+		if (_blocks[block] != -1)
+			continue;
+
+		_blocks[block] = (int32_t)_entries.size();
+		for (int i = 0; i < 16; i++)
+		{
+			uint16_t id = (uint16_t)((block << 4) | i);
+			const char16_t* pString;
+			uint32_t length;
+			entry e = { 0, 0 };
+			if (resources.GetString(id, &pString, &length))
+			{
+				e.offset = (uint32_t)_pool.size();
+				e.length = length;
+				for (uint32_t j = 0; j < length; j++)
+				{
+					_pool.push_back((wchar_t)pString[j]);
+				}
+				_pool.push_back(L'\0');
+				_count++;
+			}
+			_entries.push_back(e);
+		}
+	}
+}
+
+void ginaStrings::Clear()
+{
+	_pool.clear();
+	_blocks.clear();
+	_entries.clear();
+	_count = 0;
+}
+
+std::wstring_view ginaStrings::Find(unsigned int id) const
+{
+	if (_blocks.empty() || id > 0xFFFF)
+		return std::wstring_view();
+
+	int32_t first = _blocks[id >> 4];
+	if (first < 0)
+		return std::wstring_view();
+
+	const entry& e = _entries[first + (id & 15)];
+	if (!e.length)
+		return std::wstring_view();
+	return std::wstring_view(_pool.data() + e.offset, e.length);
+}
+
+const wchar_t* ginaStrings::Text(unsigned int id, const wchar_t* fallback) const
+{
+	std::wstring_view text = Find(id);
+	// Views come straight from the pool, so they're followed by their terminator
+	return text.empty() ? fallback : text.data();
+}
+
+size_t ginaStrings::GetCount() const
+{
+	return _count;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "util/pe_resources.h"
+
+// Every string of msgina.dll, decoded once when it's loaded
+// Filled by LoadGina before any view comes up and read-only afterwards, so lookups need no lock
+class ginaStrings
+{
+public:
+	static ginaStrings* Get();
+
+	void Load(const peResources& resources);
+	void Clear();
+
+	// Empty view when msgina.dll doesn't have the string
+	std::wstring_view Find(unsigned int id) const;
+	// Null terminated, fallback is returned when msgina.dll doesn't have the string
+	const wchar_t* Text(unsigned int id, const wchar_t* fallback = L"") const;
+
+	size_t GetCount() const;
+
+private:
+	ginaStrings();
+
+	struct entry
+	{
+		uint32_t offset; // Into _pool
+		uint32_t length; // 0 if missing
+	};
+
+	// All strings back to back, each null terminated
+	std::wstring _pool;
+	// Index into _entries of the first of the 16 strings of each table block, -1 if msgina.dll doesn't have the block
+	std::vector<int32_t> _blocks;
+	std::vector<entry> _entries;
+	size_t _count;
+};
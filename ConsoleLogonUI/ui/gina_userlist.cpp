@@ -0,0 +1,47 @@
+#pragma once
+#include "gina_userlist.h"
+#include <algorithm>
+#include <numeric>
+
+userList SortUserList(std::vector<userListEntry> users, USERSORTKEYPROC pfnSortKey)
+{
+	std::vector<std::vector<uint8_t>> keys;
+	keys.reserve(users.size());
+	for (const userListEntry& user : users)
+	{
+		keys.push_back(pfnSortKey(user.text));
+	}
+
+	std::vector<size_t> order(users.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+	auto sorted = std::make_shared<std::vector<userListEntry>>();
+	sorted->reserve(users.size());
+	for (size_t i : order)
+	{
+		sorted->push_back(std::move(users[i]));
+	}
+	return sorted;
+}
+
+userList RemoveFromUserList(const userList& users, void* actualInstance)
+{
+	if (!UserListContains(users, actualInstance))
+		return users;
+
+	auto filtered = std::make_shared<std::vector<userListEntry>>();
+	filtered->reserve(users->size() - 1);
+	for (const userListEntry& user : *users)
+	{
+		if (user.actualInstance != actualInstance)
+			filtered->push_back(user);
+	}
+	return filtered;
+}
+
+bool UserListContains(const userList& users, void* actualInstance)
+{
+	return users && std::any_of(users->begin(), users->end(),
+		[actualInstance](const userListEntry& user) { return user.actualInstance == actualInstance; });
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The list the user select dialog offers, kept apart from the controls the hook hands over
+// Doesn't depend on Win32, the sort key comes from the caller (GetSortKey in the DLL)
+
+// One user of the list as it was when the list was sorted
+struct userListEntry
+{
+	void* actualInstance;
+	std::wstring text;
+};
+
+typedef std::shared_ptr<const std::vector<userListEntry>> userList;
+typedef std::vector<uint8_t> (*USERSORTKEYPROC)(const std::wstring& text);
+
+// Orders the entries by the keys of their names, each key is worked out once instead of per comparison
+// Names with equal keys keep the order they came in
+userList SortUserList(std::vector<userListEntry> users, USERSORTKEYPROC pfnSortKey);
+// The list without the entry for actualInstance, the same list if it isn't in there
+userList RemoveFromUserList(const userList& users, void* actualInstance);
+bool UserListContains(const userList& users, void* actualInstance);
@@ -6,6 +6,7 @@
 #include "gina_userselect.h"
 #include "gina_shutdownview.h"
 #include "../util/util.h"
+#include "../util/sort_key.h"
 #include "util/interop.h"
 #include <thread>
 #include <atomic>
@@ -13,8 +14,8 @@
 
 std::vector<SelectableUserOrCredentialControlWrapper> buttons;
 
-std::atomic<bool> isUserSelectActive(false);
 std::mutex userSelectMutex;
+userList g_users = std::make_shared<const std::vector<userListEntry>>();
 
 HWND g_hUsernameCombo = NULL;
 
@@ -31,21 +32,34 @@ void external::SelectableUserOrCredentialControl_Sort()
 		return;
 	}
 
-	std::lock_guard<std::mutex> lock(userSelectMutex);
-	
-	std::sort(buttons.begin(), buttons.end(), [](SelectableUserOrCredentialControlWrapper& a, SelectableUserOrCredentialControlWrapper& b) { return a.GetText() < b.GetText(); });
-	
+	{
+		std::lock_guard<std::mutex> lock(userSelectMutex);
+
+		// Names were fetched once when the controls were created
+		std::vector<userListEntry> users;
+		users.reserve(buttons.size());
+		for (const auto& button : buttons)
+		{
+			users.push_back({ button.actualInstance, button.text });
+		}
+		g_users = SortUserList(std::move(users), GetSortKey);
+	}
+
 	std::thread([=] {
-		if (isUserSelectActive.exchange(true)) {
+		GINATRANSITION transition = ginaViewState::Get()->Enter(GV_USERSELECT);
+		if (transition == GT_DENY) {
 			return;
 		}
 
-		ginaManager::Get()->CloseAllDialogs();
+		if (transition == GT_REPLACE) {
+			ginaManager::Get()->CloseAllDialogs();
+		}
 
 		ginaUserSelect::Get()->Create();
 		ginaUserSelect::Get()->Show();
+		ginaViewState::Get()->Shown(GV_USERSELECT);
 		ginaUserSelect::Get()->BeginMessageLoop();
-		isUserSelectActive = false;
+		ginaViewState::Get()->Leave(GV_USERSELECT);
 	}).detach();
 }
 
@@ -55,12 +69,17 @@ void external::SelectableUserOrCredentialControl_Create(void* actualInstance, co
     SelectableUserOrCredentialControlWrapper wrapper;
     wrapper.actualInstance = actualInstance;
 	//wrapper.pfp = GetHBITMAPFromImageFile(const_cast<WCHAR*>(path)); // i don't need this
+	// The name doesn't change, fetch it across once instead of on every sort and redraw
+	wrapper.GetText();
+	wrapper.hastext = true;
 
+	std::lock_guard<std::mutex> lock(userSelectMutex);
     buttons.push_back(wrapper);
 }
 
 void external::SelectableUserOrCredentialControl_Destroy(void* actualInstance)
 {
+	std::lock_guard<std::mutex> lock(userSelectMutex);
     for (int i = 0; i < buttons.size(); ++i)
     {
         auto& button = buttons[i];
@@ -68,6 +87,8 @@ void external::SelectableUserOrCredentialControl_Destroy(void* actualInstance)
         {
             // SPDLOG_INFO("Found button instance and removing!");
             buttons.erase(buttons.begin() + i);
+            // Until the next sort the published list would still offer it
+            g_users = RemoveFromUserList(g_users, actualInstance);
             break;
         }
     }
@@ -95,6 +116,12 @@ ginaUserSelect* ginaUserSelect::Get()
 	return &dlg;
 }
 
+userList ginaUserSelect::GetUsers()
+{
+	std::lock_guard<std::mutex> lock(userSelectMutex);
+	return g_users;
+}
+
 void ginaUserSelect::Create()
 {
 	if (!IsSystemUser())
@@ -144,6 +171,7 @@ void ginaUserSelect::BeginMessageLoop()
 {
 	ginaUserSelect* dlg = ginaUserSelect::Get();
 	MSG msg;
+	ginaWatchdogBeat beat(GV_USERSELECT);
 	while (GetMessageW(&msg, NULL, 0, 0))
 	{
 		if (!IsDialogMessageW(dlg->hDlg, &msg))
@@ -154,132 +182,103 @@ void ginaUserSelect::BeginMessageLoop()
 	}
 }
 
+// Fills the combo box from the last published list and keeps that list for pressing
+static void FillUserCombo(HWND hCombo)
+{
+	ginaUserSelect::Get()->users = ginaUserSelect::GetUsers();
+	const std::vector<userListEntry>& users = *ginaUserSelect::Get()->users;
+	// Hundreds of users on shared PCs, allocate once and draw once
+	SendMessageW(hCombo, WM_SETREDRAW, FALSE, 0);
+	SendMessageW(hCombo, CB_RESETCONTENT, 0, 0);
+	SendMessageW(hCombo, CB_INITSTORAGE, users.size(), users.size() * 32 * sizeof(WCHAR));
+	for (int i = (int)users.size() - 1; i >= 0; i--)
+	{
+		SendMessageW(hCombo, CB_ADDSTRING, 0, (LPARAM)users[i].text.c_str());
+	}
+	SendMessageW(hCombo, WM_SETREDRAW, TRUE, 0);
+	InvalidateRect(hCombo, NULL, TRUE);
+	SendMessageW(hCombo, CB_SETCURSEL, 0, 0);
+}
+
 int CALLBACK ginaUserSelect::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 {
 	switch (message)
 	{
 	case WM_INITDIALOG:
 	{
-		RECT dlgRect;
-		GetWindowRect(hWnd, &dlgRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&dlgRect, 2);
+		// Work out where everything goes from the template first, then move the controls in one go
+		dlgLayout layout;
+		ginaManager::Get()->LoadLayout(hWnd, GetRes(GINA_DLG_USER_SELECT), &layout);
 		int dlgHeightToReduce = 0;
 		int bottomBtnYToMove = 0;
 
 		// Hide the legal announcement
-		HWND hLegalAnnouncement = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LEGAL));
-		if (hLegalAnnouncement)
+		dlgItem* pLegal = layout.Find(GetRes(IDC_CREDVIEW_LEGAL));
+		if (pLegal)
 		{
-			RECT legalRect;
-			GetWindowRect(hLegalAnnouncement, &legalRect);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&legalRect, 2);
-			dlgHeightToReduce = legalRect.bottom - legalRect.top;
-			ShowWindow(hLegalAnnouncement, SW_HIDE);
-
-			HWND hChild = GetWindow(hWnd, GW_CHILD);
-			while (hChild != NULL)
-			{
-				if (hChild != hLegalAnnouncement)
-				{
-					RECT childRect;
-					GetWindowRect(hChild, &childRect);
-					MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&childRect, 2);
-					if (childRect.top > 6)
-					{
-						SetWindowPos(hChild, NULL, childRect.left, childRect.top - legalRect.bottom, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
-					}
-				}
-				hChild = GetWindow(hChild, GW_HWNDNEXT);
-			}
+			dlgHeightToReduce = pLegal->cy;
+			layout.Hide(pLegal->id);
+			layout.OffsetBelow(6, -(pLegal->y + pLegal->cy), pLegal->id);
 		}
 
 		// Hide the XP-specific locked message for the pre-logon dialog
 		// (Used in XP when the Welcome screen is disabled and tsdiscon.exe is used)
-		HWND hLockedGroupBox = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_XP_LOCKED_GROUP));
-		if (hLockedGroupBox)
+		dlgItem* pLockedGroupBox = layout.Find(GetRes(IDC_CREDVIEW_XP_LOCKED_GROUP));
+		if (pLockedGroupBox)
 		{
-			ShowWindow(hLockedGroupBox, SW_HIDE);
-			RECT lockedRect;
-			GetWindowRect(hLockedGroupBox, &lockedRect);
-			MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&lockedRect, 2);
-			HWND hLockedInfo = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_XP_LOCKED_INFO));
-			HWND hLockedUsernameInfo = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_USERNAME_INFO));
-			HWND hLockedIcon = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LOCKED_ICON));
-			ShowWindow(hLockedInfo, SW_HIDE);
-			ShowWindow(hLockedUsernameInfo, SW_HIDE);
-			ShowWindow(hLockedIcon, SW_HIDE);
-			dlgHeightToReduce += lockedRect.bottom - lockedRect.top;
+			layout.Hide(pLockedGroupBox->id);
+			layout.Hide(GetRes(IDC_CREDVIEW_XP_LOCKED_INFO));
+			layout.Hide(GetRes(IDC_CREDVIEW_LOCKED_USERNAME_INFO));
+			layout.Hide(GetRes(IDC_CREDVIEW_LOCKED_ICON));
+			dlgHeightToReduce += pLockedGroupBox->cy;
 		}
 
 		// Load the icon (NT4 only)
 		HWND hIcon = GetDlgItem(hWnd, IDC_CREDVIEW_ICON);
 		if (hIcon)
 		{
-			SendMessageW(hIcon, STM_SETICON, (WPARAM)LoadImageW(ginaManager::Get()->hGinaDll, MAKEINTRESOURCEW(IDI_LOGON), IMAGE_ICON, 64, 64, LR_DEFAULTCOLOR), 0);
+			SendMessageW(hIcon, STM_SETICON, (WPARAM)ginaGdiCache::Get()->AcquireIcon(NULL, IDI_LOGON, 64, GetWindowDpi(hWnd)), 0);
 		}
 
-		// Replace the username input with a combo box
-		HWND hUsername = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_USERNAME));
-		RECT usernameRect;
-		GetWindowRect(hUsername, &usernameRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&usernameRect, 2);
-		ShowWindow(hUsername, SW_HIDE);
-
-		// Add users to the combo box
-		g_hUsernameCombo = CreateWindowExW(0, L"COMBOBOX", L"UserSelect", WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST | CBS_HASSTRINGS | WS_VSCROLL | WS_TABSTOP, usernameRect.left, usernameRect.top, usernameRect.right - usernameRect.left, usernameRect.bottom - usernameRect.top, hWnd, (HMENU)GetRes(IDC_CREDVIEW_USERNAME), NULL, NULL);
-		for (int i = buttons.size() - 1; i >= 0; i--)
-		{
-			SendMessageW(g_hUsernameCombo, CB_ADDSTRING, 0, (LPARAM)buttons[i].GetText().c_str());
-		}
-		SendMessageW(g_hUsernameCombo, CB_SETCURSEL, 0, 0);
-		SendMessageW(g_hUsernameCombo, WM_SETFONT, (WPARAM)GetStockObject(DEFAULT_GUI_FONT), MAKELPARAM(TRUE, 0));
+		// Replace the username input with a combo box, which is created once the layout is final
+		layout.Hide(GetRes(IDC_CREDVIEW_USERNAME));
 
 		// Hide the password input & label
-		HWND hPassword = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_PASSWORD));
-		HWND hPasswordLabel = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_PASSWORD_LABEL));
-		RECT passwordRect;
-		GetWindowRect(hPassword, &passwordRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&passwordRect, 2);
-		ShowWindow(hPassword, SW_HIDE);
-		ShowWindow(hPasswordLabel, SW_HIDE);
-		dlgHeightToReduce += passwordRect.bottom - passwordRect.top + 8;
-		bottomBtnYToMove = passwordRect.bottom - passwordRect.top + 8;
+		dlgItem* pPassword = layout.Find(GetRes(IDC_CREDVIEW_PASSWORD));
+		int passwordHeight = pPassword ? pPassword->cy : 0;
+		layout.Hide(GetRes(IDC_CREDVIEW_PASSWORD));
+		layout.Hide(GetRes(IDC_CREDVIEW_PASSWORD_LABEL));
+		dlgHeightToReduce += passwordHeight + 8;
+		bottomBtnYToMove = passwordHeight + 8;
 
 		// Hide the domain chooser
-		HWND hDomainChooser = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_DOMAIN));
-		HWND hDomainChooserLabel = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_DOMAIN_LABEL));
-		RECT domainRect;
-		GetWindowRect(hDomainChooser, &domainRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&domainRect, 2);
-		ShowWindow(hDomainChooser, SW_HIDE);
-		ShowWindow(hDomainChooserLabel, SW_HIDE);
-		dlgHeightToReduce += domainRect.bottom - domainRect.top + 8;
-		bottomBtnYToMove += domainRect.bottom - domainRect.top + 8;
+		dlgItem* pDomainChooser = layout.Find(GetRes(IDC_CREDVIEW_DOMAIN));
+		int domainHeight = pDomainChooser ? pDomainChooser->cy : 0;
+		layout.Hide(GetRes(IDC_CREDVIEW_DOMAIN));
+		layout.Hide(GetRes(IDC_CREDVIEW_DOMAIN_LABEL));
+		dlgHeightToReduce += domainHeight + 8;
+		bottomBtnYToMove += domainHeight + 8;
 
 		// Hide the dial-up checkbox
-		HWND hDialup = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_DIALUP));
-		RECT dialupRect;
-		GetWindowRect(hDialup, &dialupRect);
-		MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&dialupRect, 2);
-		ShowWindow(hDialup, SW_HIDE);
-		dlgHeightToReduce += dialupRect.bottom - dialupRect.top + 8;
-		bottomBtnYToMove += dialupRect.bottom - dialupRect.top;
+		dlgItem* pDialup = layout.Find(GetRes(IDC_CREDVIEW_DIALUP));
+		int dialupHeight = pDialup ? pDialup->cy : 0;
+		layout.Hide(GetRes(IDC_CREDVIEW_DIALUP));
+		dlgHeightToReduce += dialupHeight + 8;
+		bottomBtnYToMove += dialupHeight;
 
 		// Move the OK, Cancel, Shutdown, Options, and language icon controls up (2000+)
-		HWND hOK = GetDlgItem(hWnd, IDC_OK);
-		HWND hCancel = GetDlgItem(hWnd, IDC_CANCEL);
 		if (ginaManager::Get()->ginaVersion >= GINA_VER_2K)
 		{
-			HWND hShutdown = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_SHUTDOWN));
-			HWND hOptions = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_OPTIONS));
-			HWND hLanguageIcon = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_LANGUAGE));
-			HWND controlsToMove[] = { hOK, hCancel, hShutdown, hOptions, hLanguageIcon };
-			for (int i = 0; i < sizeof(controlsToMove) / sizeof(HWND); i++)
+			int controlsToMove[] = {
+				IDC_OK,
+				IDC_CANCEL,
+				GetRes(IDC_CREDVIEW_SHUTDOWN),
+				GetRes(IDC_CREDVIEW_OPTIONS),
+				GetRes(IDC_CREDVIEW_LANGUAGE)
+			};
+			for (int i = 0; i < sizeof(controlsToMove) / sizeof(int); i++)
 			{
-				RECT controlRect;
-				GetWindowRect(controlsToMove[i], &controlRect);
-				MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&controlRect, 2);
-				SetWindowPos(controlsToMove[i], NULL, controlRect.left, controlRect.top - bottomBtnYToMove, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
+				layout.Offset(controlsToMove[i], 0, -bottomBtnYToMove);
 			}
 		}
 		else
@@ -289,46 +288,42 @@ int CALLBACK ginaUserSelect::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 		}
 
 		// DIsable the Cancel button
-		EnableWindow(hCancel, FALSE);
+		EnableWindow(GetDlgItem(hWnd, IDC_CANCEL), FALSE);
 
 		HWND optBtn = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_OPTIONS));
 		if (optBtn)
 		{
 			// Load the options button state
 			BOOL isShutdownVisible = GetConfigInt(L"OptionsExpanded", 0);
-			if (!isShutdownVisible)
+			dlgItem* pShutdown = layout.Find(GetRes(IDC_CREDVIEW_SHUTDOWN));
+			if (!isShutdownVisible && pShutdown)
 			{
-				HWND hShutdown = GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_SHUTDOWN));
-				ShowWindow(hShutdown, SW_HIDE);
-				RECT shutdownRect;
-				GetWindowRect(hShutdown, &shutdownRect);
-				MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&shutdownRect, 2);
-				HWND controlsToMove[] = {
-					hOK,
-					hCancel
-				};
-				for (int i = 0; i < sizeof(controlsToMove) / sizeof(HWND); i++)
-				{
-					RECT controlRect;
-					GetWindowRect(controlsToMove[i], &controlRect);
-					MapWindowPoints(HWND_DESKTOP, hWnd, (LPPOINT)&controlRect, 2);
-					SetWindowPos(controlsToMove[i], NULL, controlRect.left + shutdownRect.right - shutdownRect.left, controlRect.top, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
-				}
+				layout.Hide(pShutdown->id);
+				layout.Offset(IDC_OK, pShutdown->cx, 0);
+				layout.Offset(IDC_CANCEL, pShutdown->cx, 0);
 			}
-			wchar_t optBtnStr[256];
-			LoadStringW(ginaManager::Get()->hGinaDll, isShutdownVisible ? GINA_STR_OPTBTN_COLLAPSE : GINA_STR_OPTBTN_EXPAND, optBtnStr, 256);
-			SetDlgItemTextW(hWnd, GetRes(IDC_CREDVIEW_OPTIONS), optBtnStr);
+			SetDlgItemTextW(hWnd, GetRes(IDC_CREDVIEW_OPTIONS), ginaStrings::Get()->Text(isShutdownVisible ? GINA_STR_OPTBTN_COLLAPSE : GINA_STR_OPTBTN_EXPAND));
 		}
 
 		// Resize the dialog (2000+)
-		SetWindowPos(hWnd, NULL, 0, 0, dlgRect.right - dlgRect.left, dlgRect.bottom - dlgRect.top - dlgHeightToReduce, SWP_NOZORDER | SWP_NOMOVE);
+		layout.Resize(0, -dlgHeightToReduce);
+		ginaManager::Get()->MoveChildrenForBranding(hWnd, &layout, TRUE);
+		ginaManager::Get()->ApplyLayout(hWnd, &layout);
+
+		// Add users to the combo box
+		dlgItem* pUsername = layout.Find(GetRes(IDC_CREDVIEW_USERNAME));
+		g_hUsernameCombo = NULL;
+		if (pUsername)
+		{
+			g_hUsernameCombo = CreateWindowExW(0, L"COMBOBOX", L"UserSelect", WS_CHILD | WS_VISIBLE | CBS_DROPDOWNLIST | CBS_HASSTRINGS | WS_VSCROLL | WS_TABSTOP, pUsername->x, pUsername->y, pUsername->cx, pUsername->cy, hWnd, (HMENU)GetRes(IDC_CREDVIEW_USERNAME), NULL, NULL);
+		}
+		FillUserCombo(g_hUsernameCombo);
+		SendMessageW(g_hUsernameCombo, WM_SETFONT, (WPARAM)GetStockObject(DEFAULT_GUI_FONT), MAKELPARAM(TRUE, 0));
 
 		// Set focus to the username combo box
 		SetFocus(GetDlgItem(hWnd, GetRes(IDC_CREDVIEW_PASSWORD)));
 		SendMessage(GetDlgItem(hWnd, IDC_OK), BM_SETSTYLE, BS_DEFPUSHBUTTON, TRUE);
 
-		ginaManager::Get()->MoveChildrenForBranding(hWnd, TRUE);
-
 		break;
 	}
 	case WM_COMMAND:
@@ -336,9 +331,24 @@ int CALLBACK ginaUserSelect::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 		if (LOWORD(wParam) == IDC_OK)
 		{
 			// OK button
-			int total = buttons.size();
+			userList users = ginaUserSelect::Get()->users;
+			int total = users ? (int)users->size() : 0;
 			int index = SendMessageW(g_hUsernameCombo, CB_GETCURSEL, 0, 0);
-			buttons[total - index - 1].Press();
+			if (index >= 0 && index < total)
+			{
+				void* actualInstance = (*users)[total - index - 1].actualInstance;
+
+				// The list may be older than the controls, don't press one the hook has destroyed since
+				if (UserListContains(GetUsers(), actualInstance))
+				{
+					external::SelectableUserOrCredentialControl_Press(actualInstance);
+				}
+				else
+				{
+					dbgprintf(L"CLH_GINA: Selected user is gone, refilling the user list");
+					FillUserCombo(g_hUsernameCombo);
+				}
+			}
 		}
 		else if (LOWORD(wParam) == IDC_CANCEL)
 		{
@@ -374,11 +384,8 @@ int CALLBACK ginaUserSelect::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 				SetWindowPos(controlsToMove[i], NULL, isShutdownVisible ? controlRect.left + shutdownRect.right - shutdownRect.left : controlRect.left - shutdownRect.right + shutdownRect.left, controlRect.top, 0, 0, SWP_NOZORDER | SWP_NOSIZE);
 			}
 			// Update the button string
-			HMODULE hGinaDll = ginaManager::Get()->hGinaDll;
-			wchar_t optBtnStr[256];
-			LoadStringW(hGinaDll, isShutdownVisible ? GINA_STR_OPTBTN_EXPAND : GINA_STR_OPTBTN_COLLAPSE, optBtnStr, 256);
-			SetDlgItemTextW(hWnd, 1514, optBtnStr);
-			SetConfigInt(L"OptionsExpanded", isShutdownVisible ? 0 : 1);
+			SetDlgItemTextW(hWnd, 1514, ginaStrings::Get()->Text(isShutdownVisible ? GINA_STR_OPTBTN_EXPAND : GINA_STR_OPTBTN_COLLAPSE));
+			SetConfigIntLater(L"OptionsExpanded", isShutdownVisible ? 0 : 1);
 		}
 		break;
 	}
@@ -392,8 +399,14 @@ int CALLBACK ginaUserSelect::DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPA
 		EndPaint(hWnd, &ps);
 		return 0;
 	}
+	case WM_DPICHANGED:
+	{
+		ginaManager::Get()->OnDpiChanged(hWnd, wParam, lParam, TRUE);
+		break;
+	}
 	case WM_DESTROY:
 	{
+		ginaGdiCache::Get()->ReleaseControlIcon(GetDlgItem(hWnd, IDC_CREDVIEW_ICON));
 		PostQuitMessage(0); // Trigger exit thread
 		break;
 	}
@@ -1,5 +1,6 @@
 #pragma once
 #include "gina_manager.h"
+#include "gina_userlist.h"
 #include <string>
 
 struct SelectableUserOrCredentialControlWrapper
@@ -27,5 +28,11 @@ public:
 	static void Hide();
 	static void BeginMessageLoop();
 	static int CALLBACK DlgProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam);
+
+	// The list published by the last sort, never modified; empty before the first one
+	static userList GetUsers();
+
+	// What the open dialog was filled from, so a re-sort can't shift the indices under it
+	userList users;
 };
 
@@ -0,0 +1,223 @@
+#pragma once
+#include "gina_viewstate.h"
+#include "gina_watchdog.h"
+#include <chrono>
+#include <cwchar>
+
+#define VIEWBIT(view) (1u << (view))
+
+// How each view comes up relative to the others
+static const GINATRANSITION c_transitions[GV_COUNT] = {
+	GT_DENY,    // GV_NONE
+	GT_REPLACE, // GV_USERSELECT
+	GT_REPLACE, // GV_SELECTEDCREDENTIAL
+	GT_REPLACE, // GV_LOCKED
+	GT_OVERLAY, // GV_CHANGEPWD, comes up from the selected credential view
+	GT_REPLACE, // GV_SECURITYCONTROL
+	GT_REPLACE, // GV_STATUS
+	GT_REPLACE, // GV_MESSAGE
+	GT_OVERLAY, // GV_SHUTDOWN, modal over its parent
+	GT_OVERLAY  // GV_LOGOFF, modal over its parent
+};
+
+// Views that have to go away when any of the listed views is active
+// ConsoleLogon can activate the status view after the security control or the credential view,
+// in which case the status view would end up on top of them
+static const uint32_t c_yieldsTo[GV_COUNT] = {
+	0, // GV_NONE
+	0, // GV_USERSELECT
+	0, // GV_SELECTEDCREDENTIAL
+	0, // GV_LOCKED
+	0, // GV_CHANGEPWD
+	0, // GV_SECURITYCONTROL
+	VIEWBIT(GV_SECURITYCONTROL) | VIEWBIT(GV_SELECTEDCREDENTIAL), // GV_STATUS
+	0, // GV_MESSAGE
+	0, // GV_SHUTDOWN
+	0  // GV_LOGOFF
+};
+
+static int64_t NowUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool IsValidView(GINAVIEW view)
+{
+	return view > GV_NONE && view < GV_COUNT;
+}
+
+ginaViewState* ginaViewState::Get()
+{
+	static ginaViewState state;
+	return &state;
+}
+
+ginaViewState::ginaViewState()
+	: _activeMask(0), _current(GV_NONE), _denied(0), _pfnSink(nullptr)
+{
+	for (int i = 0; i < GV_COUNT; i++)
+	{
+		_pendingFrom[i] = GV_NONE;
+		_pendingStartUs[i] = 0;
+	}
+	ResetStats();
+}
+
+GINATRANSITION ginaViewState::Enter(GINAVIEW view)
+{
+	if (!IsValidView(view))
+	{
+		return GT_DENY;
+	}
+
+	if (_activeMask.fetch_or(VIEWBIT(view)) & VIEWBIT(view))
+	{
+		_denied++;
+		return GT_DENY;
+	}
+
+	GINATRANSITION transition = c_transitions[view];
+	int from = transition == GT_REPLACE ? _current.exchange(view) : _current.load();
+	ginaWatchdog::Get()->Arm(view);
+
+	std::lock_guard<std::mutex> lock(_statsMutex);
+	_pendingFrom[view] = from;
+	_pendingStartUs[view] = NowUs();
+	return transition;
+}
+
+void ginaViewState::Shown(GINAVIEW view)
+{
+	if (!IsValidView(view))
+	{
+		return;
+	}
+
+	ginaWatchdog::Get()->Disarm(view);
+	ginaWatchdog::Get()->Disarm(GV_NONE);
+
+	int from;
+	uint64_t elapsedUs;
+	{
+		std::lock_guard<std::mutex> lock(_statsMutex);
+		if (!_pendingStartUs[view])
+		{
+			return;
+		}
+		from = _pendingFrom[view];
+		elapsedUs = (uint64_t)(NowUs() - _pendingStartUs[view]);
+		_pendingStartUs[view] = 0;
+
+		ginaTransitionStats& stats = _stats[from][view];
+		stats.count++;
+		stats.totalUs += elapsedUs;
+		if (elapsedUs > stats.maxUs)
+		{
+			stats.maxUs = elapsedUs;
+		}
+	}
+
+	void (*pfnSink)(const wchar_t*) = _pfnSink;
+	if (pfnSink)
+	{
+		wchar_t line[128];
+		swprintf(line, 128, L"CLH_GINA: %ls -> %ls in %llu us\n", GetViewName((GINAVIEW)from), GetViewName(view), (unsigned long long)elapsedUs);
+		pfnSink(line);
+	}
+}
+
+void ginaViewState::Leave(GINAVIEW view)
+{
+	if (!IsValidView(view))
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_statsMutex);
+		_pendingStartUs[view] = 0;
+	}
+
+	int expected = view;
+	_current.compare_exchange_strong(expected, GV_NONE);
+	ginaWatchdog::Get()->Disarm(view);
+	if (!(_activeMask.fetch_and(~VIEWBIT(view)) & ~VIEWBIT(view)))
+	{
+		// Nothing is up anymore, the next view has to come up in time
+		ginaWatchdog::Get()->Arm(GV_NONE);
+	}
+}
+
+bool ginaViewState::IsActive(GINAVIEW view) const
+{
+	return IsValidView(view) && (_activeMask.load() & VIEWBIT(view));
+}
+
+bool ginaViewState::ShouldYield(GINAVIEW view) const
+{
+	return IsValidView(view) && (_activeMask.load() & c_yieldsTo[view]);
+}
+
+GINAVIEW ginaViewState::Current() const
+{
+	return (GINAVIEW)_current.load();
+}
+
+ginaTransitionStats ginaViewState::GetStats(GINAVIEW from, GINAVIEW to)
+{
+	if (from < GV_NONE || from >= GV_COUNT || !IsValidView(to))
+	{
+		return {};
+	}
+	std::lock_guard<std::mutex> lock(_statsMutex);
+	return _stats[from][to];
+}
+
+uint64_t ginaViewState::GetDeniedCount() const
+{
+	return _denied;
+}
+
+void ginaViewState::ResetStats()
+{
+	std::lock_guard<std::mutex> lock(_statsMutex);
+	for (int i = 0; i < GV_COUNT; i++)
+	{
+		for (int j = 0; j < GV_COUNT; j++)
+		{
+			_stats[i][j] = {};
+		}
+	}
+	_denied = 0;
+}
+
+void ginaViewState::SetLogSink(void (*pfnSink)(const wchar_t* line))
+{
+	_pfnSink = pfnSink;
+}
+
+const wchar_t* ginaViewState::GetViewName(GINAVIEW view)
+{
+	static const wchar_t* names[GV_COUNT] = {
+		L"None",
+		L"UserSelect",
+		L"SelectedCredential",
+		L"Locked",
+		L"ChangePwd",
+		L"SecurityControl",
+		L"Status",
+		L"Message",
+		L"Shutdown",
+		L"Logoff"
+	};
+	if (view < GV_NONE || view >= GV_COUNT)
+	{
+		return L"?";
+	}
+	return names[view];
+}
+
+GINATRANSITION ginaViewState::GetTransition(GINAVIEW view)
+{
+	return IsValidView(view) ? c_transitions[view] : GT_DENY;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Which logon views are up and how they are allowed to replace each other
+// This doesn't touch any window, the dialogs call into it from their *_SetActive threads,
+// so the rules can be exercised without Win32
+
+enum GINAVIEW
+{
+	GV_NONE = 0,
+	GV_USERSELECT,
+	GV_SELECTEDCREDENTIAL,
+	GV_LOCKED,
+	GV_CHANGEPWD,
+	GV_SECURITYCONTROL,
+	GV_STATUS,
+	GV_MESSAGE,
+	GV_SHUTDOWN,
+	GV_LOGOFF,
+	GV_COUNT
+};
+
+enum GINATRANSITION
+{
+	GT_DENY = 0, // The view is already up
+	GT_REPLACE,  // Close every other view before showing this one
+	GT_OVERLAY   // Show on top of whatever is up
+};
+
+struct ginaTransitionStats
+{
+	uint64_t count;
+	uint64_t totalUs; // Enter -> Shown
+	uint64_t maxUs;
+};
+
+class ginaViewState
+{
+public:
+	static ginaViewState* Get();
+
+	// Marks the view as active and returns how it should come up
+	// GT_DENY means another thread already owns the view and nothing was changed
+	GINATRANSITION Enter(GINAVIEW view);
+	// Closes the cost accounting for the transition that brought the view up
+	void Shown(GINAVIEW view);
+	// Called once the view's message loop has exited
+	void Leave(GINAVIEW view);
+
+	bool IsActive(GINAVIEW view) const;
+	// True while a view this one has to give way to is active (e.g. status view vs. security control)
+	bool ShouldYield(GINAVIEW view) const;
+	GINAVIEW Current() const;
+
+	ginaTransitionStats GetStats(GINAVIEW from, GINAVIEW to);
+	uint64_t GetDeniedCount() const;
+	void ResetStats();
+
+	// Receives one line per finished transition, NULL to disable
+	void SetLogSink(void (*pfnSink)(const wchar_t* line));
+
+	static const wchar_t* GetViewName(GINAVIEW view);
+	static GINATRANSITION GetTransition(GINAVIEW view);
+
+private:
+	ginaViewState();
+
+	std::atomic<uint32_t> _activeMask;
+	std::atomic<int> _current;
+	std::atomic<uint64_t> _denied;
+
+	// Pending transition per target view
+	int _pendingFrom[GV_COUNT];
+	int64_t _pendingStartUs[GV_COUNT];
+
+	std::mutex _statsMutex;
+	ginaTransitionStats _stats[GV_COUNT][GV_COUNT];
+
+	std::atomic<void (*)(const wchar_t*)> _pfnSink;
+};
@@ -0,0 +1,217 @@
+#pragma once
+#include "gina_watchdog.h"
+#include <chrono>
+#include <thread>
+
+static int64_t NowUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ginaWatchdog* ginaWatchdog::Get()
+{
+	// Never destroyed, the watchdog thread is still waiting on it while statics are torn down
+	static ginaWatchdog* watchdog = new ginaWatchdog();
+	return watchdog;
+}
+
+ginaWatchdog::ginaWatchdog()
+	: _started(false), _timeoutUs(0), _beatMs(WATCHDOG_BEAT_MS), _pfnStall(nullptr)
+{
+	for (int i = 0; i < GV_COUNT; i++)
+	{
+		_deadlineUs[i] = 0;
+		_sinceUs[i] = 0;
+	}
+	for (int i = 0; i < WATCHDOG_HISTOGRAM_BUCKETS; i++)
+	{
+		_histogram[i] = 0;
+	}
+}
+
+void ginaWatchdog::Start(unsigned int timeoutMs, void (*pfnStall)(GINAVIEW view, uint64_t stalledMs))
+{
+	if (!timeoutMs || _started.exchange(true))
+	{
+		return;
+	}
+
+	_timeoutUs = (int64_t)GetEffectiveTimeoutMs(timeoutMs) * 1000;
+	_beatMs = GetBeatMs(timeoutMs);
+	_pfnStall = pfnStall;
+
+	// Nothing is up yet, ConsoleLogon is expected to activate a view
+	Arm(GV_NONE);
+
+	std::thread([] {
+		ginaWatchdog::Get()->Run();
+	}).detach();
+}
+
+unsigned int ginaWatchdog::GetBeatMs(unsigned int timeoutMs)
+{
+	unsigned int beatMs = timeoutMs / WATCHDOG_BEATS_PER_TIMEOUT;
+	if (beatMs < WATCHDOG_MIN_BEAT_MS)
+	{
+		return WATCHDOG_MIN_BEAT_MS;
+	}
+	return beatMs < WATCHDOG_BEAT_MS ? beatMs : WATCHDOG_BEAT_MS;
+}
+
+unsigned int ginaWatchdog::GetEffectiveTimeoutMs(unsigned int timeoutMs)
+{
+	const unsigned int minTimeoutMs = WATCHDOG_MIN_BEAT_MS * WATCHDOG_BEATS_PER_TIMEOUT;
+	return timeoutMs < minTimeoutMs ? minTimeoutMs : timeoutMs;
+}
+
+unsigned int ginaWatchdog::GetBeatMs()
+{
+	return _beatMs;
+}
+
+void ginaWatchdog::Arm(GINAVIEW view)
+{
+	if (!_started)
+	{
+		return;
+	}
+
+	int64_t now = NowUs();
+	int64_t expected = 0;
+	// Arming an armed view keeps the older deadline, and with it the time progress was last made
+	if (_deadlineUs[view].compare_exchange_strong(expected, now + _timeoutUs))
+	{
+		_sinceUs[view] = now;
+		// The watchdog may be sleeping past this deadline
+		std::lock_guard<std::mutex> lock(_mutex);
+		_cv.notify_one();
+	}
+}
+
+void ginaWatchdog::Beat(GINAVIEW view)
+{
+	if (!_started)
+	{
+		return;
+	}
+
+	if (!_deadlineUs[view])
+	{
+		Arm(view);
+		return;
+	}
+
+	// A later deadline never needs a wake up, the watchdog rechecks when it gets to the old one
+	int64_t now = NowUs();
+	Record(now - _sinceUs[view].exchange(now));
+	_deadlineUs[view] = now + _timeoutUs;
+}
+
+void ginaWatchdog::Disarm(GINAVIEW view)
+{
+	if (!_started)
+	{
+		return;
+	}
+
+	if (_deadlineUs[view].exchange(0))
+	{
+		Record(NowUs() - _sinceUs[view]);
+	}
+}
+
+void ginaWatchdog::GetHistogram(uint64_t (&buckets)[WATCHDOG_HISTOGRAM_BUCKETS])
+{
+	for (int i = 0; i < WATCHDOG_HISTOGRAM_BUCKETS; i++)
+	{
+		buckets[i] = _histogram[i];
+	}
+}
+
+void ginaWatchdog::Record(int64_t elapsedUs)
+{
+	uint64_t elapsedMs = elapsedUs > 0 ? (uint64_t)elapsedUs / 1000 : 0;
+	int bucket = 0;
+	while (elapsedMs && bucket < WATCHDOG_HISTOGRAM_BUCKETS - 1)
+	{
+		elapsedMs >>= 1;
+		bucket++;
+	}
+	_histogram[bucket]++;
+}
+
+void ginaWatchdog::Run()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true)
+	{
+		int64_t now = NowUs();
+		int64_t earliest = 0;
+		int stalled = -1;
+		for (int i = 0; i < GV_COUNT; i++)
+		{
+			int64_t deadline = _deadlineUs[i];
+			if (!deadline)
+			{
+				continue;
+			}
+			if (deadline <= now)
+			{
+				stalled = i;
+				break;
+			}
+			if (!earliest || deadline < earliest)
+			{
+				earliest = deadline;
+			}
+		}
+
+		if (stalled != -1)
+		{
+			uint64_t stalledMs = (uint64_t)(now - _sinceUs[stalled]) / 1000;
+			Disarm((GINAVIEW)stalled);
+			lock.unlock();
+			_pfnStall((GINAVIEW)stalled, stalledMs);
+			lock.lock();
+			continue;
+		}
+
+		if (earliest)
+		{
+			_cv.wait_for(lock, std::chrono::microseconds(earliest - now));
+		}
+		else
+		{
+			_cv.wait(lock);
+		}
+	}
+}
+
+#ifdef _WIN32
+// Thread timers don't carry any context, each view's message loop runs on a thread of its own
+static thread_local GINAVIEW t_beatView = GV_NONE;
+
+ginaWatchdogBeat::ginaWatchdogBeat(GINAVIEW view)
+	: _previous(t_beatView)
+{
+	t_beatView = view;
+	_timer = SetTimer(NULL, 0, ginaWatchdog::Get()->GetBeatMs(), TimerProc);
+}
+
+ginaWatchdogBeat::~ginaWatchdogBeat()
+{
+	if (_timer)
+	{
+		KillTimer(NULL, _timer);
+	}
+	t_beatView = _previous;
+}
+
+void CALLBACK ginaWatchdogBeat::TimerProc(HWND hWnd, UINT message, UINT_PTR idEvent, DWORD time)
+{
+	if (t_beatView != GV_NONE)
+	{
+		ginaWatchdog::Get()->Beat(t_beatView);
+	}
+}
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include "gina_viewstate.h"
+
+#define WATCHDOG_HISTOGRAM_BUCKETS 16
+// Message loops beat a few times per timeout, so a loop that misses a beat or two isn't stalled yet
+#define WATCHDOG_BEATS_PER_TIMEOUT 3
+#define WATCHDOG_BEAT_MS 1000
+// Timers don't get much finer than this, shorter timeouts are raised to fit WATCHDOG_BEATS_PER_TIMEOUT of them
+#define WATCHDOG_MIN_BEAT_MS 50
+
+// Replaces polling for dialog windows with deadlines
+// A view that is coming up, or the lack of any view, arms a deadline; the view being shown disarms it
+// Once a view is shown its message loop beats instead, which pushes the deadline forward
+// The watchdog thread sleeps until the earliest deadline, so nothing runs while the UI is healthy
+class ginaWatchdog
+{
+public:
+	static ginaWatchdog* Get();
+
+	// Starts the watchdog thread, pfnStall is called on it once a deadline passes
+	// A timeout of 0 disables the watchdog
+	void Start(unsigned int timeoutMs, void (*pfnStall)(GINAVIEW view, uint64_t stalledMs));
+
+	// How often message loops beat for a timeout, and the timeout actually used for it
+	static unsigned int GetBeatMs(unsigned int timeoutMs);
+	static unsigned int GetEffectiveTimeoutMs(unsigned int timeoutMs);
+	// For the running watchdog, WATCHDOG_BEAT_MS before it's started
+	unsigned int GetBeatMs();
+
+	void Arm(GINAVIEW view);
+	void Beat(GINAVIEW view);
+	void Disarm(GINAVIEW view);
+
+	// Bucket n counts the gaps in progress that took [2^(n-1), 2^n) ms, bucket 0 the ones under 1 ms
+	void GetHistogram(uint64_t (&buckets)[WATCHDOG_HISTOGRAM_BUCKETS]);
+
+private:
+	ginaWatchdog();
+	void Run();
+	void Record(int64_t elapsedUs);
+
+	std::atomic<bool> _started;
+	int64_t _timeoutUs;
+	std::atomic<unsigned int> _beatMs;
+	void (*_pfnStall)(GINAVIEW view, uint64_t stalledMs);
+
+	// GV_NONE is armed while no view is up at all
+	std::atomic<int64_t> _deadlineUs[GV_COUNT];
+	std::atomic<int64_t> _sinceUs[GV_COUNT];
+	std::atomic<uint64_t> _histogram[WATCHDOG_HISTOGRAM_BUCKETS];
+
+	std::mutex _mutex;
+	std::condition_variable _cv;
+};
+
+#ifdef _WIN32
+#include <windows.h>
+
+// Beats for a view from whatever message loop runs on the calling thread, modal ones like MessageBoxW's included
+// Put one at the top of a view's message loop, the timer goes away with it
+class ginaWatchdogBeat
+{
+public:
+	explicit ginaWatchdogBeat(GINAVIEW view);
+	~ginaWatchdogBeat();
+
+private:
+	static void CALLBACK TimerProc(HWND hWnd, UINT message, UINT_PTR idEvent, DWORD time);
+
+	UINT_PTR _timer;
+	GINAVIEW _previous;
+};
+#endif
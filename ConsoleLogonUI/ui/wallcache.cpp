@@ -0,0 +1,194 @@
+#pragma once
+#include "wallcache.h"
+#include "util/util.h"
+#include <shlobj.h>
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+#define WPCACHE_MAGIC 'CPWC'
+#define WPCACHE_VERSION 3
+// Pixel data has to start at a DWORD aligned offset for CreateDIBSection, a page keeps the mapping aligned as well
+#define WPCACHE_DATA_OFFSET 4096
+#define WPCACHE_MAX_ENTRIES 4
+
+struct wallpaperCacheHeader
+{
+	DWORD magic;
+	DWORD version;
+	wallpaperKey key;
+};
+
+static bool GetCacheDir(LPWSTR lpDir, DWORD cchDir)
+{
+	// LogonUI runs as SYSTEM, this ends up in the system profile
+	WCHAR szAppData[MAX_PATH];
+	if (FAILED(SHGetFolderPathW(NULL, CSIDL_LOCAL_APPDATA, NULL, SHGFP_TYPE_CURRENT, szAppData)))
+		return false;
+	swprintf_s(lpDir, cchDir, L"%s\\CLH_GINA\\WallpaperCache", szAppData);
+	return true;
+}
+
+static bool GetCachePath(const wallpaperKey* pKey, LPWSTR lpPath, DWORD cchPath)
+{
+	WCHAR szDir[MAX_PATH];
+	if (!GetCacheDir(szDir, MAX_PATH))
+		return false;
+
+	// FNV-1a over the whole key, the header is compared as well so collisions only cost a miss
+	unsigned long long hash = 14695981039346656037ULL;
+	const BYTE* p = (const BYTE*)pKey;
+	for (size_t i = 0; i < sizeof(wallpaperKey); i++)
+	{
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	swprintf_s(lpPath, cchPath, L"%s\\wp_%016llx.bin", szDir, hash);
+	return true;
+}
+
+bool GetWallpaperKey(LPCWSTR lpPath, int style, int width, int height, const wallpaperMonitor* monitors, int count, COLORREF bgColor, wallpaperKey* pKey)
+{
+	WIN32_FILE_ATTRIBUTE_DATA fad;
+	if (!GetFileAttributesExW(lpPath, GetFileExInfoStandard, &fad))
+		return false;
+
+	// Zeroed so the padding hashes the same every time
+	ZeroMemory(pKey, sizeof(wallpaperKey));
+	wcscpy_s(pKey->path, lpPath);
+	pKey->mtime = ((ULONGLONG)fad.ftLastWriteTime.dwHighDateTime << 32) | fad.ftLastWriteTime.dwLowDateTime;
+	pKey->size = ((ULONGLONG)fad.nFileSizeHigh << 32) | fad.nFileSizeLow;
+	pKey->style = style;
+	pKey->width = width;
+	pKey->height = height;
+	pKey->bgColor = bgColor;
+
+	unsigned long long hash = 14695981039346656037ULL;
+	const BYTE* p = (const BYTE*)monitors;
+	for (size_t i = 0; i < count * sizeof(wallpaperMonitor); i++)
+	{
+		hash ^= p[i];
+		hash *= 1099511628211ULL;
+	}
+	pKey->monitorHash = hash;
+	return true;
+}
+
+HBITMAP LoadCachedWallpaper(const wallpaperKey* pKey)
+{
+	WCHAR szPath[MAX_PATH];
+	if (!GetCachePath(pKey, szPath, MAX_PATH))
+		return NULL;
+
+	HANDLE hFile = CreateFileW(szPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return NULL;
+
+	ULONGLONG cbPixels = (ULONGLONG)pKey->width * pKey->height * 4;
+	LARGE_INTEGER fileSize;
+	wallpaperCacheHeader header;
+	DWORD cbRead = 0;
+	if (!GetFileSizeEx(hFile, &fileSize)
+		|| (ULONGLONG)fileSize.QuadPart != WPCACHE_DATA_OFFSET + cbPixels
+		|| !ReadFile(hFile, &header, sizeof(header), &cbRead, NULL)
+		|| cbRead != sizeof(header)
+		|| header.magic != WPCACHE_MAGIC
+		|| header.version != WPCACHE_VERSION
+		|| memcmp(&header.key, pKey, sizeof(wallpaperKey)))
+	{
+		CloseHandle(hFile);
+		return NULL;
+	}
+
+	// Nothing here may write to the cache file, so the mapping is read only
+	// GDI maps a DIB section's own section writable, the pixels are copied out of the view instead
+	HANDLE hSection = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(hFile);
+	if (!hSection)
+		return NULL;
+
+	const BYTE* pView = (const BYTE*)MapViewOfFile(hSection, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(hSection);
+	if (!pView)
+		return NULL;
+
+	BITMAPINFO bmi = { 0 };
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = pKey->width;
+	bmi.bmiHeader.biHeight = -pKey->height;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	void* pvBits;
+	HBITMAP hbm = CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, &pvBits, NULL, 0);
+	if (hbm)
+		memcpy(pvBits, pView + WPCACHE_DATA_OFFSET, (size_t)cbPixels);
+	UnmapViewOfFile(pView);
+	return hbm;
+}
+
+void SaveCachedWallpaper(const wallpaperKey* pKey, HBITMAP hbm)
+{
+	DIBSECTION ds;
+	if (!GetObjectW(hbm, sizeof(ds), &ds) || !ds.dsBm.bmBits
+		|| ds.dsBm.bmWidth != pKey->width || ds.dsBm.bmHeight != pKey->height || ds.dsBm.bmBitsPixel != 32)
+		return;
+
+	WCHAR szDir[MAX_PATH], szPath[MAX_PATH];
+	if (!GetCacheDir(szDir, MAX_PATH) || !GetCachePath(pKey, szPath, MAX_PATH))
+		return;
+	SHCreateDirectoryExW(NULL, szDir, NULL);
+
+	// Write under a temporary name so a crash never leaves a half written entry behind
+	WCHAR szTempPath[MAX_PATH];
+	swprintf_s(szTempPath, L"%s.tmp", szPath);
+	HANDLE hFile = CreateFileW(szTempPath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return;
+
+	BYTE header[WPCACHE_DATA_OFFSET] = { 0 };
+	wallpaperCacheHeader* pHeader = (wallpaperCacheHeader*)header;
+	pHeader->magic = WPCACHE_MAGIC;
+	pHeader->version = WPCACHE_VERSION;
+	pHeader->key = *pKey;
+
+	DWORD cbPixels = (DWORD)pKey->width * pKey->height * 4;
+	DWORD cbWritten;
+	bool fOk = WriteFile(hFile, header, sizeof(header), &cbWritten, NULL) && cbWritten == sizeof(header)
+		&& WriteFile(hFile, ds.dsBm.bmBits, cbPixels, &cbWritten, NULL) && cbWritten == cbPixels;
+	CloseHandle(hFile);
+
+	if (!fOk || !MoveFileExW(szTempPath, szPath, MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFileW(szTempPath);
+		return;
+	}
+
+	// Keep the most recent entries only (e.g. the system and the last user's wallpaper).
+	// This runs on the logon path, so every filesystem call goes through the
+	// non-throwing overloads and an entry that can't be read is left alone.
+	std::error_code ec;
+	std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries;
+	std::filesystem::directory_iterator it(szDir, ec), end;
+	for (; !ec && it != end; it.increment(ec))
+	{
+		if (it->path().extension() != L".bin")
+			continue;
+
+		std::error_code ecTime;
+		std::filesystem::file_time_type time = it->last_write_time(ecTime);
+		if (!ecTime)
+			entries.emplace_back(time, it->path());
+	}
+	if (entries.size() > WPCACHE_MAX_ENTRIES)
+	{
+		std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+			return a.first > b.first;
+		});
+		for (size_t i = WPCACHE_MAX_ENTRIES; i < entries.size(); i++)
+		{
+			std::filesystem::remove(entries[i].second, ec);
+		}
+	}
+}
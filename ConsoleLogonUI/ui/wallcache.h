@@ -0,0 +1,24 @@
+#pragma once
+#include <windows.h>
+#include "wallcompose.h"
+
+// On-disk cache of the final wallpaper frame covering the virtual screen
+// Entries are raw 32bpp top-down pixels behind a page sized header, so a hit is a single copy out of a read only mapping
+
+struct wallpaperKey
+{
+	WCHAR path[MAX_PATH];
+	ULONGLONG mtime;
+	ULONGLONG size;
+	int style;
+	int width;
+	int height;
+	ULONGLONG monitorHash; // Of the monitor rectangles inside the frame
+	COLORREF bgColor;
+};
+
+bool GetWallpaperKey(LPCWSTR lpPath, int style, int width, int height, const wallpaperMonitor* monitors, int count, COLORREF bgColor, wallpaperKey* pKey);
+// Returns NULL on a miss
+HBITMAP LoadCachedWallpaper(const wallpaperKey* pKey);
+// hbm has to be a 32bpp top-down DIB section of the key's size
+void SaveCachedWallpaper(const wallpaperKey* pKey, HBITMAP hbm);
@@ -0,0 +1,214 @@
+#pragma once
+#include "wallcompose.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+bool GetWallpaperLayout(int style, int screenWidth, int screenHeight, int imageWidth, int imageHeight, wallpaperLayout* pLayout)
+{
+	if (screenWidth <= 0 || screenHeight <= 0 || imageWidth <= 0 || imageHeight <= 0)
+		return false;
+
+	int newWidth = imageWidth;
+	int newHeight = imageHeight;
+	double ratio = (double)imageWidth / imageHeight;
+	switch (style)
+	{
+	case WP_STYLE_TILE:
+		pLayout->x = 0;
+		pLayout->y = 0;
+		pLayout->width = imageWidth;
+		pLayout->height = imageHeight;
+		pLayout->fTile = true;
+		return true;
+	case WP_STYLE_STRETCH:
+		newWidth = screenWidth;
+		newHeight = screenHeight;
+		break;
+	case WP_STYLE_FIT:
+		if (imageWidth > screenWidth || imageHeight > screenHeight)
+		{
+			newWidth = screenWidth;
+			newHeight = (int)(screenWidth / ratio);
+			if (newHeight > screenHeight)
+			{
+				newHeight = screenHeight;
+				newWidth = (int)(screenHeight * ratio);
+			}
+		}
+		break;
+	case WP_STYLE_FILL:
+	case WP_STYLE_SPAN:
+		newWidth = screenWidth;
+		newHeight = (int)(screenWidth / ratio);
+		if (newHeight < screenHeight)
+		{
+			newHeight = screenHeight;
+			newWidth = (int)(screenHeight * ratio);
+		}
+		break;
+	}
+
+	pLayout->x = (screenWidth - newWidth) / 2;
+	pLayout->y = (screenHeight - newHeight) / 2;
+	if (style == WP_STYLE_FILL)
+	{
+		pLayout->y = (screenHeight - newHeight) / 3; // idk why but Windows does this
+	}
+	pLayout->width = std::max(newWidth, 1);
+	pLayout->height = std::max(newHeight, 1);
+	pLayout->fTile = false;
+	return true;
+}
+
+static void FillFrame(const imageView& frame, uint32_t bgColor)
+{
+	uint8_t* row = frame.pixels;
+	for (int x = 0; x < frame.width; x++)
+	{
+		memcpy(row + x * 4, &bgColor, 4);
+	}
+	for (int y = 1; y < frame.height; y++)
+	{
+		memcpy(frame.pixels + (size_t)y * frame.stride, row, (size_t)frame.width * 4);
+	}
+}
+
+// Unscaled copy of image to (x, y), clipped to the frame
+static void CopyImage(const imageView& image, const imageView& frame, int x, int y)
+{
+	int left = std::max(x, 0);
+	int top = std::max(y, 0);
+	int right = std::min(x + image.width, frame.width);
+	int bottom = std::min(y + image.height, frame.height);
+	if (right <= left || bottom <= top)
+		return;
+
+	for (int row = top; row < bottom; row++)
+	{
+		memcpy(frame.pixels + (size_t)row * frame.stride + left * 4,
+			image.pixels + (size_t)(row - y) * image.stride + (left - x) * 4,
+			(size_t)(right - left) * 4);
+	}
+}
+
+static void TileImage(const imageView& image, const imageView& frame)
+{
+	// Build the first band of tiles, then repeat it down the frame
+	int band = std::min(image.height, frame.height);
+	for (int y = 0; y < band; y++)
+	{
+		uint8_t* dst = frame.pixels + (size_t)y * frame.stride;
+		const uint8_t* src = image.pixels + (size_t)y * image.stride;
+		for (int x = 0; x < frame.width; x += image.width)
+		{
+			memcpy(dst + x * 4, src, (size_t)std::min(image.width, frame.width - x) * 4);
+		}
+	}
+	for (int y = band; y < frame.height; y++)
+	{
+		memcpy(frame.pixels + (size_t)y * frame.stride, frame.pixels + (size_t)(y % band) * frame.stride, (size_t)frame.width * 4);
+	}
+}
+
+bool GetMonitorWallpaperLayout(int style, int frameWidth, int frameHeight, const wallpaperMonitor& monitor, int imageWidth, int imageHeight, wallpaperLayout* pLayout)
+{
+	if (style == WP_STYLE_SPAN)
+	{
+		// One image across the bounding box of all monitors, each shows its part of it
+		return GetWallpaperLayout(style, frameWidth, frameHeight, imageWidth, imageHeight, pLayout);
+	}
+
+	if (!GetWallpaperLayout(style, monitor.width, monitor.height, imageWidth, imageHeight, pLayout))
+		return false;
+	pLayout->x += monitor.x;
+	pLayout->y += monitor.y;
+	return true;
+}
+
+// Draws the image at layout, which is relative to frame
+static void DrawLayout(const imageView& image, const imageView& frame, const wallpaperLayout& layout, uint32_t bgColor, int threads)
+{
+	if (layout.fTile)
+	{
+		TileImage(image, frame);
+		return;
+	}
+
+	// Only fill what the image won't cover
+	if (layout.x > 0 || layout.y > 0 || layout.x + layout.width < frame.width || layout.y + layout.height < frame.height)
+	{
+		FillFrame(frame, bgColor);
+	}
+
+	if (layout.width == image.width && layout.height == image.height)
+	{
+		CopyImage(image, frame, layout.x, layout.y);
+	}
+	else
+	{
+		RESAMPLE_FILTER filter = layout.width < image.width ? RF_LANCZOS3 : RF_BILINEAR;
+		Resample(image, frame, layout.x, layout.y, layout.width, layout.height, filter, threads);
+	}
+}
+
+void ComposeWallpaper(const imageView& image, const imageView& frame, int style, uint32_t bgColor, int threads)
+{
+	if (!frame.pixels || frame.width <= 0 || frame.height <= 0)
+		return;
+
+	wallpaperLayout layout;
+	if (!image.pixels || !GetWallpaperLayout(style, frame.width, frame.height, image.width, image.height, &layout))
+	{
+		FillFrame(frame, bgColor);
+		return;
+	}
+	DrawLayout(image, frame, layout, bgColor, threads);
+}
+
+static void ComposeMonitor(const imageView& image, const imageView& frame, int style, uint32_t bgColor, const wallpaperMonitor& monitor, int threads)
+{
+	// Clip the monitor to the frame, the view shares the frame's pixels
+	int left = std::max(monitor.x, 0);
+	int top = std::max(monitor.y, 0);
+	int right = std::min(monitor.x + monitor.width, frame.width);
+	int bottom = std::min(monitor.y + monitor.height, frame.height);
+	if (right <= left || bottom <= top)
+		return;
+	imageView view = { frame.pixels + (size_t)top * frame.stride + left * 4, right - left, bottom - top, frame.stride };
+
+	wallpaperLayout layout;
+	if (!image.pixels || !GetMonitorWallpaperLayout(style, frame.width, frame.height, monitor, image.width, image.height, &layout))
+	{
+		FillFrame(view, bgColor);
+		return;
+	}
+	layout.x -= left;
+	layout.y -= top;
+	DrawLayout(image, view, layout, bgColor, threads);
+}
+
+void ComposeWallpaperMonitors(const imageView& image, const imageView& frame, int style, uint32_t bgColor, const wallpaperMonitor* monitors, int count)
+{
+	if (!frame.pixels || frame.width <= 0 || frame.height <= 0 || count <= 0)
+		return;
+
+	if (count == 1)
+	{
+		ComposeMonitor(image, frame, style, bgColor, monitors[0], 0);
+		return;
+	}
+
+	// Monitors don't overlap, so they can be drawn side by side, split the cores between them
+	int threads = std::max(1, (int)std::thread::hardware_concurrency() / count);
+	std::vector<std::thread> workers;
+	for (int i = 0; i < count; i++)
+	{
+		workers.emplace_back(ComposeMonitor, std::cref(image), std::cref(frame), style, bgColor, std::cref(monitors[i]), threads);
+	}
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include "util/resample.h"
+
+// Lays out and composes the wallpaper into a 32bpp frame covering the virtual screen
+// Doesn't depend on Win32, wallHost hands it plain pixel buffers and monitor rectangles
+
+#define WP_STYLE_CENTER 0
+#define WP_STYLE_TILE 1
+#define WP_STYLE_STRETCH 2
+#define WP_STYLE_FIT 3
+#define WP_STYLE_FILL 4
+#define WP_STYLE_SPAN 5
+
+struct wallpaperLayout
+{
+	// Where the whole image ends up, may reach outside of the screen
+	int x;
+	int y;
+	int width;
+	int height;
+	bool fTile; // Repeat the image from (x, y) over the whole screen
+};
+
+struct wallpaperMonitor
+{
+	// Relative to the top left of the frame
+	int x;
+	int y;
+	int width;
+	int height;
+};
+
+// Returns false for an empty image or screen
+bool GetWallpaperLayout(int style, int screenWidth, int screenHeight, int imageWidth, int imageHeight, wallpaperLayout* pLayout);
+// Same, for one monitor of a frame, in frame coordinates
+// Span lays the image out over the whole frame, every other style per monitor
+bool GetMonitorWallpaperLayout(int style, int frameWidth, int frameHeight, const wallpaperMonitor& monitor, int imageWidth, int imageHeight, wallpaperLayout* pLayout);
+
+// Fills the frame with bgColor (0x00RRGGBB) and draws the image over it
+// threads is passed on to Resample
+void ComposeWallpaper(const imageView& image, const imageView& frame, int style, uint32_t bgColor, int threads = 0);
+// Composes every monitor of the frame in parallel, pixels outside of all monitors are left alone
+void ComposeWallpaperMonitors(const imageView& image, const imageView& frame, int style, uint32_t bgColor, const wallpaperMonitor* monitors, int count);
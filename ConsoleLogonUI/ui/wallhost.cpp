@@ -2,17 +2,43 @@
 #include <windows.h>
 #include <gdiplus.h>
 #include <shlobj.h>
+#include <wincodec.h>
+#include <psapi.h>
 #include "wallhost.h"
+#include "wallcache.h"
 #include "util/util.h"
 #include <thread>
 #include <atomic>
 #include <mutex>
 #include <filesystem>
+#include <vector>
 
+#pragma comment(lib, "windowscodecs.lib")
+
+// Rows per CopyPixels call when decoding straight into the frame
+#define WALLPAPER_DECODE_BAND 128
+
+// Final frame over the whole virtual screen, style already applied
 HBITMAP g_wpBitmap;
-int g_wpStyle = WP_STYLE_CENTER;
+// Persistent back buffer DC holding g_wpBitmap
+HDC g_hdcFrame = NULL;
+HBITMAP g_hbmFrameOld = NULL;
 HANDLE g_sWallHostProcess = NULL;
 
+#define WM_WALLPAPERREADY (WM_APP + 1) // wParam = generation, lParam = composed frame or NULL
+
+// Bumped for every load, results of older loads are thrown away
+std::atomic<unsigned> g_wpGeneration(0);
+std::mutex g_wpLoadMutex;
+// GDI+ stays up for the life of the process, GdiplusShutdown can't be called from DllMain
+ULONG_PTR g_gdiplusToken = 0;
+std::once_flag g_gdiplusOnce;
+
+// For the first paint and first wallpaper timings
+LARGE_INTEGER g_wpCreateTime;
+bool g_fFirstPaint = true;
+bool g_fFirstWallpaper = true;
+
 std::atomic<bool> isWallHostActive(false);
 std::mutex wallHostMutex;
 
@@ -53,7 +79,208 @@ wallHost* wallHost::Get()
 	return &dlg;
 }
 
-void LoadWallpaper()
+static bool StartGdiplus()
+{
+	std::call_once(g_gdiplusOnce, [] {
+		Gdiplus::GdiplusStartupInput gdiplusStartupInput;
+		if (Gdiplus::GdiplusStartup(&g_gdiplusToken, &gdiplusStartupInput, NULL) != Gdiplus::Ok)
+		{
+			g_gdiplusToken = 0;
+		}
+	});
+	return g_gdiplusToken != 0;
+}
+
+static double ElapsedMs(const LARGE_INTEGER& since)
+{
+	LARGE_INTEGER now, freq;
+	QueryPerformanceCounter(&now);
+	QueryPerformanceFrequency(&freq);
+	return (now.QuadPart - since.QuadPart) * 1000.0 / freq.QuadPart;
+}
+
+// Reads any bitmap as 32bpp top-down pixels for the compositor
+static bool GetBitmapPixels(HBITMAP hbm, std::vector<BYTE>& pixels, imageView* pView)
+{
+	BITMAP bm;
+	if (!GetObject(hbm, sizeof(bm), &bm) || bm.bmWidth <= 0 || bm.bmHeight <= 0)
+		return false;
+
+	BITMAPINFO bmi = { 0 };
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = bm.bmWidth;
+	bmi.bmiHeader.biHeight = -bm.bmHeight;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	pixels.resize((size_t)bm.bmWidth * bm.bmHeight * 4);
+	HDC hdcScreen = GetDC(NULL);
+	int lines = GetDIBits(hdcScreen, hbm, 0, bm.bmHeight, pixels.data(), &bmi, DIB_RGB_COLORS);
+	ReleaseDC(NULL, hdcScreen);
+	if (!lines)
+		return false;
+
+	*pView = { pixels.data(), bm.bmWidth, bm.bmHeight, bm.bmWidth * 4 };
+	return true;
+}
+
+// The frame stays selected into the back buffer DC so paints are a bare blit
+static void SetWallpaperFrame(HBITMAP hbm)
+{
+	if (g_hdcFrame)
+	{
+		SelectObject(g_hdcFrame, g_hbmFrameOld);
+		DeleteDC(g_hdcFrame);
+		g_hdcFrame = NULL;
+		g_hbmFrameOld = NULL;
+	}
+
+	HBITMAP hbmOld = g_wpBitmap;
+	g_wpBitmap = hbm;
+	if (hbmOld)
+	{
+		DeleteObject(hbmOld);
+	}
+
+	if (hbm)
+	{
+		g_hdcFrame = CreateCompatibleDC(NULL);
+		g_hbmFrameOld = (HBITMAP)SelectObject(g_hdcFrame, hbm);
+	}
+}
+
+// Decodes the image through WIC straight into the frame
+// When the style shrinks the image, WIC scales while decoding (JPEG does it in the DCT),
+// so only the output size ever sits in memory instead of the full image
+static bool DecodeWallpaper(LPCWSTR lpPath, int style, const imageView& frame, const std::vector<wallpaperMonitor>& monitors, uint32_t bgColor)
+{
+	IWICImagingFactory* pFactory = NULL;
+	IWICBitmapDecoder* pDecoder = NULL;
+	IWICBitmapFrameDecode* pSource = NULL;
+	IWICBitmapScaler* pScaler = NULL;
+	IWICFormatConverter* pConverter = NULL;
+	bool fResult = false;
+
+	UINT width, height;
+	wallpaperLayout layout;
+	HRESULT hr = CoCreateInstance(CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&pFactory));
+	if (SUCCEEDED(hr))
+		hr = pFactory->CreateDecoderFromFilename(lpPath, NULL, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &pDecoder);
+	if (SUCCEEDED(hr))
+		hr = pDecoder->GetFrame(0, &pSource);
+	if (SUCCEEDED(hr))
+		hr = pSource->GetSize(&width, &height);
+	if (SUCCEEDED(hr) && (monitors.empty() || !GetMonitorWallpaperLayout(style, frame.width, frame.height, monitors[0], width, height, &layout)))
+		hr = E_FAIL;
+	if (FAILED(hr))
+		goto cleanup;
+
+	{
+		// Size to decode at, the largest any monitor needs but never more than the image
+		int decodeWidth = layout.width;
+		int decodeHeight = layout.height;
+		for (const wallpaperMonitor& monitor : monitors)
+		{
+			wallpaperLayout monitorLayout;
+			GetMonitorWallpaperLayout(style, frame.width, frame.height, monitor, width, height, &monitorLayout);
+			decodeWidth = max(decodeWidth, monitorLayout.width);
+			decodeHeight = max(decodeHeight, monitorLayout.height);
+		}
+		decodeWidth = min(decodeWidth, (int)width);
+		decodeHeight = min(decodeHeight, (int)height);
+
+		// With a single layout (one monitor or span), the scaled image goes straight into the frame
+		// Tiles, enlarged images and differently sized monitors decode into a buffer the compositor places
+		bool fStream = (monitors.size() == 1 || style == WP_STYLE_SPAN)
+			&& !layout.fTile && layout.width == decodeWidth && layout.height == decodeHeight;
+		IWICBitmapSource* pInput = pSource;
+		if (decodeWidth < (int)width || decodeHeight < (int)height)
+		{
+			hr = pFactory->CreateBitmapScaler(&pScaler);
+			if (SUCCEEDED(hr))
+				hr = pScaler->Initialize(pSource, decodeWidth, decodeHeight, WICBitmapInterpolationModeFant);
+			pInput = pScaler;
+		}
+		if (SUCCEEDED(hr))
+			hr = pFactory->CreateFormatConverter(&pConverter);
+		if (SUCCEEDED(hr))
+			hr = pConverter->Initialize(pInput, GUID_WICPixelFormat32bppBGRA, WICBitmapDitherTypeNone, NULL, 0.0, WICBitmapPaletteTypeCustom);
+		if (FAILED(hr))
+			goto cleanup;
+
+		if (!fStream)
+		{
+			std::vector<BYTE> pixels((size_t)decodeWidth * decodeHeight * 4);
+			hr = pConverter->CopyPixels(NULL, decodeWidth * 4, (UINT)pixels.size(), pixels.data());
+			if (SUCCEEDED(hr))
+			{
+				imageView image = { pixels.data(), decodeWidth, decodeHeight, decodeWidth * 4 };
+				ComposeWallpaperMonitors(image, frame, style, bgColor, monitors.data(), (int)monitors.size());
+				fResult = true;
+			}
+			goto cleanup;
+		}
+
+		// Background first, then only the visible part of the scaled image, a band at a time
+		ComposeWallpaperMonitors({ 0 }, frame, style, bgColor, monitors.data(), (int)monitors.size());
+		int left = max(layout.x, 0);
+		int top = max(layout.y, 0);
+		int right = min(layout.x + layout.width, frame.width);
+		int bottom = min(layout.y + layout.height, frame.height);
+		for (int y = top; y < bottom && SUCCEEDED(hr); y += WALLPAPER_DECODE_BAND)
+		{
+			int rows = min(WALLPAPER_DECODE_BAND, bottom - y);
+			WICRect rc = { left - layout.x, y - layout.y, right - left, rows };
+			hr = pConverter->CopyPixels(&rc, frame.stride, frame.stride * rows, frame.pixels + (size_t)y * frame.stride + left * 4);
+		}
+		fResult = SUCCEEDED(hr);
+	}
+
+cleanup:
+	if (pConverter)
+		pConverter->Release();
+	if (pScaler)
+		pScaler->Release();
+	if (pSource)
+		pSource->Release();
+	if (pDecoder)
+		pDecoder->Release();
+	if (pFactory)
+		pFactory->Release();
+	return fResult;
+}
+
+static BOOL CALLBACK AddMonitorProc(HMONITOR hMonitor, HDC hdc, LPRECT lprcMonitor, LPARAM lParam)
+{
+	std::vector<RECT>* rects = (std::vector<RECT>*)lParam;
+	rects->push_back(*lprcMonitor);
+	return TRUE;
+}
+
+// Monitors relative to the top left of the virtual screen, which is what the frame covers
+static void GetWallpaperMonitors(RECT* prcVirtual, std::vector<wallpaperMonitor>& monitors)
+{
+	prcVirtual->left = GetSystemMetrics(SM_XVIRTUALSCREEN);
+	prcVirtual->top = GetSystemMetrics(SM_YVIRTUALSCREEN);
+	prcVirtual->right = prcVirtual->left + GetSystemMetrics(SM_CXVIRTUALSCREEN);
+	prcVirtual->bottom = prcVirtual->top + GetSystemMetrics(SM_CYVIRTUALSCREEN);
+
+	std::vector<RECT> rects;
+	EnumDisplayMonitors(NULL, NULL, AddMonitorProc, (LPARAM)&rects);
+	monitors.clear();
+	for (const RECT& rc : rects)
+	{
+		monitors.push_back({ rc.left - prcVirtual->left, rc.top - prcVirtual->top, rc.right - rc.left, rc.bottom - rc.top });
+	}
+	if (monitors.empty())
+	{
+		monitors.push_back({ 0, 0, prcVirtual->right - prcVirtual->left, prcVirtual->bottom - prcVirtual->top });
+	}
+}
+
+// Runs on the loader thread, returns the composed frame or NULL for no wallpaper
+static HBITMAP BuildWallpaperFrame()
 {
 	// Note: IDesktopWallpaper from shobjidl_core.h doesn't work on pre-logon sessions (CoCreateInstance fails with class not registered)
 
@@ -61,8 +288,9 @@ void LoadWallpaper()
 	wchar_t wallpaperPath[MAX_PATH] = { 0 };
 	BOOL tileWallpaper = FALSE;
 	int wallpaperStyle = 0;
+	int style = WP_STYLE_CENTER;
 
-	HKEY hive;
+	HKEY hive = NULL;
 	GetUserRegHive(KEY_READ, &hive);
 	if (hive) {
 		HKEY hKey;
@@ -73,8 +301,7 @@ void LoadWallpaper()
 			if (wallpaperPath[0] == NULL || !std::filesystem::exists(wallpaperPath)) {
 				RegCloseKey(hKey);
 				RegCloseKey(hive);
-				g_wpBitmap = NULL;
-				return;
+				return NULL;
 			}
 
 			cbData = sizeof(wchar_t) * 2;
@@ -93,74 +320,160 @@ void LoadWallpaper()
 	}
 
 	if (wallpaperPath[0] == NULL || !std::filesystem::exists(wallpaperPath)) {
-		g_wpBitmap = NULL;
-		return;
+		return NULL;
 	}
 
 	if (tileWallpaper) {
-		g_wpStyle = WP_STYLE_TILE;
+		style = WP_STYLE_TILE;
 	}
 	else {
 		switch (wallpaperStyle) {
 		case 0:
-			g_wpStyle = WP_STYLE_CENTER;
+			style = WP_STYLE_CENTER;
 			break;
 		case 2:
-			g_wpStyle = WP_STYLE_STRETCH;
+			style = WP_STYLE_STRETCH;
 			break;
 		case 6:
-			g_wpStyle = WP_STYLE_FIT;
+			style = WP_STYLE_FIT;
 			break;
 		case 10:
-			g_wpStyle = WP_STYLE_FILL;
+			style = WP_STYLE_FILL;
 			break;
 		case 22:
-			g_wpStyle = WP_STYLE_SPAN;
+			style = WP_STYLE_SPAN;
 			break;
 		}
 	}
 
-	// Try loading as BMP first
-	g_wpBitmap = (HBITMAP)LoadImageW(NULL, wallpaperPath, IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE);
-	if (g_wpBitmap) {
-		return;
+	RECT rcVirtual;
+	std::vector<wallpaperMonitor> monitors;
+	GetWallpaperMonitors(&rcVirtual, monitors);
+	int width = rcVirtual.right - rcVirtual.left;
+	int height = rcVirtual.bottom - rcVirtual.top;
+	COLORREF bgColor = GetSysColor(COLOR_BACKGROUND);
+	wallpaperKey key;
+	bool fKey = GetWallpaperKey(wallpaperPath, style, width, height, monitors.data(), (int)monitors.size(), bgColor, &key);
+	if (fKey)
+	{
+		HBITMAP hbmCached = LoadCachedWallpaper(&key);
+		if (hbmCached)
+		{
+			return hbmCached;
+		}
+	}
+
+	// Compose the final frame once, painting is a single blit from here on
+	BITMAPINFO bmi = { 0 };
+	bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth = width;
+	bmi.bmiHeader.biHeight = -height;
+	bmi.bmiHeader.biPlanes = 1;
+	bmi.bmiHeader.biBitCount = 32;
+	bmi.bmiHeader.biCompression = BI_RGB;
+
+	void* pvBits;
+	HBITMAP hbmFrame = CreateDIBSection(NULL, &bmi, DIB_RGB_COLORS, &pvBits, NULL, 0);
+	if (!hbmFrame)
+	{
+		return NULL;
 	}
 
-	// Initialize GDI+
-	Gdiplus::GdiplusStartupInput gdiplusStartupInput;
-	ULONG_PTR gdiplusToken;
-	Gdiplus::GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, NULL);
+	imageView frame = { (uint8_t*)pvBits, width, height, width * 4 };
+	uint32_t frameBgColor = (GetRValue(bgColor) << 16) | (GetGValue(bgColor) << 8) | GetBValue(bgColor);
+	if (!DecodeWallpaper(wallpaperPath, style, frame, monitors, frameBgColor))
+	{
+		// Formats WIC has no codec for, these decode at full size
+		// Try loading as BMP first
+		HBITMAP hbmSource = (HBITMAP)LoadImageW(NULL, wallpaperPath, IMAGE_BITMAP, 0, 0, LR_LOADFROMFILE);
+		if (!hbmSource && StartGdiplus())
+		{
+			// Load the image
+			Gdiplus::Bitmap* bitmap = Gdiplus::Bitmap::FromFile(wallpaperPath);
+			if (bitmap && bitmap->GetLastStatus() == Gdiplus::Ok)
+			{
+				bitmap->GetHBITMAP(NULL, &hbmSource);
+			}
+
+			// Cleanup
+			delete bitmap;
+		}
+		if (!hbmSource)
+		{
+			DeleteObject(hbmFrame);
+			return NULL;
+		}
+
+		std::vector<BYTE> pixels;
+		imageView image = { 0 };
+		GetBitmapPixels(hbmSource, pixels, &image);
+		// The source can be far bigger than the screen, don't keep it around
+		DeleteObject(hbmSource);
+
+		ComposeWallpaperMonitors(image, frame, style, frameBgColor, monitors.data(), (int)monitors.size());
+	}
 
-	// Load the image
-	Gdiplus::Bitmap* bitmap = Gdiplus::Bitmap::FromFile(wallpaperPath);
-	if (bitmap && bitmap->GetLastStatus() == Gdiplus::Ok)
+	if (fKey)
 	{
-		bitmap->GetHBITMAP(NULL, &g_wpBitmap);
+		SaveCachedWallpaper(&key, hbmFrame);
 	}
+	return hbmFrame;
+}
+
+// Decodes and composes on a worker, the window keeps showing what it has until WM_WALLPAPERREADY swaps the frame in
+static void LoadWallpaper(HWND hWnd)
+{
+	unsigned generation = ++g_wpGeneration;
+	std::thread([=] {
+		HBITMAP hbmFrame;
+		LARGE_INTEGER start;
+		QueryPerformanceCounter(&start);
+		{
+			// One load at a time, and skip this one if it got superseded while waiting
+			std::lock_guard<std::mutex> lock(g_wpLoadMutex);
+			if (generation != g_wpGeneration)
+			{
+				return;
+			}
+			HRESULT hrCo = CoInitializeEx(NULL, COINIT_MULTITHREADED);
+			hbmFrame = BuildWallpaperFrame();
+			if (SUCCEEDED(hrCo))
+			{
+				CoUninitialize();
+			}
+		}
 
-	// Cleanup
-	delete bitmap;
-	Gdiplus::GdiplusShutdown(gdiplusToken);
+		PROCESS_MEMORY_COUNTERS pmc = { sizeof(pmc) };
+		GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
+		dbgprintf(L"CLH_GINA: wallpaper built in %.1f ms, peak working set %llu KB", ElapsedMs(start), (unsigned long long)(pmc.PeakWorkingSetSize / 1024));
+
+		if (!PostMessageW(hWnd, WM_WALLPAPERREADY, generation, (LPARAM)hbmFrame) && hbmFrame)
+		{
+			DeleteObject(hbmFrame);
+		}
+	}).detach();
 }
 
 void wallHost::Create()
 {
 	HINSTANCE hInstance = ginaManager::Get()->hInstance;
-	RECT screenRect;
-	screenRect.left = 0;
-	screenRect.top = 0;
-	screenRect.right = GetSystemMetrics(SM_CXSCREEN);
-	screenRect.bottom = GetSystemMetrics(SM_CYSCREEN);
+	QueryPerformanceCounter(&g_wpCreateTime);
+	// One window over the whole virtual screen, the frame has a part for every monitor
+	int x = GetSystemMetrics(SM_XVIRTUALSCREEN);
+	int y = GetSystemMetrics(SM_YVIRTUALSCREEN);
+	int cx = GetSystemMetrics(SM_CXVIRTUALSCREEN);
+	int cy = GetSystemMetrics(SM_CYVIRTUALSCREEN);
 
 	WNDCLASS wc = { 0 };
 	wc.lpfnWndProc = wallHost::WndProc;
 	wc.hInstance = hInstance;
 	wc.lpszClassName = L"ClhGinaWallHost";
 	RegisterClass(&wc);
-	wallHost::Get()->hWnd = CreateWindowExW(WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE, L"ClhGinaWallHost", L"CLH_GINA Wallpaper Host", WS_POPUP | WS_VISIBLE, 0, 0, screenRect.right, screenRect.bottom, 0, 0, hInstance, 0);
+	wallHost::Get()->hWnd = CreateWindowExW(WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE, L"ClhGinaWallHost", L"CLH_GINA Wallpaper Host", WS_POPUP | WS_VISIBLE, x, y, cx, cy, 0, 0, hInstance, 0);
 	SetWindowPos(wallHost::Get()->hWnd, HWND_BOTTOM, 0, 0, 0, 0, SWP_NOMOVE | SWP_NOSIZE | SWP_NOACTIVATE);
 
-	LoadWallpaper();
+	// Show() paints the background color right away, the wallpaper follows when it's ready
+	LoadWallpaper(wallHost::Get()->hWnd);
 }
 
 void wallHost::Destroy()
@@ -175,10 +488,7 @@ void wallHost::Destroy()
 	{
 		DestroyWindow(dlg->hWnd);
 	}
-	if (g_wpBitmap)
-	{
-		DeleteObject(g_wpBitmap);
-	}
+	SetWallpaperFrame(NULL);
 }
 
 void wallHost::Show()
@@ -216,136 +526,58 @@ LRESULT CALLBACK wallHost::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARA
 	}
 	case WM_PAINT:
 	{
-		if (g_wpBitmap == NULL)
-		{
-			break;
-		}
 		PAINTSTRUCT ps;
 		HDC hdc = BeginPaint(hWnd, &ps);
-		RECT rect;
-		GetClientRect(hWnd, &rect);
-		HDC hdcMem = CreateCompatibleDC(hdc);
-		HBITMAP hbmOld = (HBITMAP)SelectObject(hdcMem, g_wpBitmap);
-		BITMAP bm;
-		GetObject(g_wpBitmap, sizeof(bm), &bm);
-		SetStretchBltMode(hdc, HALFTONE);
-		SetBrushOrgEx(hdc, 0, 0, NULL);
-		switch (g_wpStyle)
-		{
-		case WP_STYLE_CENTER:
-		{
-			int x = (rect.right - bm.bmWidth) / 2;
-			int y = (rect.bottom - bm.bmHeight) / 2;
-			BitBlt(hdc, x, y, bm.bmWidth, bm.bmHeight, hdcMem, 0, 0, SRCCOPY);
-			break;
-		}
-		case WP_STYLE_TILE:
+		if (g_hdcFrame)
 		{
-			for (int x = 0; x < rect.right; x += bm.bmWidth)
-			{
-				for (int y = 0; y < rect.bottom; y += bm.bmHeight)
-				{
-					BitBlt(hdc, x, y, bm.bmWidth, bm.bmHeight, hdcMem, 0, 0, SRCCOPY);
-				}
-			}
-			break;
+			// Only what got invalidated, the frame is already composed
+			BitBlt(hdc, ps.rcPaint.left, ps.rcPaint.top, ps.rcPaint.right - ps.rcPaint.left, ps.rcPaint.bottom - ps.rcPaint.top,
+				g_hdcFrame, ps.rcPaint.left, ps.rcPaint.top, SRCCOPY);
 		}
-		case WP_STYLE_STRETCH:
+		EndPaint(hWnd, &ps);
+		if (g_fFirstPaint)
 		{
-			StretchBlt(hdc, 0, 0, rect.right, rect.bottom, hdcMem, 0, 0, bm.bmWidth, bm.bmHeight, SRCCOPY);
-			break;
+			g_fFirstPaint = false;
+			dbgprintf(L"CLH_GINA: wallpaper host first paint after %.1f ms", ElapsedMs(g_wpCreateTime));
 		}
-		case WP_STYLE_FIT:
+		break;
+	}
+	case WM_WALLPAPERREADY:
+	{
+		HBITMAP hbmFrame = (HBITMAP)lParam;
+		if ((unsigned)wParam != g_wpGeneration)
 		{
-			if (bm.bmWidth > rect.right || bm.bmHeight > rect.bottom)
-			{
-				double ratio = (double)bm.bmWidth / bm.bmHeight;
-				int newWidth = rect.right;
-				int newHeight = (int)(rect.right / ratio);
-				if (newHeight > rect.bottom)
-				{
-					newHeight = rect.bottom;
-					newWidth = (int)(rect.bottom * ratio);
-				}
-				int x = (rect.right - newWidth) / 2;
-				int y = (rect.bottom - newHeight) / 2;
-				StretchBlt(hdc, x, y, newWidth, newHeight, hdcMem, 0, 0, bm.bmWidth, bm.bmHeight, SRCCOPY);
-			}
-			else
+			// A newer load is on its way
+			if (hbmFrame)
 			{
-				int x = (rect.right - bm.bmWidth) / 2;
-				int y = (rect.bottom - bm.bmHeight) / 2;
-				BitBlt(hdc, x, y, bm.bmWidth, bm.bmHeight, hdcMem, 0, 0, SRCCOPY);
+				DeleteObject(hbmFrame);
 			}
 			break;
 		}
-		case WP_STYLE_FILL:
-		case WP_STYLE_SPAN: // No multi-monitor support yet!
+		SetWallpaperFrame(hbmFrame);
+		InvalidateRect(hWnd, NULL, TRUE);
+		if (g_fFirstWallpaper)
 		{
-			if (bm.bmWidth < rect.right || bm.bmHeight < rect.bottom)
-			{
-				double ratio = (double)bm.bmWidth / bm.bmHeight;
-				int newWidth = rect.right;
-				int newHeight = (int)(rect.right / ratio);
-				if (newHeight < rect.bottom)
-				{
-					newHeight = rect.bottom;
-					newWidth = (int)(rect.bottom * ratio);
-				}
-				int x = (rect.right - newWidth) / 2;
-				int y = rect.bottom - newHeight;
-				if (g_wpStyle == WP_STYLE_SPAN)
-				{
-					y /= 2;
-				}
-				else
-				{
-					y /= 3; // idk why but Windows does this
-				}
-				StretchBlt(hdc, x, y, newWidth, newHeight, hdcMem, 0, 0, bm.bmWidth, bm.bmHeight, SRCCOPY);
-			}
-			else
-			{
-				double ratio = (double)bm.bmWidth / bm.bmHeight;
-				int newHeight = rect.bottom;
-				int newWidth = (int)(rect.bottom * ratio);
-				if (newWidth < rect.right)
-				{
-					newWidth = rect.right;
-					newHeight = (int)(rect.right / ratio);
-				}
-				int x = (rect.right - newWidth) / 2;
-				int y = rect.bottom - newHeight;
-				if (g_wpStyle == WP_STYLE_SPAN)
-				{
-					y /= 2;
-				}
-				else
-				{
-					y /= 3; // idk why but Windows does this
-				}
-				StretchBlt(hdc, x, y, newWidth, newHeight, hdcMem, 0, 0, bm.bmWidth, bm.bmHeight, SRCCOPY);
-			}
-			break;
+			g_fFirstWallpaper = false;
+			dbgprintf(L"CLH_GINA: wallpaper shown after %.1f ms", ElapsedMs(g_wpCreateTime));
 		}
-		}
-		SelectObject(hdcMem, hbmOld);
-		DeleteDC(hdcMem);
-		EndPaint(hWnd, &ps);
 		break;
 	}
 	case WM_ERASEBKGND:
 	{
+		if (g_hdcFrame)
+		{
+			// WM_PAINT covers every pixel, erasing first would only flicker
+			return 1;
+		}
 		HDC hdc = (HDC)wParam;
 		RECT rect;
-		GetClientRect(hWnd, &rect);
+		GetClipBox(hdc, &rect);
 		// Note: this returns black color by default on pre-logon sessions
 		// To override this color, set HKLM\SOFTWARE\Microsoft\Windows NT\CurrentVersion\Winlogon\Background to a valid color
 		// Or just delete that key to make it use HKCU(of SYSTEM)\Control Panel\Colors\Background instead as usual
-		COLORREF bgColor = GetSysColor(COLOR_BACKGROUND);
-		HBRUSH hBrush = CreateSolidBrush(bgColor);
-		FillRect(hdc, &rect, hBrush);
-		DeleteObject(hBrush);
+		// System brushes are owned by the system and never have to be deleted
+		FillRect(hdc, &rect, GetSysColorBrush(COLOR_BACKGROUND));
 		return 1;
 		break;
 	}
@@ -362,19 +594,18 @@ LRESULT CALLBACK wallHost::WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARA
 	}
 	case WM_THEMECHANGED:
 	{
-		LoadWallpaper();
-		InvalidateRect(hWnd, NULL, TRUE);
+		LoadWallpaper(hWnd);
 		break;
 	}
 	case WM_DISPLAYCHANGE:
 	{
-		RECT screenRect;
-		screenRect.left = 0;
-		screenRect.top = 0;
-		screenRect.right = GetSystemMetrics(SM_CXSCREEN);
-		screenRect.bottom = GetSystemMetrics(SM_CYSCREEN);
-		SetWindowPos(hWnd, HWND_BOTTOM, 0, 0, screenRect.right, screenRect.bottom, SWP_NOZORDER | SWP_NOMOVE);
-		InvalidateRect(hWnd, NULL, TRUE);
+		// Monitors may have been added, removed or moved around
+		SetWindowPos(hWnd, HWND_BOTTOM,
+			GetSystemMetrics(SM_XVIRTUALSCREEN), GetSystemMetrics(SM_YVIRTUALSCREEN),
+			GetSystemMetrics(SM_CXVIRTUALSCREEN), GetSystemMetrics(SM_CYVIRTUALSCREEN),
+			SWP_NOZORDER | SWP_NOACTIVATE);
+		// The frame is composed for the old resolution
+		LoadWallpaper(hWnd);
 		break;
 	}
 	case WM_DESTROY:
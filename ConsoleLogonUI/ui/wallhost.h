@@ -1,13 +1,7 @@
 #pragma once
 #include <windows.h>
 #include "gina_manager.h"
-
-#define WP_STYLE_CENTER 0
-#define WP_STYLE_TILE 1
-#define WP_STYLE_STRETCH 2
-#define WP_STYLE_FIT 3
-#define WP_STYLE_FILL 4
-#define WP_STYLE_SPAN 5
+#include "wallcompose.h"
 
 void InitWallHost();
 
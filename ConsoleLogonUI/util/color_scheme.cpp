@@ -0,0 +1,125 @@
+#pragma once
+#include "color_scheme.h"
+
+struct colorSchemeEntry
+{
+	const wchar_t* name;
+	int element; // COLOR_* from winuser.h
+};
+
+static const colorSchemeEntry g_colorScheme[COLOR_SCHEME_COUNT] =
+{
+	{ L"Scrollbar", 0 },
+	{ L"Background", 1 },
+	{ L"ActiveTitle", 2 },
+	{ L"InactiveTitle", 3 },
+	{ L"Menu", 4 },
+	{ L"Window", 5 },
+	{ L"WindowFrame", 6 },
+	{ L"MenuText", 7 },
+	{ L"WindowText", 8 },
+	{ L"TitleText", 9 },
+	{ L"ActiveBorder", 10 },
+	{ L"InactiveBorder", 11 },
+	{ L"AppWorkspace", 12 },
+	{ L"Hilight", 13 },
+	{ L"HilightText", 14 },
+	{ L"ButtonFace", 15 },
+	{ L"ButtonShadow", 16 },
+	{ L"GrayText", 17 },
+	{ L"ButtonText", 18 },
+	{ L"InactiveTitleText", 19 },
+	{ L"ButtonHilight", 20 },
+	{ L"ButtonDkShadow", 21 },
+	{ L"ButtonLight", 22 },
+	{ L"InfoText", 23 },
+	{ L"InfoWindow", 24 },
+	// 25: Probably ButtonAlternateFace but it's somehow missing in winuser.h. It's rarely used anyway.
+	{ L"HotTrackingColor", 26 },
+	{ L"GradientActiveTitle", 27 },
+	{ L"GradientInactiveTitle", 28 },
+	{ L"MenuHilight", 29 },
+	{ L"MenuBar", 30 }
+};
+
+static wchar_t FoldAscii(wchar_t ch)
+{
+	return (ch >= L'A' && ch <= L'Z') ? (wchar_t)(ch - L'A' + L'a') : ch;
+}
+
+int ColorSchemeIndex(const wchar_t* name, size_t cchName)
+{
+	for (int i = 0; i < COLOR_SCHEME_COUNT; i++)
+	{
+		const wchar_t* entry = g_colorScheme[i].name;
+		size_t j = 0;
+		while (j < cchName && entry[j] && FoldAscii(name[j]) == FoldAscii(entry[j]))
+		{
+			j++;
+		}
+		if (j == cchName && !entry[j])
+			return i;
+	}
+	return -1;
+}
+
+int ColorSchemeElement(int index)
+{
+	if (index < 0 || index >= COLOR_SCHEME_COUNT)
+		return -1;
+	return g_colorScheme[index].element;
+}
+
+bool ParseColorTriplet(const wchar_t* text, size_t cchText, uint32_t* pColor)
+{
+	uint32_t components[3];
+	size_t i = 0;
+	for (int c = 0; c < 3; c++)
+	{
+		while (i < cchText && (text[i] == L' ' || text[i] == L'\t'))
+		{
+			i++;
+		}
+
+		size_t start = i;
+		uint32_t value = 0;
+		while (i < cchText && text[i] >= L'0' && text[i] <= L'9' && i - start < 3)
+		{
+			value = value * 10 + (text[i] - L'0');
+			i++;
+		}
+		if (i == start || value > 255)
+			return false;
+		// 4 digits, or a number glued to something else
+		if (i < cchText && text[i] && text[i] != L' ' && text[i] != L'\t')
+			return false;
+
+		components[c] = value;
+	}
+
+	// Trailing blanks are fine, anything else isn't
+	while (i < cchText && (text[i] == L' ' || text[i] == L'\t'))
+	{
+		i++;
+	}
+	if (i < cchText && text[i])
+		return false;
+
+	*pColor = components[0] | (components[1] << 8) | (components[2] << 16);
+	return true;
+}
+
+int DiffColorScheme(const colorScheme& scheme, const uint32_t* current, int* pElements, uint32_t* pColors)
+{
+	int count = 0;
+	for (int i = 0; i < COLOR_SCHEME_COUNT; i++)
+	{
+		if (!(scheme.present & (1u << i)) || scheme.colors[i] == current[i])
+			continue;
+
+		pElements[count] = g_colorScheme[i].element;
+		pColors[count] = scheme.colors[i];
+		count++;
+	}
+	return count;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Elements of Control Panel\Colors that CLH_GINA applies, ButtonAlternateFace (25) is left out
+#define COLOR_SCHEME_COUNT 30
+
+// Parsed Control Panel\Colors, colors are COLORREFs (0x00BBGGRR)
+struct colorScheme
+{
+	uint32_t colors[COLOR_SCHEME_COUNT];
+	uint32_t present; // Bit i set if colors[i] was read
+	int invalid; // Values that are there but couldn't be parsed
+};
+
+// Index of a value name in the scheme, -1 if CLH_GINA doesn't apply it; names are case insensitive
+int ColorSchemeIndex(const wchar_t* name, size_t cchName);
+// COLOR_* element (GetSysColor index) for a scheme index
+int ColorSchemeElement(int index);
+
+// "r g b" with decimal components up to 255 separated by spaces or tabs, the way the registry stores them
+// Doesn't go through the C locale, unlike swscanf
+bool ParseColorTriplet(const wchar_t* text, size_t cchText, uint32_t* pColor);
+
+// Fills pElements and pColors with the present colors that differ from current (indexed by scheme index),
+// returns how many there are; the arrays need room for COLOR_SCHEME_COUNT
+int DiffColorScheme(const colorScheme& scheme, const uint32_t* current, int* pElements, uint32_t* pColors);
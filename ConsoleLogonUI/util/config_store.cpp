@@ -0,0 +1,229 @@
+#pragma once
+#include "config_store.h"
+#include <chrono>
+#include <cwctype>
+#include <thread>
+
+void configSnapshot::Set(const std::wstring& name, const configValue& value)
+{
+	_values[Key(name)] = value;
+}
+
+bool configSnapshot::GetInt(const wchar_t* name, int* pValue) const
+{
+	auto it = _values.find(Key(name));
+	if (it == _values.end() || it->second.type != CT_DWORD)
+		return false;
+
+	*pValue = (int)it->second.dword;
+	return true;
+}
+
+bool configSnapshot::GetString(const wchar_t* name, std::wstring* pValue) const
+{
+	auto it = _values.find(Key(name));
+	if (it == _values.end() || it->second.type != CT_STRING)
+		return false;
+
+	*pValue = it->second.string;
+	return true;
+}
+
+std::wstring configSnapshot::Key(const std::wstring& name)
+{
+	std::wstring key = name;
+	for (wchar_t& ch : key)
+	{
+		ch = (wchar_t)std::towlower(ch);
+	}
+	return key;
+}
+
+configStore* configStore::Get()
+{
+	// Never destroyed, the writer thread may still be waiting on it while statics are torn down
+	static configStore* store = new configStore();
+	return store;
+}
+
+configStore::configStore()
+	: _backend(nullptr), _snapshot(std::make_shared<const configSnapshot>()), _valid(false), _loads(0),
+	_pendingSerial(0), _writerStarted(false), _writeDelayMs(1000), _writes(0)
+{
+}
+
+void configStore::SetBackend(configBackend* backend)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_backend = backend;
+	_valid = false;
+}
+
+std::shared_ptr<const configSnapshot> configStore::Current()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_valid || !_backend)
+	{
+		return _snapshot;
+	}
+
+	// Loaded under the lock so that the first readers don't all hit the backend
+	_loads++;
+	auto snapshot = std::make_shared<configSnapshot>();
+	if (_backend->Load(*snapshot))
+	{
+		OverlayPending(*snapshot);
+		_snapshot = snapshot;
+		_valid = true;
+	}
+	return _snapshot;
+}
+
+void configStore::Reload()
+{
+	configBackend* backend;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		backend = _backend;
+		_valid = false;
+	}
+	if (!backend)
+		return;
+
+	// Readers keep the old snapshot while the new one is read
+	auto snapshot = std::make_shared<configSnapshot>();
+	bool fLoaded = backend->Load(*snapshot);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_loads++;
+	if (fLoaded && _backend == backend)
+	{
+		OverlayPending(*snapshot);
+		_snapshot = snapshot;
+		_valid = true;
+	}
+}
+
+bool configStore::SetInt(const wchar_t* name, int value)
+{
+	// A flush in progress could otherwise write an older value after this one
+	std::lock_guard<std::mutex> writeLock(_writeMutex);
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (!_backend || !_backend->WriteInt(name, (uint32_t)value))
+		return false;
+
+	_writes++;
+	// Whatever was pending for it is stale now
+	_pending.erase(configSnapshot::Key(name));
+	Publish(name, value);
+	return true;
+}
+
+void configStore::SetIntLater(const wchar_t* name, int value)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	Publish(name, value);
+	_pendingSerial++;
+	_pending[configSnapshot::Key(name)] = { name, value, _pendingSerial };
+
+	if (!_writerStarted)
+	{
+		// Never joined, whatever it hasn't written by the time we're unloaded is written by Flush
+		_writerStarted = true;
+		std::thread([this] { WriteLoop(); }).detach();
+	}
+	_pendingChanged.notify_one();
+}
+
+void configStore::Flush()
+{
+	std::lock_guard<std::mutex> writeLock(_writeMutex);
+
+	configBackend* backend;
+	std::map<std::wstring, pendingWrite> pending;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		backend = _backend;
+		pending = _pending;
+	}
+	if (!backend)
+		return;
+
+	// Entries stay pending while they're written so reloads meanwhile still see them
+	for (const auto& write : pending)
+	{
+		if (!backend->WriteInt(write.second.name.c_str(), (uint32_t)write.second.value))
+			continue;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_writes++;
+		auto it = _pending.find(write.first);
+		if (it != _pending.end() && it->second.serial == write.second.serial)
+			_pending.erase(it);
+	}
+}
+
+void configStore::SetWriteDelay(uint64_t delayMs)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_writeDelayMs = delayMs;
+	_pendingChanged.notify_one();
+}
+
+// Called with _mutex held
+void configStore::Publish(const std::wstring& name, int value)
+{
+	configValue cv;
+	cv.type = CT_DWORD;
+	cv.dword = (uint32_t)value;
+	auto snapshot = std::make_shared<configSnapshot>(*_snapshot);
+	snapshot->Set(name, cv);
+	_snapshot = snapshot;
+}
+
+// Called with _mutex held
+void configStore::OverlayPending(configSnapshot& snapshot)
+{
+	for (const auto& pending : _pending)
+	{
+		configValue cv;
+		cv.dword = (uint32_t)pending.second.value;
+		snapshot.Set(pending.first, cv);
+	}
+}
+
+void configStore::WriteLoop()
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_pendingChanged.wait(lock, [this] { return !_pending.empty(); });
+
+			// Wait until nothing has been set for a whole delay
+			uint64_t serial = _pendingSerial;
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_writeDelayMs);
+			while (!_pending.empty() && _pendingChanged.wait_until(lock, deadline) == std::cv_status::no_timeout)
+			{
+				if (serial != _pendingSerial)
+				{
+					serial = _pendingSerial;
+					deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_writeDelayMs);
+				}
+			}
+		}
+		Flush();
+	}
+}
+
+uint64_t configStore::GetLoadCount()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _loads;
+}
+
+uint64_t configStore::GetWriteCount()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _writes;
+}
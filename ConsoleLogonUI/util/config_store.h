@@ -0,0 +1,110 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+enum CONFIG_TYPE
+{
+	CT_DWORD = 0,
+	CT_STRING
+};
+
+struct configValue
+{
+	CONFIG_TYPE type = CT_DWORD;
+	uint32_t dword = 0;
+	std::wstring string;
+};
+
+// Every config value as of one read of the backend, names are case insensitive like registry value names
+// Published snapshots are never modified, a change is a new snapshot
+class configSnapshot
+{
+public:
+	void Set(const std::wstring& name, const configValue& value);
+
+	// Only DWORD values, false if it's missing or has another type
+	bool GetInt(const wchar_t* name, int* pValue) const;
+	// Only string values
+	bool GetString(const wchar_t* name, std::wstring* pValue) const;
+
+	size_t Count() const { return _values.size(); }
+
+	// The lowercase form every name is stored under
+	static std::wstring Key(const std::wstring& name);
+
+private:
+	std::map<std::wstring, configValue> _values;
+};
+
+// Where the values live, the CLH_GINA registry key on Windows
+class configBackend
+{
+public:
+	virtual ~configBackend() {}
+	// Fills a fresh snapshot with everything there is, false if the store couldn't be read at all
+	virtual bool Load(configSnapshot& snapshot) = 0;
+	virtual bool WriteInt(const wchar_t* name, uint32_t value) = 0;
+};
+
+// Holds the current snapshot; readers get it without touching the backend,
+// it's reloaded as a whole when the backend reports a change
+class configStore
+{
+public:
+	static configStore* Get();
+
+	void SetBackend(configBackend* backend);
+
+	// Never returns NULL, the snapshot is empty if there's no backend or it failed
+	std::shared_ptr<const configSnapshot> Current();
+	// Reads the backend again and swaps the new snapshot in
+	void Reload();
+
+	// Writes through to the backend, the current snapshot gets the value without waiting for a reload
+	bool SetInt(const wchar_t* name, int value);
+	// For UI state: the snapshot gets the value now, the backend once nothing has been set for the write delay
+	// Setting the same name again before then only writes the last value
+	void SetIntLater(const wchar_t* name, int value);
+	// Writes everything still pending on the calling thread
+	void Flush();
+	void SetWriteDelay(uint64_t delayMs);
+
+	uint64_t GetLoadCount();
+	uint64_t GetWriteCount();
+
+private:
+	configStore();
+
+	void Publish(const std::wstring& name, int value);
+	void WriteLoop();
+
+	std::mutex _mutex;
+	configBackend* _backend;
+	std::shared_ptr<const configSnapshot> _snapshot;
+	bool _valid;
+	uint64_t _loads;
+
+	struct pendingWrite
+	{
+		std::wstring name; // As last passed in, what the backend is given
+		int value;
+		uint64_t serial; // _pendingSerial when it was set, tells a flush whether it was set again meanwhile
+	};
+
+	void OverlayPending(configSnapshot& snapshot);
+
+	// Pending writes by key, laid over reloaded snapshots so a reload can't undo them
+	// An entry only leaves once the backend has taken it, a failed write stays for the next flush
+	std::map<std::wstring, pendingWrite> _pending;
+	std::condition_variable _pendingChanged;
+	uint64_t _pendingSerial;
+	bool _writerStarted;
+	uint64_t _writeDelayMs;
+	uint64_t _writes;
+	// Held for a whole flush so that batches reach the backend in order
+	std::mutex _writeMutex;
+};
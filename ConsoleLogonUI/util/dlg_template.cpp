@@ -0,0 +1,316 @@
+#pragma once
+#include "dlg_template.h"
+#include <cstring>
+
+#define DLG_SETFONT 0x00000040u
+#define DLG_EX_SIGNATURE 0xFFFF0001u
+// Guards against a damaged item count
+#define DLG_MAX_ITEMS 4096
+
+// Little-endian cursor over a template, every read fails once it runs off the end
+struct dlgReader
+{
+	const uint8_t* data;
+	size_t size;
+	size_t pos;
+
+	bool Read16(uint16_t* pValue)
+	{
+		if (pos > size || size - pos < 2)
+			return false;
+		memcpy(pValue, data + pos, 2);
+		pos += 2;
+		return true;
+	}
+
+	bool Read32(uint32_t* pValue)
+	{
+		if (pos > size || size - pos < 4)
+			return false;
+		memcpy(pValue, data + pos, 4);
+		pos += 4;
+		return true;
+	}
+
+	bool ReadShort(int* pValue)
+	{
+		uint16_t value;
+		if (!Read16(&value))
+			return false;
+		*pValue = (int16_t)value;
+		return true;
+	}
+
+	// Null-terminated UTF-16 string
+	bool SkipString()
+	{
+		uint16_t ch;
+		do
+		{
+			if (!Read16(&ch))
+				return false;
+		} while (ch != 0);
+		return true;
+	}
+
+	// sz_Or_Ord: 0 for none, 0xFFFF followed by an ordinal, or a string
+	bool ReadSzOrOrd(uint16_t* pOrdinal)
+	{
+		uint16_t first;
+		*pOrdinal = 0;
+		if (!Read16(&first))
+			return false;
+		if (first == 0)
+			return true;
+		if (first == 0xFFFF)
+			return Read16(pOrdinal);
+		return SkipString();
+	}
+
+	void Align(size_t alignment)
+	{
+		pos = (pos + alignment - 1) & ~(alignment - 1);
+	}
+};
+
+// Same rounding as MulDiv
+static int ScaleUnits(int value, int numerator, int denominator)
+{
+	int64_t product = (int64_t)value * numerator;
+	int64_t half = denominator / 2;
+	return (int)(product >= 0 ? (product + half) / denominator : (product - half) / denominator);
+}
+
+bool ParseDialogTemplate(const uint8_t* data, size_t size, dlgTemplate* pTemplate)
+{
+	if (!data || !pTemplate)
+		return false;
+
+	dlgReader reader = { data, size, 0 };
+	pTemplate->items.clear();
+
+	uint32_t signature, style;
+	uint16_t count, ordinal;
+	if (!reader.Read32(&signature))
+		return false;
+
+	// DLGTEMPLATEEX starts with dlgVer 1 and signature 0xFFFF, DLGTEMPLATE with its style
+	pTemplate->fExtended = signature == DLG_EX_SIGNATURE;
+	if (pTemplate->fExtended)
+	{
+		uint32_t helpId, exStyle;
+		if (!reader.Read32(&helpId) || !reader.Read32(&exStyle) || !reader.Read32(&style))
+			return false;
+	}
+	else
+	{
+		uint32_t exStyle;
+		style = signature;
+		if (!reader.Read32(&exStyle))
+			return false;
+	}
+	pTemplate->style = style;
+
+	if (!reader.Read16(&count)
+		|| !reader.ReadShort(&pTemplate->x) || !reader.ReadShort(&pTemplate->y)
+		|| !reader.ReadShort(&pTemplate->cx) || !reader.ReadShort(&pTemplate->cy))
+		return false;
+
+	// Menu, class and title
+	if (!reader.ReadSzOrOrd(&ordinal) || !reader.ReadSzOrOrd(&ordinal) || !reader.SkipString())
+		return false;
+
+	if (style & DLG_SETFONT)
+	{
+		// Point size, then weight, italic and charset in the extended form, then the face name
+		uint16_t pointSize, weight, italicCharset;
+		if (!reader.Read16(&pointSize))
+			return false;
+		if (pTemplate->fExtended && (!reader.Read16(&weight) || !reader.Read16(&italicCharset)))
+			return false;
+		if (!reader.SkipString())
+			return false;
+	}
+
+	if (count > DLG_MAX_ITEMS)
+		return false;
+	pTemplate->items.reserve(count);
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		// Every item starts on a DWORD boundary
+		reader.Align(4);
+
+		dlgItem item = {};
+		uint16_t extraSize;
+		if (pTemplate->fExtended)
+		{
+			uint32_t helpId, exStyle;
+			if (!reader.Read32(&helpId) || !reader.Read32(&exStyle) || !reader.Read32(&item.style)
+				|| !reader.ReadShort(&item.x) || !reader.ReadShort(&item.y)
+				|| !reader.ReadShort(&item.cx) || !reader.ReadShort(&item.cy)
+				|| !reader.Read32(&item.id))
+				return false;
+		}
+		else
+		{
+			uint32_t exStyle;
+			uint16_t id;
+			if (!reader.Read32(&item.style) || !reader.Read32(&exStyle)
+				|| !reader.ReadShort(&item.x) || !reader.ReadShort(&item.y)
+				|| !reader.ReadShort(&item.cx) || !reader.ReadShort(&item.cy)
+				|| !reader.Read16(&id))
+				return false;
+			item.id = id;
+		}
+
+		// Class, title, then creation data prefixed by its size in bytes
+		if (!reader.ReadSzOrOrd(&item.classAtom) || !reader.ReadSzOrOrd(&ordinal) || !reader.Read16(&extraSize))
+			return false;
+		if (extraSize)
+		{
+			if (reader.pos > size || size - reader.pos < extraSize)
+				return false;
+			reader.pos += extraSize;
+		}
+
+		pTemplate->items.push_back(item);
+	}
+	return true;
+}
+
+dlgLayout::dlgLayout()
+	: _width(0), _height(0), _fResized(false)
+{
+}
+
+void dlgLayout::Load(const dlgTemplate& tmpl, int baseUnitX, int baseUnitY, int width, int height)
+{
+	_items.clear();
+	_items.reserve(tmpl.items.size());
+	_width = width;
+	_height = height;
+	_fResized = false;
+
+	for (const dlgItem& src : tmpl.items)
+	{
+		// Position and size are scaled separately, same as the dialog manager does
+		dlgItem item = src;
+		item.x = ScaleUnits(src.x, baseUnitX, 4);
+		item.y = ScaleUnits(src.y, baseUnitY, 8);
+		item.cx = ScaleUnits(src.cx, baseUnitX, 4);
+		item.cy = ScaleUnits(src.cy, baseUnitY, 8);
+		item.fHidden = false;
+		item.fChanged = false;
+		_items.push_back(item);
+	}
+}
+
+void dlgLayout::Add(const dlgItem& item)
+{
+	_items.push_back(item);
+}
+
+dlgItem* dlgLayout::Find(uint32_t id)
+{
+	for (dlgItem& item : _items)
+	{
+		if (item.id == id)
+			return &item;
+	}
+	return nullptr;
+}
+
+void dlgLayout::Hide(uint32_t id)
+{
+	dlgItem* pItem = Find(id);
+	if (pItem && !pItem->fHidden)
+	{
+		pItem->fHidden = true;
+		pItem->fChanged = true;
+	}
+}
+
+void dlgLayout::Offset(uint32_t id, int dx, int dy)
+{
+	dlgItem* pItem = Find(id);
+	if (pItem && (dx || dy))
+	{
+		pItem->x += dx;
+		pItem->y += dy;
+		pItem->fChanged = true;
+	}
+}
+
+void dlgLayout::OffsetBelow(int top, int dy, uint32_t exceptId)
+{
+	if (!dy)
+		return;
+	for (dlgItem& item : _items)
+	{
+		if (item.id != exceptId && item.y > top)
+		{
+			item.y += dy;
+			item.fChanged = true;
+		}
+	}
+}
+
+void dlgLayout::OffsetAll(int dx, int dy)
+{
+	if (!dx && !dy)
+		return;
+	for (dlgItem& item : _items)
+	{
+		item.x += dx;
+		item.y += dy;
+		item.fChanged = true;
+	}
+}
+
+void dlgLayout::Resize(int dx, int dy)
+{
+	if (!dx && !dy)
+		return;
+	_width += dx;
+	_height += dy;
+	_fResized = true;
+}
+
+std::vector<dlgItem>& dlgLayout::GetItems()
+{
+	return _items;
+}
+
+const std::vector<dlgItem>& dlgLayout::GetItems() const
+{
+	return _items;
+}
+
+int dlgLayout::GetWidth() const
+{
+	return _width;
+}
+
+int dlgLayout::GetHeight() const
+{
+	return _height;
+}
+
+bool dlgLayout::IsResized() const
+{
+	return _fResized;
+}
+
+bool ClearDialogTemplateStyle(uint8_t* data, size_t size, uint32_t bits)
+{
+	if (!data || size < 16)
+		return false;
+
+	uint32_t signature = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+	// The style comes first in DLGTEMPLATE, after dlgVer, signature, helpID and exStyle in DLGTEMPLATEEX
+	uint8_t* style = data + (signature == DLG_EX_SIGNATURE ? 12 : 0);
+	for (int i = 0; i < 4; i++)
+		style[i] &= (uint8_t)~(bits >> (i * 8));
+	return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Dialog template parser and in-memory control layout
+// Doesn't depend on Win32, dialogs are laid out on plain rectangles and moved by the caller in one go
+
+#define DLG_CLASS_BUTTON 0x0080
+#define DLG_CLASS_EDIT 0x0081
+#define DLG_CLASS_STATIC 0x0082
+#define DLG_CLASS_LISTBOX 0x0083
+#define DLG_CLASS_SCROLLBAR 0x0084
+#define DLG_CLASS_COMBOBOX 0x0085
+
+struct dlgItem
+{
+	uint32_t id; // Low word only for DLGTEMPLATE, so -1 statics are 0xFFFF
+	uint32_t style;
+	uint16_t classAtom; // 0 for classes given by name
+	// Dialog units as parsed, pixels in a dlgLayout
+	int x;
+	int y;
+	int cx;
+	int cy;
+	bool fHidden;
+	bool fChanged;
+};
+
+struct dlgTemplate
+{
+	bool fExtended; // DLGTEMPLATEEX
+	uint32_t style;
+	int x;
+	int y;
+	int cx;
+	int cy;
+	std::vector<dlgItem> items; // In creation order
+};
+
+// Accepts both DLGTEMPLATE and DLGTEMPLATEEX
+bool ParseDialogTemplate(const uint8_t* data, size_t size, dlgTemplate* pTemplate);
+// Clears style bits of the dialog itself in a copy of its template, e.g. WS_VISIBLE to create it hidden
+bool ClearDialogTemplateStyle(uint8_t* data, size_t size, uint32_t bits);
+
+// Final rectangles of a dialog and its controls, worked out before anything is moved
+// Operations only touch the model and mark what changed, hidden controls keep their place
+class dlgLayout
+{
+public:
+	dlgLayout();
+
+	// baseUnitX/Y: pixels per 4 horizontal and 8 vertical dialog units, as MapDialogRect gives them
+	// width/height: current size of the dialog window
+	void Load(const dlgTemplate& tmpl, int baseUnitX, int baseUnitY, int width, int height);
+	// For controls that aren't in the template, or when there is no template to go by
+	void Add(const dlgItem& item);
+
+	// First control with the id, NULL if the template has none
+	dlgItem* Find(uint32_t id);
+	void Hide(uint32_t id);
+	void Offset(uint32_t id, int dx, int dy);
+	// Every control starting below top, except the one with exceptId
+	void OffsetBelow(int top, int dy, uint32_t exceptId);
+	void OffsetAll(int dx, int dy);
+	void Resize(int dx, int dy);
+
+	std::vector<dlgItem>& GetItems();
+	const std::vector<dlgItem>& GetItems() const;
+	int GetWidth() const;
+	int GetHeight() const;
+	bool IsResized() const;
+
+private:
+	std::vector<dlgItem> _items;
+	int _width;
+	int _height;
+	bool _fResized;
+};
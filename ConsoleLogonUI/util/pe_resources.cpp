@@ -0,0 +1,292 @@
+#pragma once
+#include "pe_resources.h"
+#include <algorithm>
+#include <cstring>
+
+#define PE_DIRECTORY_RESOURCE 2
+#define PE_RESOURCE_SUBDIRECTORY 0x80000000u
+#define PE_RESOURCE_NAMED 0x80000000u
+#define PE_VERSION_SIGNATURE 0xFEEF04BDu
+// Directory entries read across the whole tree, guards against damaged directories
+// that share subdirectories between entries, which a level limit alone lets fan out
+#define PE_MAX_ENTRIES 65536
+
+static bool Read16(const uint8_t* base, size_t size, size_t offset, uint16_t* pValue)
+{
+	if (offset > size || size - offset < 2)
+		return false;
+	memcpy(pValue, base + offset, 2);
+	return true;
+}
+
+static bool Read32(const uint8_t* base, size_t size, size_t offset, uint32_t* pValue)
+{
+	if (offset > size || size - offset < 4)
+		return false;
+	memcpy(pValue, base + offset, 4);
+	return true;
+}
+
+static bool EntryLess(const peResourceEntry& a, const peResourceEntry& b)
+{
+	if (a.type != b.type)
+		return a.type < b.type;
+	if (a.id != b.id)
+		return a.id < b.id;
+	return a.lang < b.lang;
+}
+
+peResources::peResources()
+	: _image(nullptr), _size(0), _fMapped(false), _root{ nullptr, 0 }, _visited(0)
+{
+}
+
+bool peResources::Open(const uint8_t* image, size_t size, bool fMapped)
+{
+	Close();
+	_image = image;
+	_size = size;
+	_fMapped = fMapped;
+
+	uint16_t magic;
+	uint32_t peOffset, signature;
+	if (!image || !Read16(image, size, 0, &magic) || magic != 0x5A4D // MZ
+		|| !Read32(image, size, 0x3C, &peOffset)
+		|| !Read32(image, size, peOffset, &signature) || signature != 0x00004550) // PE\0\0
+	{
+		Close();
+		return false;
+	}
+
+	size_t fileHeader = (size_t)peOffset + 4;
+	size_t optionalHeader = fileHeader + 20;
+	uint16_t sectionCount, optionalSize, optionalMagic;
+	if (!Read16(image, size, fileHeader + 2, &sectionCount)
+		|| !Read16(image, size, fileHeader + 16, &optionalSize)
+		|| !Read16(image, size, optionalHeader, &optionalMagic))
+	{
+		Close();
+		return false;
+	}
+
+	// PE32 and PE32+ only differ in where the data directories start
+	size_t directories;
+	if (optionalMagic == 0x10B)
+		directories = 96;
+	else if (optionalMagic == 0x20B)
+		directories = 112;
+	else
+	{
+		Close();
+		return false;
+	}
+
+	uint32_t directoryCount, resourceRva, resourceSize;
+	if (!Read32(image, size, optionalHeader + directories - 4, &directoryCount)
+		|| directoryCount <= PE_DIRECTORY_RESOURCE
+		|| directories + (PE_DIRECTORY_RESOURCE + 1) * 8 > optionalSize
+		|| !Read32(image, size, optionalHeader + directories + PE_DIRECTORY_RESOURCE * 8, &resourceRva)
+		|| !Read32(image, size, optionalHeader + directories + PE_DIRECTORY_RESOURCE * 8 + 4, &resourceSize)
+		|| !resourceRva || !resourceSize)
+	{
+		Close();
+		return false;
+	}
+
+	size_t sectionTable = optionalHeader + optionalSize;
+	for (uint16_t i = 0; i < sectionCount; i++)
+	{
+		size_t offset = sectionTable + (size_t)i * 40;
+		section s;
+		if (!Read32(image, size, offset + 8, &s.virtualSize)
+			|| !Read32(image, size, offset + 12, &s.rva)
+			|| !Read32(image, size, offset + 16, &s.rawSize)
+			|| !Read32(image, size, offset + 20, &s.rawOffset))
+		{
+			Close();
+			return false;
+		}
+		_sections.push_back(s);
+	}
+
+	_visited = 0;
+	if (!RvaToSpan(resourceRva, resourceSize, &_root) || !ReadDirectory(0, 0, 0, 0))
+	{
+		Close();
+		return false;
+	}
+
+	std::sort(_entries.begin(), _entries.end(), EntryLess);
+	return true;
+}
+
+void peResources::Close()
+{
+	_image = nullptr;
+	_size = 0;
+	_sections.clear();
+	_entries.clear();
+	_root = { nullptr, 0 };
+}
+
+bool peResources::IsOpen() const
+{
+	return _root.data != nullptr;
+}
+
+bool peResources::RvaToSpan(uint32_t rva, uint32_t size, peSpan* pSpan) const
+{
+	size_t offset = rva;
+	if (!_fMapped)
+	{
+		// Raw files need the section the RVA falls in
+		bool fFound = false;
+		for (const section& s : _sections)
+		{
+			uint32_t extent = std::max(s.virtualSize, s.rawSize);
+			if (rva >= s.rva && rva - s.rva < extent)
+			{
+				if (rva - s.rva >= s.rawSize || size > s.rawSize - (rva - s.rva))
+					return false;
+				offset = (size_t)s.rawOffset + (rva - s.rva);
+				fFound = true;
+				break;
+			}
+		}
+		if (!fFound)
+			return false;
+	}
+
+	if (offset > _size || size > _size - offset)
+		return false;
+	pSpan->data = _image + offset;
+	pSpan->size = size;
+	return true;
+}
+
+// Level 0 is the type, 1 the id and 2 the language, whose entries point at the data
+bool peResources::ReadDirectory(uint32_t offset, int level, uint16_t type, uint16_t id)
+{
+	uint16_t namedCount, idCount;
+	if (!Read16(_root.data, _root.size, (size_t)offset + 12, &namedCount)
+		|| !Read16(_root.data, _root.size, (size_t)offset + 14, &idCount))
+		return false;
+
+	size_t first = (size_t)offset + 16;
+	for (uint32_t i = 0; i < (uint32_t)namedCount + idCount; i++)
+	{
+		if (++_visited > PE_MAX_ENTRIES)
+			return false;
+
+		uint32_t name, target;
+		if (!Read32(_root.data, _root.size, first + (size_t)i * 8, &name)
+			|| !Read32(_root.data, _root.size, first + (size_t)i * 8 + 4, &target))
+			return false;
+
+		if ((name & PE_RESOURCE_NAMED) || name > 0xFFFF)
+			continue;
+
+		if (target & PE_RESOURCE_SUBDIRECTORY)
+		{
+			// Only three levels exist, deeper ones would be a loop
+			if (level >= 2 || !ReadDirectory(target & ~PE_RESOURCE_SUBDIRECTORY, level + 1,
+				level == 0 ? (uint16_t)name : type, level == 1 ? (uint16_t)name : id))
+				return false;
+			continue;
+		}
+
+		// Data entries only belong on the language level
+		if (level != 2)
+			continue;
+
+		uint32_t dataRva, dataSize;
+		peResourceEntry entry;
+		if (!Read32(_root.data, _root.size, target, &dataRva)
+			|| !Read32(_root.data, _root.size, (size_t)target + 4, &dataSize)
+			|| !RvaToSpan(dataRva, dataSize, &entry.span))
+			continue; // Skip the one broken resource, keep the rest
+
+		entry.type = type;
+		entry.id = id;
+		entry.lang = (uint16_t)name;
+		_entries.push_back(entry);
+	}
+	return true;
+}
+
+bool peResources::Find(uint16_t type, uint16_t id, peSpan* pSpan, uint16_t lang) const
+{
+	peResourceEntry key = { type, id, 0, { nullptr, 0 } };
+	auto it = std::lower_bound(_entries.begin(), _entries.end(), key, EntryLess);
+	if (it == _entries.end() || it->type != type || it->id != id)
+		return false;
+
+	// The neutral language sorts first, so without a match it gets picked as well
+	const peResourceEntry* pFound = &*it;
+	for (; it != _entries.end() && it->type == type && it->id == id; ++it)
+	{
+		if (lang && it->lang == lang)
+		{
+			pFound = &*it;
+			break;
+		}
+	}
+	*pSpan = pFound->span;
+	return true;
+}
+
+const std::vector<peResourceEntry>& peResources::GetEntries() const
+{
+	return _entries;
+}
+
+bool peResources::GetFileVersion(uint32_t* pVersionMS, uint32_t* pVersionLS) const
+{
+	// Version info is always id 1 (VS_VERSION_INFO) in msgina, take whatever there is otherwise
+	peSpan span;
+	if (!Find(PE_RT_VERSION, 1, &span))
+	{
+		auto it = std::find_if(_entries.begin(), _entries.end(), [](const peResourceEntry& entry) { return entry.type == PE_RT_VERSION; });
+		if (it == _entries.end())
+			return false;
+		span = it->span;
+	}
+
+	// VS_VERSIONINFO: wLength, wValueLength, wType, L"VS_VERSION_INFO", padding, VS_FIXEDFILEINFO
+	const size_t fixedOffset = (6 + sizeof(u"VS_VERSION_INFO") + 3) & ~(size_t)3;
+	uint16_t valueLength;
+	uint32_t signature;
+	if (span.size < fixedOffset + 16
+		|| !Read16(span.data, span.size, 2, &valueLength) || valueLength < 52
+		|| memcmp(span.data + 6, u"VS_VERSION_INFO", sizeof(u"VS_VERSION_INFO")) != 0
+		|| !Read32(span.data, span.size, fixedOffset, &signature) || signature != PE_VERSION_SIGNATURE)
+		return false;
+
+	return Read32(span.data, span.size, fixedOffset + 8, pVersionMS)
+		&& Read32(span.data, span.size, fixedOffset + 12, pVersionLS);
+}
+
+bool peResources::GetString(uint16_t id, const char16_t** ppString, uint32_t* pLength, uint16_t lang) const
+{
+	// Strings are stored 16 to a block, each prefixed by its length
+	peSpan span;
+	if (!Find(PE_RT_STRING, (uint16_t)((id >> 4) + 1), &span, lang))
+		return false;
+
+	size_t offset = 0;
+	for (int i = 0; i < (id & 15); i++)
+	{
+		uint16_t length;
+		if (!Read16(span.data, span.size, offset, &length))
+			return false;
+		offset += 2 + (size_t)length * 2;
+	}
+
+	uint16_t length;
+	if (!Read16(span.data, span.size, offset, &length) || !length
+		|| (size_t)length * 2 > span.size - offset - 2)
+		return false;
+	*ppString = (const char16_t*)(span.data + offset + 2);
+	*pLength = length;
+	return true;
+}
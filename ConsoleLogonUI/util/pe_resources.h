@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Read-only index of the resources in a PE image
+// Doesn't depend on Win32 and never copies, lookups point into the memory the image was opened over,
+// which has to stay valid for as long as the index is used
+
+#define PE_RT_BITMAP 2
+#define PE_RT_ICON 3
+#define PE_RT_DIALOG 5
+#define PE_RT_STRING 6
+#define PE_RT_GROUP_ICON 14
+#define PE_RT_VERSION 16
+
+struct peSpan
+{
+	const uint8_t* data;
+	uint32_t size;
+};
+
+struct peResourceEntry
+{
+	uint16_t type;
+	uint16_t id;
+	uint16_t lang;
+	peSpan span;
+};
+
+class peResources
+{
+public:
+	peResources();
+
+	// fMapped: the image is laid out by sections as the loader maps it (e.g. LOAD_LIBRARY_AS_IMAGE_RESOURCE),
+	// otherwise it's the raw file
+	// Resources with string names or types are skipped, msgina only uses ids
+	bool Open(const uint8_t* image, size_t size, bool fMapped);
+	void Close();
+	bool IsOpen() const;
+
+	// lang 0 prefers the neutral language, then takes whatever comes first
+	bool Find(uint16_t type, uint16_t id, peSpan* pSpan, uint16_t lang = 0) const;
+	const std::vector<peResourceEntry>& GetEntries() const;
+
+	// From the VS_FIXEDFILEINFO of the version resource
+	bool GetFileVersion(uint32_t* pVersionMS, uint32_t* pVersionLS) const;
+	// Points at the string table entry, which isn't null terminated; returns false for missing or empty strings
+	bool GetString(uint16_t id, const char16_t** ppString, uint32_t* pLength, uint16_t lang = 0) const;
+
+private:
+	bool RvaToSpan(uint32_t rva, uint32_t size, peSpan* pSpan) const;
+	bool ReadDirectory(uint32_t offset, int level, uint16_t type, uint16_t id);
+
+	const uint8_t* _image;
+	size_t _size;
+	bool _fMapped;
+
+	struct section
+	{
+		uint32_t rva;
+		uint32_t virtualSize;
+		uint32_t rawOffset;
+		uint32_t rawSize;
+	};
+	std::vector<section> _sections;
+
+	// Start of the resource section, every directory offset is relative to it
+	peSpan _root;
+	// Sorted by type, id and lang
+	std::vector<peResourceEntry> _entries;
+	uint32_t _visited;
+};
@@ -0,0 +1,255 @@
+#pragma once
+#include "resample.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RESAMPLE_SSE2
+#include <emmintrin.h>
+#endif
+
+#define RESAMPLE_PI 3.14159265358979323846
+// Below this many output rows per thread, starting threads costs more than it saves
+#define RESAMPLE_MIN_ROWS_PER_THREAD 64
+
+// Filter taps for every visible output pixel along one axis
+struct resampleAxis
+{
+	int taps; // Per output pixel, unused taps have a weight of 0
+	std::vector<int> start;
+	std::vector<float> weights;
+};
+
+static double Sinc(double x)
+{
+	if (x == 0.0)
+		return 1.0;
+	x *= RESAMPLE_PI;
+	return sin(x) / x;
+}
+
+static double FilterRadius(RESAMPLE_FILTER filter)
+{
+	switch (filter)
+	{
+	case RF_BOX:
+		return 0.5;
+	case RF_BILINEAR:
+		return 1.0;
+	default:
+		return 3.0;
+	}
+}
+
+static double FilterWeight(RESAMPLE_FILTER filter, double x)
+{
+	x = fabs(x);
+	switch (filter)
+	{
+	case RF_BOX:
+		return x <= 0.5 ? 1.0 : 0.0;
+	case RF_BILINEAR:
+		return x < 1.0 ? 1.0 - x : 0.0;
+	default:
+		return x < 3.0 ? Sinc(x) * Sinc(x / 3.0) : 0.0;
+	}
+}
+
+// srcSize source pixels map onto dstSize virtual output pixels, of which [first, first + count) are computed
+static void BuildAxis(resampleAxis& axis, int srcSize, int dstSize, int first, int count, RESAMPLE_FILTER filter)
+{
+	double scale = (double)dstSize / srcSize;
+	// Widen the filter when shrinking so every source pixel contributes
+	double filterScale = scale < 1.0 ? 1.0 / scale : 1.0;
+	double support = FilterRadius(filter) * filterScale;
+
+	axis.taps = (int)ceil(support * 2) + 1;
+	axis.start.resize(count);
+	axis.weights.assign((size_t)count * axis.taps, 0.0f);
+
+	std::vector<double> weights(axis.taps);
+	for (int i = 0; i < count; i++)
+	{
+		double center = (first + i + 0.5) / scale;
+		int left = (int)floor(center - support);
+		int start = std::max(0, std::min(left, srcSize - axis.taps));
+		if (srcSize < axis.taps)
+			start = 0;
+
+		std::fill(weights.begin(), weights.end(), 0.0);
+		double total = 0.0;
+		for (int j = left; j <= left + axis.taps; j++)
+		{
+			double w = FilterWeight(filter, (j + 0.5 - center) / filterScale);
+			if (w == 0.0)
+				continue;
+			// Replicate the edges
+			int k = std::max(0, std::min(j, srcSize - 1)) - start;
+			if (k < 0 || k >= axis.taps)
+				continue;
+			weights[k] += w;
+			total += w;
+		}
+
+		if (total == 0.0)
+		{
+			// Box filter exactly between two pixels, take the nearest
+			int k = std::max(0, std::min((int)center, srcSize - 1)) - start;
+			weights[std::max(0, std::min(k, axis.taps - 1))] = 1.0;
+			total = 1.0;
+		}
+
+		axis.start[i] = start;
+		for (int k = 0; k < axis.taps; k++)
+		{
+			axis.weights[(size_t)i * axis.taps + k] = (float)(weights[k] / total);
+		}
+	}
+}
+
+// Horizontal pass of one source row into count float BGRA pixels
+static void FilterRow(const uint8_t* srcRow, int srcWidth, const resampleAxis& axis, int count, float* out)
+{
+	for (int i = 0; i < count; i++)
+	{
+		const float* w = &axis.weights[(size_t)i * axis.taps];
+		const uint8_t* p = srcRow + axis.start[i] * 4;
+		int taps = std::min(axis.taps, srcWidth - axis.start[i]);
+#ifdef RESAMPLE_SSE2
+		__m128i zero = _mm_setzero_si128();
+		__m128 sum = _mm_setzero_ps();
+		for (int k = 0; k < taps; k++)
+		{
+			int px;
+			memcpy(&px, p + k * 4, 4);
+			__m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(px), zero), zero);
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(w[k])));
+		}
+		_mm_storeu_ps(out + i * 4, sum);
+#else
+		float b = 0, g = 0, r = 0, a = 0;
+		for (int k = 0; k < taps; k++)
+		{
+			b += p[k * 4 + 0] * w[k];
+			g += p[k * 4 + 1] * w[k];
+			r += p[k * 4 + 2] * w[k];
+			a += p[k * 4 + 3] * w[k];
+		}
+		out[i * 4 + 0] = b;
+		out[i * 4 + 1] = g;
+		out[i * 4 + 2] = r;
+		out[i * 4 + 3] = a;
+#endif
+	}
+}
+
+// Vertical pass of taps filtered rows into one output row
+static void BlendRows(const float* const* rows, const float* w, int taps, int count, uint8_t* out)
+{
+	for (int i = 0; i < count; i++)
+	{
+#ifdef RESAMPLE_SSE2
+		__m128 sum = _mm_setzero_ps();
+		for (int k = 0; k < taps; k++)
+		{
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[k] + i * 4), _mm_set1_ps(w[k])));
+		}
+		// Round and saturate to 0-255
+		__m128i v = _mm_cvtps_epi32(sum);
+		v = _mm_packs_epi32(v, v);
+		v = _mm_packus_epi16(v, v);
+		int px = _mm_cvtsi128_si32(v);
+		memcpy(out + i * 4, &px, 4);
+#else
+		for (int c = 0; c < 4; c++)
+		{
+			float sum = 0;
+			for (int k = 0; k < taps; k++)
+			{
+				sum += rows[k][i * 4 + c] * w[k];
+			}
+			int v = (int)lrintf(sum);
+			out[i * 4 + c] = (uint8_t)std::max(0, std::min(v, 255));
+		}
+#endif
+	}
+}
+
+static void ResampleRows(const imageView& src, const imageView& dst, int outX, int outY, int outWidth,
+	const resampleAxis& horz, const resampleAxis& vert, int firstRow, int lastRow)
+{
+	// Ring of horizontally filtered source rows, output rows only ever move down the source
+	int ringSize = vert.taps;
+	std::vector<float> ring((size_t)ringSize * outWidth * 4);
+	std::vector<int> ringRow(ringSize, -1);
+	std::vector<const float*> rows(vert.taps);
+
+	for (int y = firstRow; y < lastRow; y++)
+	{
+		int start = vert.start[y];
+		int taps = std::min(vert.taps, src.height - start);
+		for (int k = 0; k < taps; k++)
+		{
+			int srcY = start + k;
+			int slot = srcY % ringSize;
+			float* row = &ring[(size_t)slot * outWidth * 4];
+			if (ringRow[slot] != srcY)
+			{
+				FilterRow(src.pixels + (size_t)srcY * src.stride, src.width, horz, outWidth, row);
+				ringRow[slot] = srcY;
+			}
+			rows[k] = row;
+		}
+		BlendRows(rows.data(), &vert.weights[(size_t)y * vert.taps], taps, outWidth,
+			dst.pixels + (size_t)(outY + y) * dst.stride + outX * 4);
+	}
+}
+
+bool Resample(const imageView& src, const imageView& dst, int dstX, int dstY, int dstWidth, int dstHeight, RESAMPLE_FILTER filter, int threads)
+{
+	if (!src.pixels || !dst.pixels || src.width <= 0 || src.height <= 0 || dstWidth <= 0 || dstHeight <= 0)
+		return false;
+
+	// Visible part of the destination rectangle
+	int outX = std::max(dstX, 0);
+	int outY = std::max(dstY, 0);
+	int outRight = std::min(dstX + dstWidth, dst.width);
+	int outBottom = std::min(dstY + dstHeight, dst.height);
+	if (outRight <= outX || outBottom <= outY)
+		return true;
+	int outWidth = outRight - outX;
+	int outHeight = outBottom - outY;
+
+	resampleAxis horz, vert;
+	BuildAxis(horz, src.width, dstWidth, outX - dstX, outWidth, filter);
+	BuildAxis(vert, src.height, dstHeight, outY - dstY, outHeight, filter);
+
+	if (threads <= 0)
+	{
+		threads = (int)std::thread::hardware_concurrency();
+	}
+	threads = std::max(1, std::min(threads, outHeight / RESAMPLE_MIN_ROWS_PER_THREAD));
+
+	if (threads == 1)
+	{
+		ResampleRows(src, dst, outX, outY, outWidth, horz, vert, 0, outHeight);
+		return true;
+	}
+
+	// Threads share nothing but the read-only taps, neighbouring bands recompute a few source rows
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threads; i++)
+	{
+		int first = (int)((long long)outHeight * i / threads);
+		int last = (int)((long long)outHeight * (i + 1) / threads);
+		workers.emplace_back(ResampleRows, std::cref(src), std::cref(dst), outX, outY, outWidth, std::cref(horz), std::cref(vert), first, last);
+	}
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+
+// Separable image resampler for 32bpp BGRA buffers
+// Doesn't depend on Win32, images are plain pixel buffers
+
+enum RESAMPLE_FILTER
+{
+	RF_BOX = 0,
+	RF_BILINEAR,
+	RF_LANCZOS3
+};
+
+struct imageView
+{
+	uint8_t* pixels;
+	int width;
+	int height;
+	int stride; // In bytes
+};
+
+// Scales the whole source into the rectangle (dstX, dstY, dstWidth, dstHeight) of dst
+// The rectangle may reach outside of dst (e.g. fill), only the visible part is computed
+// threads = 0 picks a count from the hardware and the output size
+bool Resample(const imageView& src, const imageView& dst, int dstX, int dstY, int dstWidth, int dstHeight, RESAMPLE_FILTER filter, int threads = 0);
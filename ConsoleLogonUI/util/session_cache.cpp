@@ -0,0 +1,75 @@
+#pragma once
+#include "session_cache.h"
+#include <chrono>
+
+static int64_t NowUs()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+sessionCache* sessionCache::Get()
+{
+	static sessionCache cache;
+	return &cache;
+}
+
+sessionCache::sessionCache()
+	: _provider(nullptr), _identity(std::make_shared<const sessionIdentity>()), _valid(false), _fetchedUs(0), _ttlUs(0), _queries(0)
+{
+}
+
+void sessionCache::SetProvider(sessionIdentityProvider* provider, uint64_t ttlMs)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_provider = provider;
+	_ttlUs = ttlMs * 1000;
+	_valid = false;
+}
+
+void sessionCache::SetTtl(uint64_t ttlMs)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_ttlUs = ttlMs * 1000;
+}
+
+std::shared_ptr<const sessionIdentity> sessionCache::Current()
+{
+	// Queried under the lock so that callers racing a session change don't all hit the provider
+	std::lock_guard<std::mutex> lock(_mutex);
+	if (_valid && (!_ttlUs || (uint64_t)(NowUs() - _fetchedUs) < _ttlUs))
+	{
+		return _identity;
+	}
+
+	if (!_provider)
+	{
+		return _identity;
+	}
+
+	_queries++;
+	auto identity = std::make_shared<sessionIdentity>();
+	if (!_provider->Query(*identity))
+	{
+		// Don't keep a failure around, the next call tries again
+		_identity = std::make_shared<const sessionIdentity>();
+		_valid = false;
+		return _identity;
+	}
+
+	_identity = identity;
+	_valid = true;
+	_fetchedUs = NowUs();
+	return _identity;
+}
+
+void sessionCache::Invalidate()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_valid = false;
+}
+
+uint64_t sessionCache::GetQueryCount()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _queries;
+}
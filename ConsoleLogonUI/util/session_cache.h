@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#define SESSION_NONE ((uint32_t)-1)
+
+// Who owns the active session, as far as LogonUI is concerned
+struct sessionIdentity
+{
+	uint32_t sessionId = SESSION_NONE;
+	std::wstring userName;
+	std::wstring domainName;
+	std::wstring sid; // Only looked up for real users
+	uint64_t logonTime = 0; // FILETIME ticks (UTC), 0 if unknown
+
+	bool IsSystemUser() const
+	{
+		return sessionId == SESSION_NONE || sessionId == 0 || (userName.empty() && domainName.empty());
+	}
+};
+
+// Where the identity comes from, WTS on Windows
+class sessionIdentityProvider
+{
+public:
+	virtual ~sessionIdentityProvider() {}
+	virtual bool Query(sessionIdentity& identity) = 0;
+};
+
+// Holds the last queried identity until it's invalidated (session change notification) or expires
+class sessionCache
+{
+public:
+	static sessionCache* Get();
+
+	// A lifetime of 0 keeps the identity until Invalidate is called
+	void SetProvider(sessionIdentityProvider* provider, uint64_t ttlMs);
+	void SetTtl(uint64_t ttlMs);
+
+	// Never returns NULL, an empty identity (SESSION_NONE) is returned if the provider failed
+	std::shared_ptr<const sessionIdentity> Current();
+	void Invalidate();
+
+	uint64_t GetQueryCount();
+
+private:
+	sessionCache();
+
+	std::mutex _mutex;
+	sessionIdentityProvider* _provider;
+	std::shared_ptr<const sessionIdentity> _identity;
+	bool _valid;
+	int64_t _fetchedUs;
+	uint64_t _ttlUs;
+	uint64_t _queries;
+};
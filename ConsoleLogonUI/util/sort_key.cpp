@@ -0,0 +1,34 @@
+#pragma once
+#include "sort_key.h"
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+std::vector<uint8_t> GetCodeUnitSortKey(const std::wstring& text)
+{
+	// Little-endian bytes would let the low byte decide, e.g. U+00FF after U+0100
+	std::vector<uint8_t> key;
+	key.reserve(text.length() * 2);
+	for (wchar_t ch : text)
+	{
+		uint16_t unit = (uint16_t)ch;
+		key.push_back((uint8_t)(unit >> 8));
+		key.push_back((uint8_t)unit);
+	}
+	return key;
+}
+
+#ifdef _WIN32
+std::vector<uint8_t> GetSortKey(const std::wstring& text)
+{
+	const DWORD dwFlags = LCMAP_SORTKEY | LINGUISTIC_IGNORECASE | SORT_DIGITSASNUMBERS;
+	int cbKey = LCMapStringEx(LOCALE_NAME_USER_DEFAULT, dwFlags, text.c_str(), (int)text.length(), NULL, 0, NULL, NULL, 0);
+	std::vector<uint8_t> key(cbKey > 0 ? cbKey : 0);
+	if (cbKey <= 0 || !LCMapStringEx(LOCALE_NAME_USER_DEFAULT, dwFlags, text.c_str(), (int)text.length(), (LPWSTR)key.data(), cbKey, NULL, NULL, 0))
+	{
+		// Not locale aware, but at least consistent
+		return GetCodeUnitSortKey(text);
+	}
+	return key;
+}
+#endif
@@ -0,0 +1,13 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Sort keys for names, compare the keys instead of the strings when sorting
+// Built into both ConsoleLogonUI and ConsoleLogonHook so the user list sorts the same on either side
+
+// LCMapStringEx key in the user's locale: case insensitive with digits compared as numbers, like Explorer sorts names
+// Falls back to GetCodeUnitSortKey when the locale can't make one (Windows only)
+std::vector<uint8_t> GetSortKey(const std::wstring& text);
+// Each UTF-16 code unit big-endian, so comparing the bytes compares the code units
+std::vector<uint8_t> GetCodeUnitSortKey(const std::wstring& text);
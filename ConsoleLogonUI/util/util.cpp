@@ -4,18 +4,20 @@
 #include <wtsapi32.h>
 #include <sddl.h>
 #include "winsta.h"
+#include "session_cache.h"
+#include "config_store.h"
+#include "color_scheme.h"
+#include <algorithm>
+#include <mutex>
 
 #pragma comment(lib, "wtsapi32.lib")
 
+#define CONFIG_KEY L"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Authentication\\LogonUI\\CLH_GINA"
+
 // Some functions are from https://github.com/aubymori/XPLogonUI/blob/f75e9e06f8266ddb92218fabf3cdd7b386233b30/XPLogonUI/util.cpp#L96
 
-DWORD GetLoggedOnUserInfo(LPWSTR lpUsername, UINT cchUsernameMax, LPWSTR lpDomain, UINT cchDomainMax)
+static DWORD QueryLoggedOnUserInfo(LPWSTR lpUsername, UINT cchUsernameMax, LPWSTR lpDomain, UINT cchDomainMax)
 {
-	if ((!lpUsername && !lpDomain)
-		|| (lpUsername && !cchUsernameMax)
-		|| (lpDomain && !cchDomainMax))
-		return -1;
-
 	DWORD sessionId = 0;
 	WTS_SESSION_INFOW* sessions = nullptr;
 	DWORD sessionCount = 0;
@@ -62,6 +64,113 @@ DWORD GetLoggedOnUserInfo(LPWSTR lpUsername, UINT cchUsernameMax, LPWSTR lpDomai
 	return sessionId;
 }
 
+static uint64_t QueryLogonTime()
+{
+	static HMODULE hWinsta = LoadLibraryW(L"winsta.dll");
+
+	static PWINSTATIONQUERYINFORMATIONW WinStationQueryInformationW
+		= (PWINSTATIONQUERYINFORMATIONW)GetProcAddress(hWinsta, "WinStationQueryInformationW");
+	if (!WinStationQueryInformationW)
+	{
+		dbgprintf(L"Failed to get address of WinStationQueryInformationW");
+		return 0;
+	}
+
+	WINSTATIONINFORMATIONPRIVATEW wsinfo;
+	ULONG dummy;
+	if (!WinStationQueryInformationW(SERVERNAME_CURRENT, LOGONID_CURRENT, WinStationInformation, &wsinfo, sizeof(wsinfo), &dummy))
+	{
+		dbgprintf(L"WinStationQueryInformationW failed");
+		return 0;
+	}
+
+	return ((uint64_t)(DWORD)wsinfo.LogonTime.HighPart << 32) | wsinfo.LogonTime.LowPart;
+}
+
+class wtsSessionIdentityProvider : public sessionIdentityProvider
+{
+public:
+	bool Query(sessionIdentity& identity) override
+	{
+		WCHAR szUserName[256] = L"", szDomainName[256] = L"";
+		DWORD sessionId = QueryLoggedOnUserInfo(szUserName, 256, szDomainName, 256);
+		if (sessionId == (DWORD)-1)
+			return false;
+
+		identity.sessionId = sessionId;
+		identity.userName = szUserName;
+		identity.domainName = szDomainName;
+		if (!identity.IsSystemUser())
+		{
+			WCHAR szSid[256];
+			if (GetUserSid(szUserName, szSid, 256))
+				identity.sid = szSid;
+		}
+		identity.logonTime = QueryLogonTime();
+		return true;
+	}
+};
+
+static LRESULT CALLBACK SessionNotifyWndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+	if (uMsg == WM_WTSSESSION_CHANGE)
+	{
+		sessionCache::Get()->Invalidate();
+		return 0;
+	}
+	return DefWindowProcW(hWnd, uMsg, wParam, lParam);
+}
+
+void InitSessionCache(void)
+{
+	static wtsSessionIdentityProvider provider;
+	// Short lifetime until we get session change notifications
+	sessionCache::Get()->SetProvider(&provider, 1000);
+
+	std::thread([] {
+		WNDCLASSW wc = { 0 };
+		wc.lpfnWndProc = SessionNotifyWndProc;
+		wc.hInstance = ginaManager::Get()->hInstance;
+		wc.lpszClassName = L"CLH_GINA_SessionNotify";
+		RegisterClassW(&wc);
+
+		HWND hWnd = CreateWindowExW(0, wc.lpszClassName, NULL, 0, 0, 0, 0, 0, HWND_MESSAGE, NULL, wc.hInstance, NULL);
+		if (!hWnd || !WTSRegisterSessionNotification(hWnd, NOTIFY_FOR_ALL_SESSIONS))
+		{
+			dbgprintf(L"CLH_GINA: Session change notifications unavailable, identity is refreshed every second");
+			return;
+		}
+
+		// Notifications drive the refresh from now on, the long lifetime is only a backstop
+		sessionCache::Get()->SetTtl(10000);
+		sessionCache::Get()->Invalidate();
+
+		MSG msg;
+		while (GetMessageW(&msg, NULL, 0, 0))
+		{
+			DispatchMessageW(&msg);
+		}
+	}).detach();
+}
+
+DWORD GetLoggedOnUserInfo(LPWSTR lpUsername, UINT cchUsernameMax, LPWSTR lpDomain, UINT cchDomainMax)
+{
+	if ((!lpUsername && !lpDomain)
+		|| (lpUsername && !cchUsernameMax)
+		|| (lpDomain && !cchDomainMax))
+		return -1;
+
+	std::shared_ptr<const sessionIdentity> identity = sessionCache::Get()->Current();
+	if (identity->sessionId == SESSION_NONE)
+		return -1;
+
+	if (lpUsername)
+		wcscpy_s(lpUsername, cchUsernameMax, identity->userName.c_str());
+	if (lpDomain)
+		wcscpy_s(lpDomain, cchDomainMax, identity->domainName.c_str());
+	return identity->sessionId;
+}
+
 int GetLastLogonUser(LPWSTR lpUsername, UINT cchUsernameMax)
 {
     HKEY hKey;
@@ -87,72 +196,158 @@ int GetLastLogonUser(LPWSTR lpUsername, UINT cchUsernameMax)
     return 0;
 }
 
-int GetConfigInt(LPCWSTR lpValueName, int defaultValue)
+class regConfigBackend : public configBackend
 {
-	HKEY hKey;
-	if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, L"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Authentication\\LogonUI\\CLH_GINA", 0, KEY_READ, &hKey) != ERROR_SUCCESS)
-		return defaultValue;
+public:
+	bool Load(configSnapshot& snapshot) override
+	{
+		HKEY hKey;
+		LSTATUS status = RegOpenKeyExW(HKEY_LOCAL_MACHINE, CONFIG_KEY, 0, KEY_READ, &hKey);
+		if (status == ERROR_FILE_NOT_FOUND)
+			return true; // Nothing configured, everything is default
+		if (status != ERROR_SUCCESS)
+			return false;
+
+		DWORD cchMaxName = 0, cbMaxData = 0;
+		if (RegQueryInfoKeyW(hKey, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &cchMaxName, &cbMaxData, NULL, NULL) != ERROR_SUCCESS)
+		{
+			RegCloseKey(hKey);
+			return false;
+		}
 
-	DWORD dwType, dwData, dwSize = sizeof(dwData);
-	if (RegQueryValueExW(hKey, lpValueName, NULL, &dwType, (LPBYTE)&dwData, &dwSize) != ERROR_SUCCESS)
+		std::vector<WCHAR> name(cchMaxName + 1);
+		std::vector<BYTE> data(cbMaxData + sizeof(WCHAR));
+		for (DWORD i = 0; ; i++)
+		{
+			DWORD cchName = (DWORD)name.size(), cbData = (DWORD)data.size() - sizeof(WCHAR), dwType;
+			status = RegEnumValueW(hKey, i, name.data(), &cchName, NULL, &dwType, data.data(), &cbData);
+			if (status == ERROR_NO_MORE_ITEMS)
+				break;
+			if (status != ERROR_SUCCESS)
+				continue; // Grew since RegQueryInfoKey, the change notification brings it in
+
+			configValue value;
+			if (dwType == REG_DWORD && cbData == sizeof(DWORD))
+			{
+				value.type = CT_DWORD;
+				value.dword = *(DWORD*)data.data();
+			}
+			else if (dwType == REG_SZ || dwType == REG_EXPAND_SZ)
+			{
+				// Not necessarily terminated in the registry
+				data[cbData] = 0;
+				data[cbData + 1] = 0;
+				value.type = CT_STRING;
+				value.string = (LPCWSTR)data.data();
+			}
+			else
+			{
+				continue;
+			}
+			snapshot.Set(std::wstring(name.data(), cchName), value);
+		}
+
+		RegCloseKey(hKey);
+		return true;
+	}
+
+	bool WriteInt(const wchar_t* name, uint32_t value) override
 	{
+		HKEY hKey;
+		DWORD dwDisposition;
+		if (RegCreateKeyExW(
+			HKEY_LOCAL_MACHINE,
+			CONFIG_KEY,
+			0,
+			NULL,
+			REG_OPTION_NON_VOLATILE,
+			KEY_WRITE,
+			NULL,
+			&hKey,
+			&dwDisposition) != ERROR_SUCCESS)
+		{
+			return false;
+		}
+
+		LSTATUS status = RegSetValueExW(hKey, name, 0, REG_DWORD, (LPBYTE)&value, sizeof(value));
 		RegCloseKey(hKey);
-		return defaultValue;
+		return status == ERROR_SUCCESS;
 	}
+};
 
-	RegCloseKey(hKey);
-	return dwData;
+void InitConfigStore(void)
+{
+	static regConfigBackend backend;
+	configStore::Get()->SetBackend(&backend);
+
+	std::thread([] {
+		HKEY hKey;
+		HANDLE hEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+		// Created if it isn't there yet, so values added to a fresh install still get picked up
+		if (!hEvent || RegCreateKeyExW(HKEY_LOCAL_MACHINE, CONFIG_KEY, 0, NULL, 0, KEY_NOTIFY, NULL, &hKey, NULL) != ERROR_SUCCESS)
+		{
+			dbgprintf(L"CLH_GINA: Can't watch the config key, changes apply after a restart");
+			if (hEvent)
+				CloseHandle(hEvent);
+			return;
+		}
+
+		// Registered before every reload so that nothing written in between is missed
+		while (RegNotifyChangeKeyValue(hKey, FALSE, REG_NOTIFY_CHANGE_LAST_SET, hEvent, TRUE) == ERROR_SUCCESS
+			&& WaitForSingleObject(hEvent, INFINITE) == WAIT_OBJECT_0)
+		{
+			configStore::Get()->Reload();
+			dbgprintf(L"CLH_GINA: Config changed, %d values loaded (%llu loads, %llu writes so far)", (int)configStore::Get()->Current()->Count(),
+				configStore::Get()->GetLoadCount(), configStore::Get()->GetWriteCount());
+		}
+
+		RegCloseKey(hKey);
+		CloseHandle(hEvent);
+	}).detach();
+}
+
+int GetConfigInt(LPCWSTR lpValueName, int defaultValue)
+{
+	int value;
+	if (!configStore::Get()->Current()->GetInt(lpValueName, &value))
+		return defaultValue;
+	return value;
 }
 
 bool SetConfigInt(LPCWSTR lpValueName, int value)
 {
-	HKEY hKey;
-	DWORD dwDisposition;
-	if (RegCreateKeyExW(
-		HKEY_LOCAL_MACHINE,
-		L"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Authentication\\LogonUI\\CLH_GINA",
-		0,
-		NULL,
-		REG_OPTION_NON_VOLATILE,
-		KEY_WRITE,
-		NULL,
-		&hKey,
-		&dwDisposition) != ERROR_SUCCESS)
-	{
-		return false;
-	}
+	return configStore::Get()->SetInt(lpValueName, value);
+}
 
-	if (RegSetValueExW(hKey, lpValueName, 0, REG_DWORD, (LPBYTE)&value, sizeof(value)) != ERROR_SUCCESS)
-	{
-		RegCloseKey(hKey);
-		return false;
-	}
+void SetConfigIntLater(LPCWSTR lpValueName, int value)
+{
+	configStore::Get()->SetIntLater(lpValueName, value);
+}
 
-	RegCloseKey(hKey);
-	return true;
+void FlushConfig(void)
+{
+	configStore::Get()->Flush();
 }
 
 bool GetConfigString(LPCWSTR lpValueName, LPWSTR lpBuffer, DWORD dwBufferSize, LPCWSTR lpDefaultValue)
 {
 	if (!lpBuffer || !dwBufferSize)
 		return false;
-	HKEY hKey;
-	if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, L"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Authentication\\LogonUI\\CLH_GINA", 0, KEY_READ, &hKey) != ERROR_SUCCESS)
-		return false;
-	DWORD dwType, dwSize = dwBufferSize;
-	if (RegQueryValueExW(hKey, lpValueName, NULL, &dwType, (LPBYTE)lpBuffer, &dwSize) != ERROR_SUCCESS)
+
+	// dwBufferSize is in characters, every caller passes a WCHAR array's length
+	std::wstring value;
+	if (configStore::Get()->Current()->GetString(lpValueName, &value) && value.length() < dwBufferSize)
 	{
-		if (lpDefaultValue)
-		{
-			wcscpy_s(lpBuffer, dwBufferSize, lpDefaultValue);
-			RegCloseKey(hKey);
-			return true;
-		}
-		RegCloseKey(hKey);
-		return false;
+		wcscpy_s(lpBuffer, dwBufferSize, value.c_str());
+		return true;
 	}
-	RegCloseKey(hKey);
-	return true;
+
+	if (lpDefaultValue)
+	{
+		wcscpy_s(lpBuffer, dwBufferSize, lpDefaultValue);
+		return true;
+	}
+	return false;
 }
 
 bool GetUserLogonTime(LPSYSTEMTIME lpSystemTime)
@@ -160,28 +355,14 @@ bool GetUserLogonTime(LPSYSTEMTIME lpSystemTime)
 	if (!lpSystemTime)
 		return false;
 
-	static HMODULE hWinsta = LoadLibraryW(L"winsta.dll");
-
-	static PWINSTATIONQUERYINFORMATIONW WinStationQueryInformationW
-		= (PWINSTATIONQUERYINFORMATIONW)GetProcAddress(hWinsta, "WinStationQueryInformationW");
-	if (!WinStationQueryInformationW)
-	{
-		//dbgprintf(L"Failed to get address of WinStationQueryInformationW");
+	uint64_t ticks = sessionCache::Get()->Current()->logonTime;
+	if (!ticks)
 		return false;
-	}
-
-	WINSTATIONINFORMATIONPRIVATEW wsinfo;
-	ULONG dummy;
-	if (!WinStationQueryInformationW(SERVERNAME_CURRENT, LOGONID_CURRENT, WinStationInformation, &wsinfo, sizeof(wsinfo), &dummy))
-	{
-		//dbgprintf(L"WinStationQueryInformationW failed");
-		return false;
-	}
 
 	FILETIME logonTime;
 	SYSTEMTIME universalTime;
-	logonTime.dwLowDateTime = wsinfo.LogonTime.LowPart;
-	logonTime.dwHighDateTime = wsinfo.LogonTime.HighPart;
+	logonTime.dwLowDateTime = (DWORD)ticks;
+	logonTime.dwHighDateTime = (DWORD)(ticks >> 32);
 	FileTimeToSystemTime(&logonTime, &universalTime);
 	SystemTimeToTzSpecificLocalTime(nullptr, &universalTime, lpSystemTime);
 	return true;
@@ -189,10 +370,7 @@ bool GetUserLogonTime(LPSYSTEMTIME lpSystemTime)
 
 bool IsSystemUser(void)
 {
-	WCHAR szDomainName[256], szUserName[256];
-	if (!GetLoggedOnUserInfo(szUserName, 256, szDomainName, 256))
-		return true;
-	return !szUserName[0] && !szDomainName[0];
+	return sessionCache::Get()->Current()->IsSystemUser();
 }
 
 bool IsFriendlyLogonUI(void)
@@ -221,6 +399,26 @@ bool IsFriendlyLogonUI(void)
 	return dwResult == 0;
 }
 
+int GetWindowDpi(HWND hWnd)
+{
+	// GetDpiForWindow is Windows 10 1607+
+	typedef UINT(WINAPI* lpGetDpiForWindow)(HWND hwnd);
+	static lpGetDpiForWindow GetDpiForWindowW10
+		= (lpGetDpiForWindow)GetProcAddress(GetModuleHandleW(L"user32.dll"), "GetDpiForWindow");
+
+	if (GetDpiForWindowW10 && hWnd)
+	{
+		UINT dpi = GetDpiForWindowW10(hWnd);
+		if (dpi)
+			return (int)dpi;
+	}
+
+	HDC hdc = GetDC(NULL);
+	int dpi = GetDeviceCaps(hdc, LOGPIXELSY);
+	ReleaseDC(NULL, hdc);
+	return dpi;
+}
+
 bool GetUserSid(LPCWSTR lpUsername, LPWSTR lpSid, DWORD dwSidSize)
 {
 	if (!lpUsername || !lpSid || !dwSidSize)
@@ -311,20 +509,64 @@ LSTATUS GetUserRegHive(REGSAM samDesired, PHKEY phkResult)
 {
 	if (!phkResult)
 		return ERROR_INVALID_PARAMETER;
-	if (IsSystemUser())
+	std::shared_ptr<const sessionIdentity> identity = sessionCache::Get()->Current();
+	if (identity->IsSystemUser())
 		return RegOpenKeyExW(HKEY_CURRENT_USER, NULL, 0, samDesired, phkResult);
-	WCHAR lpUsername[256], szSid[256];
-	if (!GetLoggedOnUserInfo(lpUsername, 256, NULL, 0))
+	if (identity->sid.empty())
 		return ERROR_INVALID_PARAMETER;
-	if (!GetUserSid(lpUsername, szSid, 256))
-		return ERROR_INVALID_PARAMETER;
-	return RegOpenKeyExW(HKEY_USERS, szSid, 0, samDesired, phkResult);
+	return RegOpenKeyExW(HKEY_USERS, identity->sid.c_str(), 0, samDesired, phkResult);
+}
+
+struct cachedColorScheme
+{
+	std::wstring sid; // Empty for SYSTEM
+	FILETIME lastWrite;
+	colorScheme scheme;
+};
+
+static std::mutex g_colorSchemeMutex;
+static std::vector<cachedColorScheme> g_colorSchemes;
+
+static void ReadColorScheme(HKEY hKey, colorScheme* pScheme)
+{
+	*pScheme = { 0 };
+
+	WCHAR szName[64];
+	WCHAR szData[64];
+	for (DWORD i = 0; ; i++)
+	{
+		DWORD cchName = ARRAYSIZE(szName), cbData = sizeof(szData), dwType;
+		LSTATUS status = RegEnumValueW(hKey, i, szName, &cchName, NULL, &dwType, (LPBYTE)szData, &cbData);
+		if (status == ERROR_NO_MORE_ITEMS)
+			break;
+		// Too long to be a color or a name we know
+		if (status != ERROR_SUCCESS)
+			continue;
+
+		int index = ColorSchemeIndex(szName, cchName);
+		if (index < 0)
+			continue;
+
+		uint32_t color;
+		if (dwType == REG_SZ && ParseColorTriplet(szData, cbData / sizeof(WCHAR), &color))
+		{
+			pScheme->colors[index] = color;
+			pScheme->present |= 1u << index;
+		}
+		else
+		{
+			pScheme->invalid++;
+		}
+	}
 }
 
 // Apply colors from current session owner's registry to the system
 // No WindowMetrics support yet
 void ApplyUserColors()
 {
+	std::shared_ptr<const sessionIdentity> identity = sessionCache::Get()->Current();
+	std::wstring sid = identity->IsSystemUser() ? L"" : identity->sid;
+
 	HKEY hive;
 	if (GetUserRegHive(KEY_READ, &hive) != ERROR_SUCCESS)
 		return;
@@ -335,105 +577,66 @@ void ApplyUserColors()
 		return;
 	}
 
-	int aElements[30] =
-	{
-		COLOR_SCROLLBAR,
-		COLOR_BACKGROUND,
-		COLOR_ACTIVECAPTION,
-		COLOR_INACTIVECAPTION,
-		COLOR_MENU,
-		COLOR_WINDOW,
-		COLOR_WINDOWFRAME,
-		COLOR_MENUTEXT,
-		COLOR_WINDOWTEXT,
-		COLOR_CAPTIONTEXT,
-		COLOR_ACTIVEBORDER,
-		COLOR_INACTIVEBORDER,
-		COLOR_APPWORKSPACE,
-		COLOR_HIGHLIGHT,
-		COLOR_HIGHLIGHTTEXT,
-		COLOR_BTNFACE,
-		COLOR_BTNSHADOW,
-		COLOR_GRAYTEXT,
-		COLOR_BTNTEXT,
-		COLOR_INACTIVECAPTIONTEXT,
-		COLOR_BTNHIGHLIGHT,
-		COLOR_3DDKSHADOW,
-		COLOR_3DLIGHT,
-		COLOR_INFOTEXT,
-		COLOR_INFOBK,
-		// 25: Probably ButtonAlternateFace but it's somehow missing in winuser.h. It's rarely used anyway.
-		COLOR_HOTLIGHT,
-		COLOR_GRADIENTACTIVECAPTION,
-		COLOR_GRADIENTINACTIVECAPTION,
-		COLOR_MENUHILIGHT,
-		COLOR_MENUBAR
-	};
-
-	wchar_t regMap[30][25] =
+	// The parsed scheme is good for as long as the key hasn't been written
+	FILETIME lastWrite = { 0 };
+	RegQueryInfoKeyW(hKey, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, &lastWrite);
+
+	colorScheme scheme;
+	bool fCached = false;
 	{
-		L"Scrollbar",
-		L"Background",
-		L"ActiveTitle",
-		L"InactiveTitle",
-		L"Menu",
-		L"Window",
-		L"WindowFrame",
-		L"MenuText",
-		L"WindowText",
-		L"TitleText",
-		L"ActiveBorder",
-		L"InactiveBorder",
-		L"AppWorkspace",
-		L"Hilight",
-		L"HilightText",
-		L"ButtonFace",
-		L"ButtonShadow",
-		L"GrayText",
-		L"ButtonText",
-		L"InactiveTitleText",
-		L"ButtonHilight",
-		L"ButtonDkShadow",
-		L"ButtonLight",
-		L"InfoText",
-		L"InfoWindow",
-		// L"ButtonAlternateFace",
-		L"HotTrackingColor",
-		L"GradientActiveTitle",
-		L"GradientInactiveTitle",
-		L"MenuHilight",
-		L"MenuBar"
-	};
-
-	DWORD aNewColors[30];
-
-	for (int i = 0; i < 30; i++)
+		std::lock_guard<std::mutex> lock(g_colorSchemeMutex);
+		for (const cachedColorScheme& cached : g_colorSchemes)
+		{
+			if (cached.sid == sid && CompareFileTime(&cached.lastWrite, &lastWrite) == 0)
+			{
+				scheme = cached.scheme;
+				fCached = true;
+				break;
+			}
+		}
+	}
+
+	if (!fCached)
 	{
-		wchar_t szData[256];
-		DWORD cbData = sizeof(szData);
-		if (RegQueryValueExW(hKey, regMap[i], NULL, NULL, (LPBYTE)&szData, &cbData) != ERROR_SUCCESS)
+		ReadColorScheme(hKey, &scheme);
+
+		std::lock_guard<std::mutex> lock(g_colorSchemeMutex);
+		auto it = std::find_if(g_colorSchemes.begin(), g_colorSchemes.end(),
+			[&sid](const cachedColorScheme& cached) { return cached.sid == sid; });
+		if (it != g_colorSchemes.end())
 		{
-			RegCloseKey(hKey);
-			RegCloseKey(hive);
-			wchar_t msg[256];
-			wsprintfW(msg, L"Failed to read value %s %d", regMap[i], i);
-			MessageBoxW(0, msg, L"Error", MB_OK | MB_ICONERROR);
-			return;
+			it->lastWrite = lastWrite;
+			it->scheme = scheme;
 		}
-		int r, g, b;
-		if (swscanf_s(szData, L"%d %d %d", &r, &g, &b) != 3)
+		else
 		{
-			RegCloseKey(hKey);
-			RegCloseKey(hive);
-			return;
+			g_colorSchemes.push_back({ sid, lastWrite, scheme });
 		}
-		aNewColors[i] = RGB(r, g, b);
 	}
 
 	RegCloseKey(hKey);
 	RegCloseKey(hive);
 
-	SetSysColors(30, aElements, aNewColors);
+	if (scheme.invalid)
+	{
+		dbgprintf(L"CLH_GINA: Skipped %d unreadable colors of %ls", scheme.invalid, sid.empty() ? L"SYSTEM" : sid.c_str());
+	}
+
+	// SetSysColors repaints every window in the session, even for colors that didn't change
+	uint32_t aCurrentColors[COLOR_SCHEME_COUNT];
+	for (int i = 0; i < COLOR_SCHEME_COUNT; i++)
+	{
+		aCurrentColors[i] = GetSysColor(ColorSchemeElement(i));
+	}
+
+	int aElements[COLOR_SCHEME_COUNT];
+	uint32_t aNewColors[COLOR_SCHEME_COUNT];
+	int count = DiffColorScheme(scheme, aCurrentColors, aElements, aNewColors);
+	dbgprintf(L"CLH_GINA: %d system colors differ from %ls%ls", count, sid.empty() ? L"SYSTEM" : sid.c_str(), fCached ? L" (cached)" : L"");
+	if (count)
+	{
+		SetSysColors(count, aElements, (const COLORREF*)aNewColors);
+	}
 }
 
 void EmergencyRestart()
@@ -70,6 +70,17 @@ static std::vector<std::wstring> split(std::wstring s, std::wstring delimiter)
     return res;
 }
 
+// Ends up in the hook's log, it redirects OutputDebugStringW
+static void dbgprintf(const wchar_t* format, ...)
+{
+	wchar_t buffer[1024];
+	va_list args;
+	va_start(args, format);
+	vswprintf_s(buffer, format, args);
+	va_end(args);
+	OutputDebugStringW(buffer);
+}
+
 static void CenterWindow(HWND hWnd)
 {
 	RECT rc;
@@ -131,14 +142,20 @@ static void MakeWindowClassicAsync(const wchar_t* title)
 	}).detach();
 }
 
+void InitSessionCache(void);
+void InitConfigStore(void);
 DWORD GetLoggedOnUserInfo(LPWSTR lpUsername, UINT cchUsernameMax, LPWSTR lpDomain, UINT cchDomainMax);
 int GetLastLogonUser(LPWSTR lpUsername, UINT cchUsernameMax);
 bool GetUserLogonTime(LPSYSTEMTIME lpSystemTime);
 int GetConfigInt(LPCWSTR lpValueName, int defaultValue);
 bool SetConfigInt(LPCWSTR lpValueName, int value);
+// For UI state, visible to GetConfigInt right away and written to the registry in the background
+void SetConfigIntLater(LPCWSTR lpValueName, int value);
+void FlushConfig(void);
 bool GetConfigString(LPCWSTR lpValueName, LPWSTR lpBuffer, DWORD dwBufferSize, LPCWSTR lpDefaultValue = NULL);
 bool IsSystemUser(void);
 bool IsFriendlyLogonUI(void);
+int GetWindowDpi(HWND hWnd);
 bool GetUserSid(LPCWSTR lpUsername, LPWSTR lpSid, DWORD dwSidSize);
 bool GetUserHomeDir(LPWSTR lpUsername, LPWSTR lpHomeDir, DWORD dwHomeDirSize);
 LSTATUS GetUserRegHive(REGSAM samDesired = KEY_READ, PHKEY phkResult = NULL);
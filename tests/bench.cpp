@@ -0,0 +1,252 @@
+#include "fake_config.h"
+#include "images.h"
+#include "ui/gina_userlist.h"
+#include "ui/gina_viewstate.h"
+#include "ui/wallcompose.h"
+#include "util/color_scheme.h"
+#include "util/dlg_template.h"
+#include "util/pe_resources.h"
+#include <algorithm>
+#include <chrono>
+#include <cwctype>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+// Timings for the hot paths of the portable code, clh_bench [name] only runs benchmarks starting with name
+// Prints the best of a few runs, which is what the wallpaper and dialog paths pay on an idle machine
+
+struct benchmark
+{
+	const char* name;
+	int runs;
+	std::function<void()> pfn;
+	// Operations one call does, for the ones reported as a rate as well
+	int ops;
+	// Also report the process's peak resident set and how much this benchmark raised it
+	bool fPeakRss;
+};
+
+static std::vector<benchmark>& GetBenchmarks()
+{
+	static std::vector<benchmark> benchmarks;
+	return benchmarks;
+}
+
+static void AddBenchmark(const char* name, int runs, std::function<void()> pfn, int ops = 0, bool fPeakRss = false)
+{
+	GetBenchmarks().push_back({ name, runs, pfn, ops, fPeakRss });
+}
+
+// Peak resident set of the process so far in KiB, 0 where getrusage isn't there
+static long GetPeakRssKb()
+{
+#ifndef _WIN32
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+#ifdef __APPLE__
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+#endif
+	return 0;
+}
+
+static void AddResampleBenchmarks()
+{
+	static std::vector<uint8_t> src((size_t)6000 * 4000 * 4), dst((size_t)1920 * 1080 * 4);
+	for (size_t i = 0; i < src.size(); i++)
+		src[i] = (uint8_t)(i * 7);
+	static imageView srcView = { src.data(), 6000, 4000, 6000 * 4 };
+	static imageView dstView = { dst.data(), 1920, 1080, 1920 * 4 };
+
+	AddBenchmark("resample_lanczos_1thread", 3, [] { Resample(srcView, dstView, 0, 0, 1920, 1080, RF_LANCZOS3, 1); });
+	AddBenchmark("resample_lanczos", 5, [] { Resample(srcView, dstView, 0, 0, 1920, 1080, RF_LANCZOS3); });
+	AddBenchmark("resample_box", 5, [] { Resample(srcView, dstView, 0, 0, 1920, 1080, RF_BOX); });
+}
+
+static void AddComposeBenchmarks()
+{
+	static std::vector<uint8_t> image((size_t)1920 * 1200 * 4, 0x80), frame((size_t)3200 * 1200 * 4);
+	static imageView imageView_ = { image.data(), 1920, 1200, 1920 * 4 };
+	static imageView frameView = { frame.data(), 3200, 1200, 3200 * 4 };
+	static wallpaperMonitor monitors[2] = { { 1280, 120, 1920, 1080 }, { 0, 0, 1280, 1024 } };
+
+	AddBenchmark("compose_fill", 5, [] { ComposeWallpaper(imageView_, frameView, WP_STYLE_FILL, 0); });
+	AddBenchmark("compose_monitors_fill", 5, [] { ComposeWallpaperMonitors(imageView_, frameView, WP_STYLE_FILL, 0, monitors, 2); });
+	AddBenchmark("compose_tile", 5, [] { ComposeWallpaper({ image.data(), 64, 64, 1920 * 4 }, frameView, WP_STYLE_TILE, 0); });
+
+	// A 24 megapixel photo filled onto two 4K monitors side by side, the largest frame wallHost builds in practice.
+	// The buffers are only allocated on the first run so the peak RSS it reports is its own and not the other benchmarks'
+	AddBenchmark("compose_4k_monitors_fill", 3, [] {
+		static std::vector<uint8_t> photo((size_t)6000 * 4000 * 4, 0x80), frame4k((size_t)7680 * 2160 * 4);
+		static wallpaperMonitor monitors4k[2] = { { 0, 0, 3840, 2160 }, { 3840, 0, 3840, 2160 } };
+		ComposeWallpaperMonitors({ photo.data(), 6000, 4000, 6000 * 4 }, { frame4k.data(), 7680, 2160, 7680 * 4 }, WP_STYLE_FILL, 0, monitors4k, 2);
+	}, 0, true);
+}
+
+static void AddParserBenchmarks()
+{
+	// Roughly the resource count of an XP msgina.dll
+	static std::vector<uint8_t> image;
+	std::vector<imageResource> resources;
+	resources.push_back({ PE_RT_VERSION, 1, 1033, BuildVersionResource(0x00050001, 0x0A280000) });
+	for (uint16_t id = 1; id <= 120; id++)
+		resources.push_back({ PE_RT_STRING, id, 1033, BuildStringBlock({ { 0, u"Log On to Windows" }, { 7, u"Shut Down Windows" } }) });
+	for (uint16_t id = 1500; id < 1540; id++)
+		resources.push_back({ PE_RT_DIALOG, id, 1033, std::vector<uint8_t>(600, 0) });
+	image = BuildPeImage(resources);
+
+	static std::vector<uint8_t> dialog;
+	dlgWriter w;
+	w.Header(0x80C800C0, 24, 0, 0, 260, 160, "Log On to Windows");
+	for (uint16_t i = 0; i < 24; i++)
+		w.Item(1500 + i, DLG_CLASS_STATIC, 0x50000000, 7, 10 + i * 6, 100, 8, "Label text");
+	dialog = w.data;
+
+	AddBenchmark("pe_open", 2000, [] {
+		peResources res;
+		res.Open(image.data(), image.size(), false);
+	});
+	AddBenchmark("dlg_parse_layout", 20000, [] {
+		dlgTemplate t;
+		ParseDialogTemplate(dialog.data(), dialog.size(), &t);
+		dlgLayout layout;
+		layout.Load(t, 6, 13, 390, 260);
+		layout.OffsetBelow(60, 20, 0);
+	});
+	AddBenchmark("color_triplet", 200000, [] {
+		uint32_t color;
+		ParseColorTriplet(L"212 208 200", 12, &color);
+	});
+}
+
+static void AddViewStateBenchmarks()
+{
+	// The user list handing over to the credential view and that closing again, two transitions per call
+	AddBenchmark("viewstate_transitions", 200000, [] {
+		ginaViewState* state = ginaViewState::Get();
+		state->Enter(GV_USERSELECT);
+		state->Shown(GV_USERSELECT);
+		state->Enter(GV_SELECTEDCREDENTIAL);
+		state->Leave(GV_USERSELECT);
+		state->Shown(GV_SELECTEDCREDENTIAL);
+		state->Leave(GV_SELECTEDCREDENTIAL);
+	}, 2);
+}
+
+// Case insensitive code unit key, about what LCMapStringEx hands back for a plain ASCII name
+static std::vector<uint8_t> UserNameKey(const std::wstring& text)
+{
+	std::vector<uint8_t> key;
+	key.reserve(text.length() * 2);
+	for (wchar_t ch : text)
+	{
+		uint16_t unit = (uint16_t)std::towlower(ch);
+		key.push_back((uint8_t)(unit >> 8));
+		key.push_back((uint8_t)unit);
+	}
+	return key;
+}
+
+static void AddUserListBenchmarks()
+{
+	// From a single user to a shared PC or a lab joined to a big domain, names in the order the hook created them
+	static const int counts[] = { 10, 100, 1000, 5000 };
+	static std::vector<userListEntry> lists[4];
+	static std::string names[4];
+	uint32_t seed = 1;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < counts[i]; j++)
+		{
+			seed = seed * 1103515245 + 12345;
+			lists[i].push_back({ (void*)(uintptr_t)(j + 1), (j % 3 ? L"student" : L"Staff.") + std::to_wstring(seed % 100000) });
+		}
+		names[i] = "userlist_sort_" + std::to_string(counts[i]);
+		AddBenchmark(names[i].c_str(), counts[i] > 1000 ? 50 : 500, [i] { SortUserList(lists[i], UserNameKey); }, counts[i]);
+	}
+
+	// The hook destroying a tile from the middle of the largest list
+	AddBenchmark("userlist_remove_5000", 500, [] {
+		static userList users = SortUserList(lists[3], UserNameKey);
+		RemoveFromUserList(users, (void*)(uintptr_t)2500);
+	});
+}
+
+static void AddConfigBenchmarks()
+{
+	// Roughly what a configured install has under the CLH_GINA key, read at about the cost of a registry round trip
+	static fakeConfigBackend backend;
+	for (int i = 0; i < 30; i++)
+		backend.SetInt((L"Value" + std::to_wstring(i)).c_str(), i);
+	backend.SetString(L"Background", L"58 110 165");
+	backend.latencyUs = 20;
+	configStore::Get()->SetBackend(&backend);
+	configStore::Get()->SetWriteDelay(60000);
+
+	// What every GetConfigInt cost before the store, a read of the backend per value
+	AddBenchmark("config_read_backend", 2000, [] {
+		configSnapshot snapshot;
+		backend.Load(snapshot);
+		int value;
+		snapshot.GetInt(L"Value7", &value);
+	});
+	AddBenchmark("config_current", 200000, [] {
+		int value;
+		configStore::Get()->Current()->GetInt(L"Value7", &value);
+	});
+	AddBenchmark("config_set_later", 200000, [] {
+		configStore::Get()->SetIntLater(L"ShutdownChoice", 1);
+	});
+}
+
+int main(int argc, char** argv)
+{
+	const char* prefix = argc > 1 ? argv[1] : "";
+	AddResampleBenchmarks();
+	AddComposeBenchmarks();
+	AddParserBenchmarks();
+	AddViewStateBenchmarks();
+	AddUserListBenchmarks();
+	AddConfigBenchmarks();
+
+	for (const benchmark& bench : GetBenchmarks())
+	{
+		if (strncmp(bench.name, prefix, strlen(prefix)) != 0)
+			continue;
+
+		// Runs are batched so short ones still measure in microseconds
+		int batch = bench.runs > 100 ? bench.runs / 10 : 1;
+		double bestUs = 1e300;
+		long rssBeforeKb = GetPeakRssKb();
+		for (int run = 0; run < bench.runs; run += batch)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < batch; i++)
+				bench.pfn();
+			double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / batch;
+			bestUs = std::min(bestUs, us);
+		}
+		if (bench.ops)
+			printf("%-28s %12.2f us %12.0f /s\n", bench.name, bestUs, bench.ops * 1e6 / bestUs);
+		else
+			printf("%-28s %12.2f us\n", bench.name, bestUs);
+		if (bench.fPeakRss && rssBeforeKb)
+		{
+			long rssKb = GetPeakRssKb();
+			printf("%-28s %12.1f MB peak RSS (+%.1f MB)\n", "", rssKb / 1024.0, (rssKb - rssBeforeKb) / 1024.0);
+		}
+	}
+
+	// Every read above should have shared one load, and every deferred write collapsed into one
+	configStore::Get()->Flush();
+	printf("config store: %llu loads, %llu writes\n",
+		(unsigned long long)configStore::Get()->GetLoadCount(), (unsigned long long)configStore::Get()->GetWriteCount());
+	return 0;
+}
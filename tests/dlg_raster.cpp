@@ -0,0 +1,224 @@
+#include "dlg_raster.h"
+#include <algorithm>
+
+// Classic scheme of Windows 2000 and XP, 0xRRGGBB
+#define RASTER_3DFACE 0xD4D0C8
+#define RASTER_3DHIGHLIGHT 0xFFFFFF
+#define RASTER_3DLIGHT 0xD4D0C8
+#define RASTER_3DSHADOW 0x808080
+#define RASTER_3DDKSHADOW 0x404040
+#define RASTER_WINDOW 0xFFFFFF
+#define RASTER_WINDOWTEXT 0x000000
+#define RASTER_GRAYTEXT 0x808080
+
+#define RASTER_WS_DISABLED 0x08000000u
+#define RASTER_WS_VISIBLE 0x10000000u
+
+#define RASTER_BS_TYPEMASK 0x0Fu
+#define RASTER_BS_DEFPUSHBUTTON 0x01u
+#define RASTER_BS_CHECKBOX 0x02u
+#define RASTER_BS_AUTO3STATE 0x06u
+#define RASTER_BS_GROUPBOX 0x07u
+#define RASTER_BS_AUTORADIOBUTTON 0x09u
+#define RASTER_BS_OWNERDRAW 0x0Bu
+
+#define RASTER_SS_TYPEMASK 0x1Fu
+#define RASTER_SS_ICON 0x03u
+#define RASTER_SS_BLACKRECT 0x04u
+#define RASTER_SS_WHITEFRAME 0x09u
+#define RASTER_SS_BITMAP 0x0Eu
+#define RASTER_SS_ETCHEDHORZ 0x10u
+#define RASTER_SS_ETCHEDVERT 0x11u
+#define RASTER_SS_ETCHEDFRAME 0x12u
+
+// Stand-ins for things that are sized by their contents
+#define RASTER_CHECK_SIZE 13
+#define RASTER_ICON_SIZE 32
+#define RASTER_TEXT_HEIGHT 6
+
+// Clips everything to the frame below top
+struct rasterTarget
+{
+	const imageView& frame;
+	int top;
+
+	void Fill(int x, int y, int cx, int cy, uint32_t color) const
+	{
+		int left = std::max(x, 0);
+		int right = std::min(x + cx, frame.width);
+		int upper = std::max(y, top);
+		int bottom = std::min(y + cy, frame.height);
+		for (int row = upper; row < bottom; row++)
+		{
+			uint8_t* p = frame.pixels + (size_t)row * frame.stride + (size_t)left * 4;
+			for (int col = left; col < right; col++)
+			{
+				p[0] = (uint8_t)color;
+				p[1] = (uint8_t)(color >> 8);
+				p[2] = (uint8_t)(color >> 16);
+				p[3] = 0xFF;
+				p += 4;
+			}
+		}
+	}
+
+	void Frame(int x, int y, int cx, int cy, uint32_t topLeft, uint32_t bottomRight) const
+	{
+		if (cx <= 0 || cy <= 0)
+			return;
+		Fill(x, y, cx - 1, 1, topLeft);
+		Fill(x, y, 1, cy - 1, topLeft);
+		Fill(x, y + cy - 1, cx, 1, bottomRight);
+		Fill(x + cx - 1, y, 1, cy, bottomRight);
+	}
+
+	// Two-pixel edge like DrawEdge, raised or sunken
+	void Edge(int x, int y, int cx, int cy, bool fRaised) const
+	{
+		if (fRaised)
+		{
+			Frame(x, y, cx, cy, RASTER_3DHIGHLIGHT, RASTER_3DDKSHADOW);
+			Frame(x + 1, y + 1, cx - 2, cy - 2, RASTER_3DLIGHT, RASTER_3DSHADOW);
+		}
+		else
+		{
+			Frame(x, y, cx, cy, RASTER_3DSHADOW, RASTER_3DHIGHLIGHT);
+			Frame(x + 1, y + 1, cx - 2, cy - 2, RASTER_3DDKSHADOW, RASTER_3DLIGHT);
+		}
+	}
+
+	void Etched(int x, int y, int cx, int cy) const
+	{
+		Frame(x + 1, y + 1, cx - 1, cy - 1, RASTER_3DHIGHLIGHT, RASTER_3DHIGHLIGHT);
+		Frame(x, y, cx - 1, cy - 1, RASTER_3DSHADOW, RASTER_3DSHADOW);
+	}
+
+	// A line of text, centred vertically in the given height
+	void Text(int x, int y, int cx, int cy, bool fDisabled) const
+	{
+		int height = std::min(cy, RASTER_TEXT_HEIGHT);
+		Fill(x, y + (cy - height) / 2, cx, height, fDisabled ? RASTER_GRAYTEXT : RASTER_WINDOWTEXT);
+	}
+};
+
+static void DrawButton(const rasterTarget& target, const dlgItem& item, bool fDisabled)
+{
+	uint32_t type = item.style & RASTER_BS_TYPEMASK;
+	if (type == RASTER_BS_GROUPBOX)
+	{
+		target.Etched(item.x, item.y + RASTER_TEXT_HEIGHT / 2, item.cx, item.cy - RASTER_TEXT_HEIGHT / 2);
+		target.Fill(item.x + 6, item.y, std::max(0, item.cx / 3), RASTER_TEXT_HEIGHT, RASTER_3DFACE);
+		target.Text(item.x + 8, item.y, std::max(0, item.cx / 3 - 4), RASTER_TEXT_HEIGHT, fDisabled);
+	}
+	else if ((type >= RASTER_BS_CHECKBOX && type <= RASTER_BS_AUTO3STATE) || type == RASTER_BS_AUTORADIOBUTTON)
+	{
+		int y = item.y + (item.cy - RASTER_CHECK_SIZE) / 2;
+		target.Fill(item.x, y, RASTER_CHECK_SIZE, RASTER_CHECK_SIZE, RASTER_WINDOW);
+		target.Edge(item.x, y, RASTER_CHECK_SIZE, RASTER_CHECK_SIZE, false);
+		target.Text(item.x + RASTER_CHECK_SIZE + 4, item.y, item.cx - RASTER_CHECK_SIZE - 4, item.cy, fDisabled);
+	}
+	else if (type == RASTER_BS_OWNERDRAW)
+	{
+		target.Frame(item.x, item.y, item.cx, item.cy, RASTER_3DSHADOW, RASTER_3DSHADOW);
+	}
+	else
+	{
+		int x = item.x, y = item.y, cx = item.cx, cy = item.cy;
+		if (type == RASTER_BS_DEFPUSHBUTTON)
+		{
+			target.Frame(x, y, cx, cy, RASTER_WINDOWTEXT, RASTER_WINDOWTEXT);
+			x++, y++, cx -= 2, cy -= 2;
+		}
+		target.Edge(x, y, cx, cy, true);
+		target.Text(x + cx / 4, y, cx / 2, cy, fDisabled);
+	}
+}
+
+static void DrawStatic(const rasterTarget& target, const dlgItem& item, bool fDisabled)
+{
+	uint32_t type = item.style & RASTER_SS_TYPEMASK;
+	if (type == RASTER_SS_ICON || type == RASTER_SS_BITMAP)
+	{
+		// The dialog manager sizes these to their image when the template leaves them at 0
+		int cx = item.cx ? item.cx : RASTER_ICON_SIZE;
+		int cy = item.cy ? item.cy : RASTER_ICON_SIZE;
+		target.Frame(item.x, item.y, cx, cy, RASTER_3DDKSHADOW, RASTER_3DDKSHADOW);
+	}
+	else if (type >= RASTER_SS_BLACKRECT && type <= RASTER_SS_WHITEFRAME)
+	{
+		// Black, gray and white, first as rectangles then as frames
+		static const uint32_t colors[] = { RASTER_3DDKSHADOW, RASTER_3DSHADOW, RASTER_3DHIGHLIGHT };
+		uint32_t color = colors[(type - RASTER_SS_BLACKRECT) % 3];
+		if (type - RASTER_SS_BLACKRECT < 3)
+			target.Fill(item.x, item.y, item.cx, item.cy, color);
+		else
+			target.Frame(item.x, item.y, item.cx, item.cy, color, color);
+	}
+	else if (type == RASTER_SS_ETCHEDHORZ)
+	{
+		target.Fill(item.x, item.y, item.cx, 1, RASTER_3DSHADOW);
+		target.Fill(item.x, item.y + 1, item.cx, 1, RASTER_3DHIGHLIGHT);
+	}
+	else if (type == RASTER_SS_ETCHEDVERT)
+	{
+		target.Fill(item.x, item.y, 1, item.cy, RASTER_3DSHADOW);
+		target.Fill(item.x + 1, item.y, 1, item.cy, RASTER_3DHIGHLIGHT);
+	}
+	else if (type == RASTER_SS_ETCHEDFRAME)
+	{
+		target.Etched(item.x, item.y, item.cx, item.cy);
+	}
+	else
+	{
+		target.Text(item.x, item.y, item.cx, std::min(item.cy, RASTER_TEXT_HEIGHT * 2), fDisabled);
+	}
+}
+
+bool RasterizeDialog(const dlgLayout& layout, const imageView& frame, int top)
+{
+	if (!frame.pixels || frame.width <= 0 || frame.height <= 0)
+		return false;
+
+	rasterTarget target = { frame, std::max(top, 0) };
+	target.Fill(0, 0, frame.width, frame.height, RASTER_3DFACE);
+
+	for (const dlgItem& item : layout.GetItems())
+	{
+		if (item.fHidden || !(item.style & RASTER_WS_VISIBLE))
+			continue;
+
+		bool fDisabled = (item.style & RASTER_WS_DISABLED) != 0;
+		switch (item.classAtom)
+		{
+		case DLG_CLASS_BUTTON:
+			DrawButton(target, item, fDisabled);
+			break;
+		case DLG_CLASS_STATIC:
+			DrawStatic(target, item, fDisabled);
+			break;
+		case DLG_CLASS_EDIT:
+		case DLG_CLASS_LISTBOX:
+			target.Fill(item.x, item.y, item.cx, item.cy, fDisabled ? RASTER_3DFACE : RASTER_WINDOW);
+			target.Edge(item.x, item.y, item.cx, item.cy, false);
+			break;
+		case DLG_CLASS_COMBOBOX:
+		{
+			// Drop-down button as wide as it is tall
+			int cxButton = std::max(0, item.cy - 4);
+			target.Fill(item.x, item.y, item.cx, item.cy, fDisabled ? RASTER_3DFACE : RASTER_WINDOW);
+			target.Edge(item.x, item.y, item.cx, item.cy, false);
+			target.Fill(item.x + item.cx - 2 - cxButton, item.y + 2, cxButton, cxButton, RASTER_3DFACE);
+			target.Edge(item.x + item.cx - 2 - cxButton, item.y + 2, cxButton, cxButton, true);
+			break;
+		}
+		case DLG_CLASS_SCROLLBAR:
+			target.Edge(item.x, item.y, item.cx, item.cy, true);
+			break;
+		default:
+			// Custom classes, e.g. the language bar icon
+			target.Frame(item.x, item.y, item.cx, item.cy, RASTER_3DSHADOW, RASTER_3DSHADOW);
+			break;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include "dlg_template.h"
+#include "resample.h"
+
+// Approximate classic-theme rendering of a dlgLayout, meant for comparing layouts rather than for display
+// Doesn't depend on Win32; controls are drawn as their frames, with a bar standing in for any text
+
+// frame is the dialog's client area, rows above top are left alone for the branding
+bool RasterizeDialog(const dlgLayout& layout, const imageView& frame, int top = 0);
@@ -0,0 +1,85 @@
+#include "dlg_raster.h"
+#include "png.h"
+#include "util/dlg_template.h"
+#include "util/pe_resources.h"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+// Renders every dialog template in a msgina.dll the way dlgLayout places its controls, to compare layouts between versions
+// clh_dlgrender <msgina.dll> <output dir> [dpi], writes <output dir>/<file>_<version>_<dialog id>_<dpi>dpi.png
+// Controls are drawn as classic-theme frames without their text, and there is no branding strip
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "usage: clh_dlgrender <msgina.dll> <output dir> [dpi]\n");
+		return 2;
+	}
+
+	std::ifstream in(argv[1], std::ios::binary);
+	std::vector<uint8_t> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	peResources res;
+	uint32_t versionMS, versionLS;
+	if (!res.Open(image.data(), image.size(), false) || !res.GetFileVersion(&versionMS, &versionLS))
+	{
+		fprintf(stderr, "%s isn't a PE image with a version resource\n", argv[1]);
+		return 2;
+	}
+
+	std::filesystem::path dir = argv[2];
+	std::error_code ec;
+	std::filesystem::create_directories(dir, ec);
+
+	// MS Shell Dlg 8 is 6 by 13 pixels per base unit at 96 DPI, scaling it linearly is close enough for a comparison
+	int dpi = argc > 3 ? atoi(argv[3]) : 96;
+	if (dpi <= 0)
+		dpi = 96;
+	int baseUnitX = (6 * dpi + 48) / 96;
+	int baseUnitY = (13 * dpi + 48) / 96;
+
+	std::string prefix = std::filesystem::path(argv[1]).stem().string() + "_"
+		+ std::to_string(versionMS >> 16) + "." + std::to_string(versionMS & 0xFFFF) + "." + std::to_string(versionLS >> 16);
+
+	int count = 0, failed = 0;
+	for (const peResourceEntry& entry : res.GetEntries())
+	{
+		if (entry.type != PE_RT_DIALOG)
+			continue;
+
+		dlgTemplate tmpl;
+		if (!ParseDialogTemplate(entry.span.data, entry.span.size, &tmpl) || tmpl.cx <= 0 || tmpl.cy <= 0)
+		{
+			fprintf(stderr, "dialog %u: can't be parsed\n", entry.id);
+			failed++;
+			continue;
+		}
+
+		int width = tmpl.cx * baseUnitX / 4;
+		int height = tmpl.cy * baseUnitY / 8;
+		dlgLayout layout;
+		layout.Load(tmpl, baseUnitX, baseUnitY, width, height);
+
+		std::vector<uint8_t> pixels((size_t)width * height * 4);
+		imageView frame = { pixels.data(), width, height, width * 4 };
+		std::vector<uint8_t> png;
+		std::filesystem::path path = dir / (prefix + "_" + std::to_string(entry.id) + "_" + std::to_string(dpi) + "dpi.png");
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!RasterizeDialog(layout, frame) || !EncodePng(frame, &png)
+			|| !out.write((const char*)png.data(), png.size()))
+		{
+			fprintf(stderr, "dialog %u: can't write %s\n", entry.id, path.string().c_str());
+			failed++;
+			continue;
+		}
+		printf("%s\n", path.string().c_str());
+		count++;
+	}
+
+	printf("%d dialogs rendered, %d failed\n", count, failed);
+	return failed ? 1 : 0;
+}
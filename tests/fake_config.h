@@ -0,0 +1,86 @@
+#pragma once
+#include "util/config_store.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// In-memory stand-in for the registry backend of configStore
+// Counts what reaches it, and can be made to fail, to take as long as a registry round trip or to stall writes
+class fakeConfigBackend : public configBackend
+{
+public:
+	bool Load(configSnapshot& snapshot) override
+	{
+		Delay();
+		loads++;
+		if (fFailLoads)
+			return false;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (const auto& value : _values)
+			snapshot.Set(value.first, value.second);
+		return true;
+	}
+
+	bool WriteInt(const wchar_t* name, uint32_t value) override
+	{
+		Delay();
+		writesHeld++;
+		while (fHoldWrites)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		writesHeld--;
+		if (fFailWrites)
+			return false;
+
+		writes++;
+		configValue cv;
+		cv.dword = value;
+		std::lock_guard<std::mutex> lock(_mutex);
+		_values[name] = cv;
+		return true;
+	}
+
+	void SetInt(const wchar_t* name, uint32_t value)
+	{
+		configValue cv;
+		cv.dword = value;
+		std::lock_guard<std::mutex> lock(_mutex);
+		_values[name] = cv;
+	}
+
+	void SetString(const wchar_t* name, const wchar_t* value)
+	{
+		configValue cv;
+		cv.type = CT_STRING;
+		cv.string = value;
+		std::lock_guard<std::mutex> lock(_mutex);
+		_values[name] = cv;
+	}
+
+	// What was last written under the exact name, -1 if nothing was
+	int64_t Written(const wchar_t* name)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _values.find(name);
+		return it != _values.end() && it->second.type == CT_DWORD ? (int64_t)it->second.dword : -1;
+	}
+
+	std::atomic<int> loads{ 0 };
+	std::atomic<int> writes{ 0 };
+	std::atomic<bool> fFailLoads{ false };
+	std::atomic<bool> fFailWrites{ false };
+	std::atomic<int> latencyUs{ 0 };
+	// Writes wait while this is set, writesHeld counts the ones waiting
+	std::atomic<bool> fHoldWrites{ false };
+	std::atomic<int> writesHeld{ 0 };
+
+private:
+	void Delay()
+	{
+		if (latencyUs)
+			std::this_thread::sleep_for(std::chrono::microseconds(latencyUs.load()));
+	}
+
+	std::mutex _mutex;
+	std::map<std::wstring, configValue> _values;
+};
@@ -0,0 +1,223 @@
+#include "images.h"
+#include "ui/gina_viewstate.h"
+#include "util/color_scheme.h"
+#include "util/dlg_template.h"
+#include "util/pe_resources.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+// Fuzz entry points for the parsers that see msgina.dll and registry data
+// Built with CLH_LIBFUZZER each one becomes its own libFuzzer binary, otherwise clh_fuzz mutates the seeds below itself:
+// clh_fuzz <pe|dlg|color|viewstate> [iterations] [seed]
+
+static int FuzzPeResources(const uint8_t* data, size_t size)
+{
+	for (bool fMapped : { false, true })
+	{
+		peResources res;
+		if (!res.Open(data, size, fMapped))
+			continue;
+
+		uint32_t ms, ls;
+		res.GetFileVersion(&ms, &ls);
+		const char16_t* text;
+		uint32_t length;
+		for (uint16_t id = 0; id < 64; id++)
+			res.GetString(id, &text, &length);
+		for (const peResourceEntry& entry : res.GetEntries())
+		{
+			// Every span has to lie within the input
+			if (entry.span.data < data || entry.span.size > size || entry.span.data - data > (ptrdiff_t)(size - entry.span.size))
+				abort();
+		}
+	}
+	return 0;
+}
+
+static int FuzzDialogTemplate(const uint8_t* data, size_t size)
+{
+	dlgTemplate t;
+	if (ParseDialogTemplate(data, size, &t))
+	{
+		dlgLayout layout;
+		layout.Load(t, 6, 13, 400, 300);
+		layout.OffsetBelow(50, 10, 1);
+		layout.Resize(0, 10);
+	}
+	return 0;
+}
+
+static int FuzzColorTriplet(const uint8_t* data, size_t size)
+{
+	std::wstring text;
+	for (size_t i = 0; i + 1 < size; i += 2)
+		text.push_back((wchar_t)(data[i] | (data[i + 1] << 8)));
+	uint32_t color;
+	if (ParseColorTriplet(text.data(), text.size(), &color) && (color >> 24))
+		abort();
+	ColorSchemeIndex(text.data(), text.size());
+	return 0;
+}
+
+// Each byte is one step for one view: Enter, Shown, Leave, or a timeout, where the watchdog gives up on a
+// view that was entered but never shown and its thread leaves without Shown
+// A model of which views are up is checked against the state machine after every step
+static int FuzzViewState(const uint8_t* data, size_t size)
+{
+	ginaViewState* state = ginaViewState::Get();
+	uint32_t active = 0;
+	GINAVIEW current = GV_NONE;
+	bool pending[GV_COUNT] = {};
+
+	for (size_t i = 0; i < size; i++)
+	{
+		// One past the last view so invalid ones are thrown in as well
+		GINAVIEW view = (GINAVIEW)((data[i] >> 2) % (GV_COUNT + 1));
+		bool fValid = view > GV_NONE && view < GV_COUNT;
+		switch (data[i] & 3)
+		{
+		case 0:
+		{
+			GINATRANSITION transition = state->Enter(view);
+			if (!fValid || (active & (1u << view)))
+			{
+				// Denied, nothing changes
+				if (transition != GT_DENY)
+					abort();
+				break;
+			}
+			if (transition != ginaViewState::GetTransition(view) || transition == GT_DENY)
+				abort();
+			active |= 1u << view;
+			pending[view] = true;
+			if (transition == GT_REPLACE)
+				current = view;
+			break;
+		}
+		case 1:
+		{
+			uint64_t total = 0;
+			for (int from = GV_NONE; from < GV_COUNT && fValid; from++)
+				total += state->GetStats((GINAVIEW)from, view).count;
+			state->Shown(view);
+			uint64_t after = 0;
+			for (int from = GV_NONE; from < GV_COUNT && fValid; from++)
+				after += state->GetStats((GINAVIEW)from, view).count;
+			// Only a pending transition is counted, and only once
+			if (after != total + (fValid && pending[view] ? 1 : 0))
+				abort();
+			if (fValid)
+				pending[view] = false;
+			break;
+		}
+		case 2:
+		case 3:
+			// Leave after Shown and a timed out view leaving look the same to the state machine
+			state->Leave(view);
+			if (fValid)
+			{
+				active &= ~(1u << view);
+				pending[view] = false;
+				if (current == view)
+					current = GV_NONE;
+			}
+			break;
+		}
+
+		if (state->Current() != current)
+			abort();
+		for (int v = GV_NONE; v <= GV_COUNT; v++)
+		{
+			bool fActive = v > GV_NONE && v < GV_COUNT && (active & (1u << v));
+			if (state->IsActive((GINAVIEW)v) != fActive)
+				abort();
+		}
+		// The current view is always one that's up
+		if (current != GV_NONE && !(active & (1u << current)))
+			abort();
+	}
+
+	// The state is a process wide singleton, leave everything for the next input
+	for (int v = GV_NONE + 1; v < GV_COUNT; v++)
+		state->Leave((GINAVIEW)v);
+	return 0;
+}
+
+#ifdef CLH_FUZZ_TARGET
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	return CLH_FUZZ_TARGET(data, size);
+}
+#else
+static std::vector<uint8_t> Seed(const std::string& target)
+{
+	if (target == "pe")
+	{
+		std::vector<imageResource> resources;
+		resources.push_back({ 16, 1, 1033, BuildVersionResource(0x00050000, 0x08930001) });
+		resources.push_back({ 6, 1, 1033, BuildStringBlock({ { 1, u"Log On to Windows" } }) });
+		resources.push_back({ 5, 1500, 1033, std::vector<uint8_t>(40, 0) });
+		return BuildPeImage(resources);
+	}
+	if (target == "dlg")
+	{
+		dlgWriter w;
+		w.Header(0x80C800C0, 2, 0, 0, 260, 120, "Log On to Windows");
+		w.Item(1502, DLG_CLASS_EDIT, 0x50810080, 72, 38, 162, 12, "");
+		w.Item(1, DLG_CLASS_BUTTON, 0x50010001, 7, 90, 50, 14, "OK");
+		return w.data;
+	}
+	if (target == "viewstate")
+	{
+		// User list, credential view, change password over it, then back to the user list
+		return { 1 << 2, 1 << 2 | 1, 2 << 2, 1 << 2 | 2, 2 << 2 | 1, 4 << 2, 4 << 2 | 1, 4 << 2 | 2, 1 << 2, 2 << 2 | 3, 1 << 2 | 1 };
+	}
+	std::vector<uint8_t> data;
+	for (const char* p = "212 208 200"; *p; p++)
+	{
+		data.push_back((uint8_t)*p);
+		data.push_back(0);
+	}
+	return data;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: clh_fuzz <pe|dlg|color|viewstate> [iterations] [seed]\n");
+		return 2;
+	}
+
+	std::string target = argv[1];
+	int (*pfnFuzz)(const uint8_t*, size_t) = target == "pe" ? FuzzPeResources
+		: target == "dlg" ? FuzzDialogTemplate
+		: target == "color" ? FuzzColorTriplet
+		: target == "viewstate" ? FuzzViewState
+		: nullptr;
+	if (!pfnFuzz)
+	{
+		fprintf(stderr, "Unknown target %s\n", argv[1]);
+		return 2;
+	}
+
+	long iterations = argc > 2 ? atol(argv[2]) : 100000;
+	std::mt19937 random(argc > 3 ? (unsigned)atol(argv[3]) : 1);
+	std::vector<uint8_t> seed = Seed(target), input;
+	for (long i = 0; i < iterations; i++)
+	{
+		// A few random bytes, then a random prefix
+		input = seed;
+		int mutations = 1 + random() % 8;
+		for (int m = 0; m < mutations; m++)
+			input[random() % input.size()] = (uint8_t)random();
+		input.resize(random() % (input.size() + 1));
+		pfnFuzz(input.data(), input.size());
+	}
+	printf("%s: %ld inputs\n", target.c_str(), iterations);
+	return 0;
+}
+#endif
@@ -0,0 +1,246 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Builders for the binary inputs the parsers take: PE images with a resource section,
+// version and string table resources, and dialog templates
+// Shared by the tests, the benchmarks and the fuzz seeds
+
+#define IMAGE_RESOURCE_RVA 0x1000
+#define IMAGE_RAW_OFFSET 0x400
+
+struct imageResource
+{
+	uint16_t type;
+	uint16_t id;
+	uint16_t lang;
+	std::vector<uint8_t> data;
+};
+
+inline void Put16(std::vector<uint8_t>& v, size_t offset, uint16_t value)
+{
+	memcpy(&v[offset], &value, 2);
+}
+
+inline void Put32(std::vector<uint8_t>& v, size_t offset, uint32_t value)
+{
+	memcpy(&v[offset], &value, 4);
+}
+
+// Raw PE32 file with one .rsrc section holding the resources, ids only
+// fMapped lays the section out at its RVA, the way LOAD_LIBRARY_AS_IMAGE_RESOURCE maps it
+inline std::vector<uint8_t> BuildPeImage(std::vector<imageResource> resources, bool fMapped = false)
+{
+	std::sort(resources.begin(), resources.end(), [](const imageResource& a, const imageResource& b) {
+		if (a.type != b.type)
+			return a.type < b.type;
+		if (a.id != b.id)
+			return a.id < b.id;
+		return a.lang < b.lang;
+	});
+
+	std::map<uint16_t, std::map<uint16_t, std::vector<size_t>>> tree;
+	for (size_t i = 0; i < resources.size(); i++)
+	{
+		tree[resources[i].type][resources[i].id].push_back(i);
+	}
+
+	// Directories first, then the data entries, then the data
+	size_t size = 16 + tree.size() * 8;
+	std::map<uint16_t, size_t> typeDirs;
+	std::map<uint32_t, size_t> idDirs;
+	for (auto& type : tree)
+	{
+		typeDirs[type.first] = size;
+		size += 16 + type.second.size() * 8;
+	}
+	for (auto& type : tree)
+	{
+		for (auto& id : type.second)
+		{
+			idDirs[((uint32_t)type.first << 16) | id.first] = size;
+			size += 16 + id.second.size() * 8;
+		}
+	}
+	size_t dataEntries = size;
+	size += resources.size() * 16;
+	std::vector<size_t> dataOffsets;
+	for (const imageResource& resource : resources)
+	{
+		size = (size + 3) & ~(size_t)3;
+		dataOffsets.push_back(size);
+		size += resource.data.size();
+	}
+	size = (size + 0x1FF) & ~(size_t)0x1FF;
+
+	std::vector<uint8_t> rsrc(size);
+	Put16(rsrc, 14, (uint16_t)tree.size());
+	size_t typeEntry = 16;
+	for (auto& type : tree)
+	{
+		Put32(rsrc, typeEntry, type.first);
+		Put32(rsrc, typeEntry + 4, 0x80000000u | (uint32_t)typeDirs[type.first]);
+		typeEntry += 8;
+
+		size_t typeDir = typeDirs[type.first];
+		Put16(rsrc, typeDir + 14, (uint16_t)type.second.size());
+		size_t idEntry = typeDir + 16;
+		for (auto& id : type.second)
+		{
+			size_t idDir = idDirs[((uint32_t)type.first << 16) | id.first];
+			Put32(rsrc, idEntry, id.first);
+			Put32(rsrc, idEntry + 4, 0x80000000u | (uint32_t)idDir);
+			idEntry += 8;
+
+			Put16(rsrc, idDir + 14, (uint16_t)id.second.size());
+			size_t langEntry = idDir + 16;
+			for (size_t index : id.second)
+			{
+				size_t dataEntry = dataEntries + index * 16;
+				Put32(rsrc, langEntry, resources[index].lang);
+				Put32(rsrc, langEntry + 4, (uint32_t)dataEntry);
+				langEntry += 8;
+
+				Put32(rsrc, dataEntry, IMAGE_RESOURCE_RVA + (uint32_t)dataOffsets[index]);
+				Put32(rsrc, dataEntry + 4, (uint32_t)resources[index].data.size());
+				if (!resources[index].data.empty())
+					memcpy(&rsrc[dataOffsets[index]], resources[index].data.data(), resources[index].data.size());
+			}
+		}
+	}
+
+	size_t rawOffset = fMapped ? IMAGE_RESOURCE_RVA : IMAGE_RAW_OFFSET;
+	std::vector<uint8_t> image(rawOffset + rsrc.size());
+	image[0] = 'M';
+	image[1] = 'Z';
+	Put32(image, 0x3C, 0x80);
+	Put32(image, 0x80, 0x00004550);
+	size_t fileHeader = 0x84;
+	size_t optionalHeader = fileHeader + 20;
+	Put16(image, fileHeader, 0x14C);
+	Put16(image, fileHeader + 2, 1);
+	Put16(image, fileHeader + 16, 224);
+	Put16(image, optionalHeader, 0x10B);
+	Put32(image, optionalHeader + 56, IMAGE_RESOURCE_RVA + (uint32_t)rsrc.size()); // SizeOfImage
+	Put32(image, optionalHeader + 92, 16);
+	Put32(image, optionalHeader + 96 + 16, IMAGE_RESOURCE_RVA);
+	Put32(image, optionalHeader + 96 + 20, (uint32_t)rsrc.size());
+
+	size_t section = optionalHeader + 224;
+	memcpy(&image[section], ".rsrc", 5);
+	Put32(image, section + 8, (uint32_t)rsrc.size());
+	Put32(image, section + 12, IMAGE_RESOURCE_RVA);
+	Put32(image, section + 16, (uint32_t)rsrc.size());
+	Put32(image, section + 20, (uint32_t)rawOffset);
+	memcpy(&image[rawOffset], rsrc.data(), rsrc.size());
+	return image;
+}
+
+// VS_VERSIONINFO with only the fixed file info
+inline std::vector<uint8_t> BuildVersionResource(uint32_t versionMS, uint32_t versionLS)
+{
+	std::vector<uint8_t> data(40 + 52);
+	Put16(data, 0, (uint16_t)data.size());
+	Put16(data, 2, 52);
+	const char16_t key[] = u"VS_VERSION_INFO";
+	memcpy(&data[6], key, sizeof(key));
+	Put32(data, 40, 0xFEEF04BDu);
+	Put32(data, 44, 0x00010000);
+	Put32(data, 48, versionMS);
+	Put32(data, 52, versionLS);
+	Put32(data, 56, versionMS);
+	Put32(data, 60, versionLS);
+	return data;
+}
+
+// One RT_STRING block, strings (id & 15) -> text, everything else empty
+inline std::vector<uint8_t> BuildStringBlock(const std::map<int, std::u16string>& strings)
+{
+	std::vector<uint8_t> data;
+	for (int i = 0; i < 16; i++)
+	{
+		auto it = strings.find(i);
+		std::u16string text = it != strings.end() ? it->second : std::u16string();
+		size_t offset = data.size();
+		data.resize(offset + 2 + text.size() * 2);
+		Put16(data, offset, (uint16_t)text.size());
+		if (!text.empty())
+			memcpy(&data[offset + 2], text.data(), text.size() * 2);
+	}
+	return data;
+}
+
+// Appends the fields of a dialog template in order
+class dlgWriter
+{
+public:
+	std::vector<uint8_t> data;
+
+	void Word(uint16_t value)
+	{
+		data.push_back(value & 0xFF);
+		data.push_back(value >> 8);
+	}
+
+	void Dword(uint32_t value)
+	{
+		Word(value & 0xFFFF);
+		Word(value >> 16);
+	}
+
+	void String(const char* text)
+	{
+		while (*text)
+			Word((uint8_t)*text++);
+		Word(0);
+	}
+
+	void Ordinal(uint16_t value)
+	{
+		Word(0xFFFF);
+		Word(value);
+	}
+
+	void Align()
+	{
+		while (data.size() % 4)
+			data.push_back(0);
+	}
+
+	// DLGTEMPLATE with DS_SETFONT and the font, count items follow
+	void Header(uint32_t style, uint16_t count, int16_t x, int16_t y, int16_t cx, int16_t cy, const char* caption)
+	{
+		Dword(style | 0x40);
+		Dword(0);
+		Word(count);
+		Word(x);
+		Word(y);
+		Word(cx);
+		Word(cy);
+		Word(0); // Menu
+		Word(0); // Class
+		String(caption);
+		Word(8);
+		String("MS Shell Dlg");
+	}
+
+	// DLGITEMTEMPLATE with a predefined class and a text caption
+	void Item(uint16_t id, uint16_t classAtom, uint32_t style, int16_t x, int16_t y, int16_t cx, int16_t cy, const char* text)
+	{
+		Align();
+		Dword(style);
+		Dword(0);
+		Word(x);
+		Word(y);
+		Word(cx);
+		Word(cy);
+		Word(id);
+		Ordinal(classAtom);
+		String(text);
+		Word(0); // Creation data
+	}
+};
@@ -0,0 +1,31 @@
+#include "test.h"
+
+std::vector<testCase>& GetTests()
+{
+	static std::vector<testCase> tests;
+	return tests;
+}
+
+int main(int argc, char** argv)
+{
+	const char* prefix = argc > 1 ? argv[1] : "";
+	int count = 0;
+	for (const testCase& test : GetTests())
+	{
+		if (strncmp(test.name, prefix, strlen(prefix)) != 0)
+			continue;
+
+		printf("%s\n", test.name);
+		fflush(stdout);
+		test.pfn();
+		count++;
+	}
+
+	if (!count)
+	{
+		fprintf(stderr, "No test matches %s\n", prefix);
+		return 1;
+	}
+	printf("%d passed\n", count);
+	return 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include "images.h"
+#include "util/pe_resources.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+// msgina.dll stand-ins for the versions CLH_GINA supports, and the real files when there are some to test with
+// The synthetic images carry the version resource and the dialogs ginaManager loads for that version,
+// with the shapes of the real ones (NT 4.0 dialogs have no branding strip, 2000 and XP leave room for it)
+// Real files can't be shipped here, point CLH_GINA_MSGINA_DIR at a directory of msgina.dll copies to check those as well
+
+// NT 4.0 and 2000/XP ids of the dialogs CLH_GINA uses, as GINA_DLG_* in gina_manager.h
+static const uint16_t c_msginaDialogs[][2] = {
+	{ 1450, 1500 }, // User select
+	{ 1850, 1950 }, // User select, locked
+	{ 1650, 1800 }, // Security control
+	{ 800, 2450 }, // Status view
+	{ 1550, 1700 }, // Change password
+	{ 1200, 2200 }, // Shut down
+	{ 1203, 2250 }, // Log off
+};
+
+struct msginaSample
+{
+	std::string name;
+	bool fNt4;
+	std::vector<uint8_t> image;
+};
+
+// A dialog with the controls every one of them has: a caption, a label, an edit and the OK/Cancel pair
+// 2000 and XP move everything down by the 72 dialog units the branding bitmap takes
+inline std::vector<uint8_t> BuildMsginaDialog(uint16_t id, bool fNt4)
+{
+	int16_t top = fNt4 ? 0 : 72;
+	int16_t cx = fNt4 ? 256 : 262;
+	dlgWriter w;
+	w.Header(0x80C800C0, 4, 0, 0, cx, top + 86, fNt4 ? "Logon Information" : "Log On to Windows");
+	w.Item(0xFFFF, 0x82, 0x50020000, 7, top + 8, 60, 8, "&User name:");
+	w.Item(id + 2, 0x81, 0x50810080, 70, top + 6, cx - 77, 12, "");
+	w.Item(1, 0x80, 0x50010001, cx - 114, top + 64, 50, 14, "OK");
+	w.Item(2, 0x80, 0x50010000, cx - 57, top + 64, 50, 14, "Cancel");
+	return w.data;
+}
+
+inline std::vector<uint8_t> BuildMsginaImage(uint32_t versionMS, uint32_t versionLS)
+{
+	bool fNt4 = (versionMS >> 16) == 4;
+	std::vector<imageResource> resources;
+	resources.push_back({ PE_RT_VERSION, 1, 1033, BuildVersionResource(versionMS, versionLS) });
+	for (const auto& ids : c_msginaDialogs)
+	{
+		uint16_t id = fNt4 ? ids[0] : ids[1];
+		resources.push_back({ PE_RT_DIALOG, id, 1033, BuildMsginaDialog(id, fNt4) });
+	}
+	if (!fNt4)
+	{
+		// Branding, the small brand and the progress bar
+		resources.push_back({ PE_RT_BITMAP, 101, 1033, std::vector<uint8_t>(40, 0) });
+		resources.push_back({ PE_RT_BITMAP, 103, 1033, std::vector<uint8_t>(40, 0) });
+		resources.push_back({ PE_RT_BITMAP, 107, 1033, std::vector<uint8_t>(40, 0) });
+	}
+	resources.push_back({ PE_RT_STRING, (1501 >> 4) + 1, 1033, BuildStringBlock({ { 1501 & 15, u"Logon Message" } }) });
+	return BuildPeImage(resources);
+}
+
+inline std::vector<msginaSample> BuildMsginaSamples()
+{
+	std::vector<msginaSample> samples;
+	samples.push_back({ "NT 4.0 (4.0.1381)", true, BuildMsginaImage(0x00040000, (1381 << 16) | 1) });
+	samples.push_back({ "2000 (5.0.2195)", false, BuildMsginaImage(0x00050000, (2195 << 16) | 6659) });
+	samples.push_back({ "XP (5.1.2600)", false, BuildMsginaImage(0x00050001, (2600 << 16) | 5512) });
+	return samples;
+}
+
+// Every file in CLH_GINA_MSGINA_DIR, nothing if it isn't set
+inline std::vector<msginaSample> LoadMsginaFiles()
+{
+	std::vector<msginaSample> samples;
+	const char* dir = getenv("CLH_GINA_MSGINA_DIR");
+	if (!dir || !*dir)
+		return samples;
+
+	std::error_code ec;
+	for (const auto& file : std::filesystem::directory_iterator(dir, ec))
+	{
+		if (!file.is_regular_file())
+			continue;
+		std::ifstream in(file.path(), std::ios::binary);
+		msginaSample sample;
+		sample.name = file.path().filename().string();
+		sample.image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+		peResources res;
+		uint32_t ms, ls;
+		sample.fNt4 = res.Open(sample.image.data(), sample.image.size(), false) && res.GetFileVersion(&ms, &ls) && (ms >> 16) == 4;
+		samples.push_back(std::move(sample));
+	}
+	return samples;
+}
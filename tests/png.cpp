@@ -0,0 +1,123 @@
+#include "png.h"
+#include <algorithm>
+
+// Largest payload of a stored deflate block
+#define PNG_STORED_BLOCK 65535
+
+struct pngCrcTable
+{
+	uint32_t entries[256];
+
+	pngCrcTable()
+	{
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			uint32_t c = i;
+			for (int k = 0; k < 8; k++)
+			{
+				c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			entries[i] = c;
+		}
+	}
+};
+
+static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+	// Views encode from their own threads, a function local static is built exactly once
+	static const pngCrcTable table;
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++)
+	{
+		crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+static void Put32(std::vector<uint8_t>& out, uint32_t value)
+{
+	out.push_back((uint8_t)(value >> 24));
+	out.push_back((uint8_t)(value >> 16));
+	out.push_back((uint8_t)(value >> 8));
+	out.push_back((uint8_t)value);
+}
+
+static void PutChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size)
+{
+	Put32(out, (uint32_t)size);
+	size_t start = out.size();
+	out.insert(out.end(), type, type + 4);
+	out.insert(out.end(), data, data + size);
+	Put32(out, Crc32(&out[start], size + 4));
+}
+
+bool EncodePng(const imageView& image, std::vector<uint8_t>* pOut)
+{
+	if (!image.pixels || image.width <= 0 || image.height <= 0 || !pOut)
+		return false;
+
+	// Filter type 0 then RGB for every row
+	size_t rowSize = (size_t)image.width * 3 + 1;
+	std::vector<uint8_t> raw(rowSize * image.height);
+	for (int y = 0; y < image.height; y++)
+	{
+		const uint8_t* src = image.pixels + (size_t)y * image.stride;
+		uint8_t* dst = &raw[rowSize * y];
+		*dst++ = 0;
+		for (int x = 0; x < image.width; x++)
+		{
+			dst[0] = src[2];
+			dst[1] = src[1];
+			dst[2] = src[0];
+			dst += 3;
+			src += 4;
+		}
+	}
+
+	// zlib stream of stored blocks
+	std::vector<uint8_t> zlib;
+	zlib.reserve(raw.size() + raw.size() / PNG_STORED_BLOCK * 5 + 16);
+	zlib.push_back(0x78);
+	zlib.push_back(0x01);
+	size_t pos = 0;
+	do
+	{
+		size_t size = std::min(raw.size() - pos, (size_t)PNG_STORED_BLOCK);
+		bool fLast = pos + size == raw.size();
+		zlib.push_back(fLast ? 1 : 0);
+		zlib.push_back((uint8_t)size);
+		zlib.push_back((uint8_t)(size >> 8));
+		zlib.push_back((uint8_t)~size);
+		zlib.push_back((uint8_t)(~size >> 8));
+		zlib.insert(zlib.end(), raw.begin() + pos, raw.begin() + pos + size);
+		pos += size;
+	} while (pos < raw.size());
+
+	uint32_t a = 1, b = 0;
+	for (uint8_t c : raw)
+	{
+		a = (a + c) % 65521;
+		b = (b + a) % 65521;
+	}
+	Put32(zlib, (b << 16) | a);
+
+	uint8_t header[13] = { 0 };
+	header[0] = (uint8_t)(image.width >> 24);
+	header[1] = (uint8_t)(image.width >> 16);
+	header[2] = (uint8_t)(image.width >> 8);
+	header[3] = (uint8_t)image.width;
+	header[4] = (uint8_t)(image.height >> 24);
+	header[5] = (uint8_t)(image.height >> 16);
+	header[6] = (uint8_t)(image.height >> 8);
+	header[7] = (uint8_t)image.height;
+	header[8] = 8; // Bit depth
+	header[9] = 2; // Truecolor
+
+	static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	pOut->assign(signature, signature + 8);
+	PutChunk(*pOut, "IHDR", header, sizeof(header));
+	PutChunk(*pOut, "IDAT", zlib.data(), zlib.size());
+	PutChunk(*pOut, "IEND", nullptr, 0);
+	return true;
+}
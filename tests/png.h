@@ -0,0 +1,9 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "resample.h"
+
+// Minimal PNG writer for 32bpp BGRA images, stored as 8-bit RGB
+// Doesn't depend on Win32 or zlib, the deflate stream is uncompressed, which is fine for debug output
+
+bool EncodePng(const imageView& image, std::vector<uint8_t>* pOut);
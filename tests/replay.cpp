@@ -0,0 +1,36 @@
+#include "trace_stub_ui.h"
+#include <cstdio>
+#include <cstdlib>
+
+// Replays an interop trace recorded with the InteropTrace value against the stub UI
+// clh_replay <trace file> [speed], speed 0 (the default) replays as fast as possible
+// Prints the events as they arrive and exits with 1 if the stub saw a control used after the hook destroyed it
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: clh_replay <trace file> [speed]\n");
+		return 2;
+	}
+
+	std::vector<interop_trace::traceEvent> events;
+	if (!interop_trace::Load(argv[1], events))
+	{
+		fprintf(stderr, "%s is not an interop trace\n", argv[1]);
+		return 2;
+	}
+
+	traceStubUi ui;
+	size_t reported = 0;
+	interop_trace::Replay(events, argc > 2 ? atof(argv[2]) : 0, [&](const interop_trace::traceEvent& event) {
+		printf("%10.3f ms  0x%03x  0x%llx %llu %ls\n", event.time / 10000.0, (unsigned)event.event,
+			(unsigned long long)event.arg0, (unsigned long long)event.arg1, event.str.c_str());
+		ui.Apply(event);
+		for (; reported < ui.GetViolations().size(); reported++)
+			printf("  !! %s\n", ui.GetViolations()[reported].c_str());
+	});
+
+	printf("%zu events, %zu violations\n", ui.GetEventCount(), ui.GetViolations().size());
+	return ui.GetViolations().empty() ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Minimal runner for the parts of ConsoleLogonUI that don't depend on Win32
+// TEST(name) registers a case, CHECK ends the run at the first failure
+// Case names start with the module they cover, clh_tests <prefix> only runs the matching ones
+
+struct testCase
+{
+	const char* name;
+	void (*pfn)();
+};
+
+std::vector<testCase>& GetTests();
+
+struct testRegistrar
+{
+	testRegistrar(const char* name, void (*pfn)())
+	{
+		GetTests().push_back({ name, pfn });
+	}
+};
+
+#define TEST(name) \
+	static void name(); \
+	static testRegistrar name##_registrar(#name, name); \
+	static void name()
+
+#define CHECK(x) \
+	do \
+	{ \
+		if (!(x)) \
+		{ \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #x); \
+			exit(1); \
+		} \
+	} while (0)
@@ -0,0 +1,55 @@
+#include "test.h"
+#include "util/color_scheme.h"
+#include <cwchar>
+
+static bool Parse(const wchar_t* text, uint32_t* pColor)
+{
+	// Registry strings come with their terminator
+	return ParseColorTriplet(text, wcslen(text) + 1, pColor);
+}
+
+TEST(color_scheme_triplet)
+{
+	uint32_t color;
+	CHECK(Parse(L"212 208 200", &color) && color == 0xC8D0D4);
+	CHECK(Parse(L"0 0 0", &color) && color == 0);
+	CHECK(Parse(L" 255\t255  255 ", &color) && color == 0xFFFFFF);
+	CHECK(!Parse(L"256 0 0", &color));
+	CHECK(!Parse(L"1 2", &color));
+	CHECK(!Parse(L"1 2 3 4", &color));
+	CHECK(!Parse(L"1,2,3", &color));
+	CHECK(!Parse(L"", &color));
+	CHECK(!Parse(L"0001 2 3", &color));
+	CHECK(!Parse(L"-1 2 3", &color));
+	// Not terminated
+	CHECK(ParseColorTriplet(L"1 2 3", 5, &color) && color == 0x030201);
+	CHECK(!ParseColorTriplet(L"1 2 3", 3, &color));
+}
+
+TEST(color_scheme_names)
+{
+	CHECK(ColorSchemeIndex(L"hilighttext", 11) == 14);
+	CHECK(ColorSchemeIndex(L"MENUBAR", 7) == 29);
+	CHECK(ColorSchemeIndex(L"Menu", 4) == 4);
+	CHECK(ColorSchemeIndex(L"MenuBarX", 8) == -1);
+	CHECK(ColorSchemeIndex(L"ButtonAlternateFace", 19) == -1);
+	CHECK(ColorSchemeElement(25) == 26);
+	CHECK(ColorSchemeElement(29) == 30);
+}
+
+TEST(color_scheme_diff)
+{
+	colorScheme scheme = {};
+	uint32_t current[COLOR_SCHEME_COUNT] = {};
+	int elements[COLOR_SCHEME_COUNT];
+	uint32_t colors[COLOR_SCHEME_COUNT];
+
+	scheme.present = (1u << 3) | (1u << 26);
+	scheme.colors[3] = 5;
+	scheme.colors[26] = 0;
+	CHECK(DiffColorScheme(scheme, current, elements, colors) == 1);
+	CHECK(elements[0] == ColorSchemeElement(3) && colors[0] == 5);
+
+	current[3] = 5;
+	CHECK(DiffColorScheme(scheme, current, elements, colors) == 0);
+}
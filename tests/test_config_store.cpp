@@ -0,0 +1,227 @@
+#include "test.h"
+#include "fake_config.h"
+#include <list>
+#include <thread>
+
+// configStore is a process wide singleton, every case gives it a backend of its own and compares counts before and after
+// Backends are kept until exit, the store's writer thread may still hold on to the last one
+
+static fakeConfigBackend* NewBackend()
+{
+	static std::list<fakeConfigBackend> backends;
+	fakeConfigBackend* backend = &backends.emplace_back();
+	backend->SetInt(L"ShowConsole", 5);
+	backend->SetString(L"CustomBrd", L"C:\\brd.bmp");
+	configStore::Get()->SetBackend(backend);
+	return backend;
+}
+
+TEST(config_store_snapshot)
+{
+	configSnapshot snapshot;
+	configValue cv;
+	cv.dword = 3;
+	snapshot.Set(L"WatchdogTimeout", cv);
+	cv.type = CT_STRING;
+	cv.string = L"1 2 3";
+	snapshot.Set(L"Background", cv);
+
+	int value;
+	std::wstring text;
+	CHECK(snapshot.Count() == 2);
+	CHECK(snapshot.GetInt(L"watchdogtimeout", &value) && value == 3);
+	CHECK(snapshot.GetString(L"BACKGROUND", &text) && text == L"1 2 3");
+	// Types don't convert
+	CHECK(!snapshot.GetInt(L"Background", &value));
+	CHECK(!snapshot.GetString(L"WatchdogTimeout", &text));
+	CHECK(!snapshot.GetInt(L"Missing", &value));
+}
+
+TEST(config_store_load_once)
+{
+	fakeConfigBackend* backend = NewBackend();
+	uint64_t loads = configStore::Get()->GetLoadCount();
+
+	// Readers share one load until something changes
+	int value;
+	std::wstring text;
+	for (int i = 0; i < 1000; i++)
+	{
+		CHECK(configStore::Get()->Current()->GetInt(L"showconsole", &value) && value == 5);
+		CHECK(configStore::Get()->Current()->GetString(L"CustomBrd", &text) && text == L"C:\\brd.bmp");
+	}
+	CHECK(backend->loads == 1);
+	CHECK(configStore::Get()->GetLoadCount() == loads + 1);
+}
+
+TEST(config_store_reload)
+{
+	fakeConfigBackend* backend = NewBackend();
+	auto before = configStore::Get()->Current();
+	backend->SetInt(L"ShowConsole", 6);
+
+	int value;
+	CHECK(configStore::Get()->Current()->GetInt(L"ShowConsole", &value) && value == 5);
+	configStore::Get()->Reload();
+	CHECK(configStore::Get()->Current()->GetInt(L"ShowConsole", &value) && value == 6);
+	// Snapshots handed out earlier never change
+	CHECK(before->GetInt(L"ShowConsole", &value) && value == 5);
+
+	// A failed read keeps the last good snapshot
+	backend->fFailLoads = true;
+	configStore::Get()->Reload();
+	CHECK(configStore::Get()->Current()->GetInt(L"ShowConsole", &value) && value == 6);
+	backend->fFailLoads = false;
+}
+
+TEST(config_store_set_int)
+{
+	fakeConfigBackend* backend = NewBackend();
+	auto before = configStore::Get()->Current();
+	uint64_t writes = configStore::Get()->GetWriteCount();
+
+	int value;
+	CHECK(configStore::Get()->SetInt(L"OptionsExpanded", 1));
+	CHECK(backend->Written(L"OptionsExpanded") == 1);
+	CHECK(configStore::Get()->Current()->GetInt(L"optionsexpanded", &value) && value == 1);
+	CHECK(!before->GetInt(L"OptionsExpanded", &value));
+	CHECK(configStore::Get()->GetWriteCount() == writes + 1);
+
+	backend->fFailWrites = true;
+	CHECK(!configStore::Get()->SetInt(L"OptionsExpanded", 0));
+	CHECK(configStore::Get()->Current()->GetInt(L"OptionsExpanded", &value) && value == 1);
+	CHECK(configStore::Get()->GetWriteCount() == writes + 1);
+	backend->fFailWrites = false;
+}
+
+TEST(config_store_set_later)
+{
+	fakeConfigBackend* backend = NewBackend();
+	configStore::Get()->SetWriteDelay(50);
+	uint64_t writes = configStore::Get()->GetWriteCount();
+
+	// Readers see every value right away, the backend only the last one
+	int value;
+	for (int i = 0; i < 20; i++)
+	{
+		configStore::Get()->SetIntLater(L"ShutdownChoice", i);
+		CHECK(configStore::Get()->Current()->GetInt(L"ShutdownChoice", &value) && value == i);
+	}
+	CHECK(backend->Written(L"ShutdownChoice") == -1);
+
+	// A reload before the write can't bring the old value back
+	configStore::Get()->Reload();
+	CHECK(configStore::Get()->Current()->GetInt(L"ShutdownChoice", &value) && value == 19);
+
+	for (int i = 0; i < 200 && backend->Written(L"ShutdownChoice") == -1; i++)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	CHECK(backend->Written(L"ShutdownChoice") == 19);
+	CHECK(backend->writes == 1);
+	CHECK(configStore::Get()->GetWriteCount() == writes + 1);
+
+	// Flush writes what's pending without waiting
+	configStore::Get()->SetWriteDelay(60000);
+	configStore::Get()->SetIntLater(L"ShutdownChoice", 3);
+	configStore::Get()->Flush();
+	CHECK(backend->Written(L"ShutdownChoice") == 3);
+	CHECK(configStore::Get()->GetWriteCount() == writes + 2);
+	configStore::Get()->SetWriteDelay(1000);
+}
+
+TEST(config_store_set_later_case)
+{
+	fakeConfigBackend* backend = NewBackend();
+	configStore::Get()->SetWriteDelay(60000);
+
+	// Names differing in case are one value, like in the registry, so only the last one is written
+	int value;
+	configStore::Get()->SetIntLater(L"ShutdownChoice", 1);
+	configStore::Get()->SetIntLater(L"shutdownchoice", 2);
+	CHECK(configStore::Get()->Current()->GetInt(L"SHUTDOWNCHOICE", &value) && value == 2);
+	configStore::Get()->Flush();
+	CHECK(backend->writes == 1);
+	CHECK(backend->Written(L"shutdownchoice") == 2);
+	CHECK(backend->Written(L"ShutdownChoice") == -1);
+
+	// A direct write drops what's pending under another case too
+	configStore::Get()->SetIntLater(L"OptionsExpanded", 1);
+	CHECK(configStore::Get()->SetInt(L"optionsexpanded", 0));
+	configStore::Get()->Flush();
+	CHECK(backend->writes == 2);
+	CHECK(backend->Written(L"OptionsExpanded") == -1);
+	configStore::Get()->SetWriteDelay(1000);
+}
+
+TEST(config_store_reload_during_write)
+{
+	fakeConfigBackend* backend = NewBackend();
+	configStore::Get()->SetWriteDelay(60000);
+	backend->SetInt(L"ShutdownChoice", 0);
+
+	configStore::Get()->SetIntLater(L"ShutdownChoice", 7);
+	backend->fHoldWrites = true;
+	std::thread flusher([] { configStore::Get()->Flush(); });
+	while (!backend->writesHeld)
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	// The backend still has the old value while the write is in flight, the reload mustn't bring it back
+	int value;
+	configStore::Get()->Reload();
+	CHECK(configStore::Get()->Current()->GetInt(L"ShutdownChoice", &value) && value == 7);
+
+	backend->fHoldWrites = false;
+	flusher.join();
+	CHECK(backend->Written(L"ShutdownChoice") == 7);
+	configStore::Get()->Reload();
+	CHECK(configStore::Get()->Current()->GetInt(L"ShutdownChoice", &value) && value == 7);
+	configStore::Get()->SetWriteDelay(1000);
+}
+
+TEST(config_store_failed_write)
+{
+	fakeConfigBackend* backend = NewBackend();
+	configStore::Get()->SetWriteDelay(60000);
+	uint64_t writes = configStore::Get()->GetWriteCount();
+
+	// A write the backend refused stays pending, over reloads too, until a later flush gets it through
+	int value;
+	backend->fFailWrites = true;
+	configStore::Get()->SetIntLater(L"ShutdownChoice", 4);
+	configStore::Get()->Flush();
+	CHECK(backend->Written(L"ShutdownChoice") == -1);
+	CHECK(configStore::Get()->GetWriteCount() == writes);
+	configStore::Get()->Reload();
+	CHECK(configStore::Get()->Current()->GetInt(L"ShutdownChoice", &value) && value == 4);
+
+	backend->fFailWrites = false;
+	configStore::Get()->Flush();
+	CHECK(backend->Written(L"ShutdownChoice") == 4);
+	CHECK(configStore::Get()->GetWriteCount() == writes + 1);
+
+	// Nothing left after that
+	configStore::Get()->Flush();
+	CHECK(backend->writes == 1);
+	configStore::Get()->SetWriteDelay(1000);
+}
+
+TEST(config_store_concurrent)
+{
+	fakeConfigBackend* backend = NewBackend();
+	std::atomic<bool> fStop(false);
+	std::thread reloader([&] {
+		for (int i = 0; !fStop; i++)
+		{
+			backend->SetInt(L"Counter", i);
+			configStore::Get()->Reload();
+		}
+	});
+
+	int value;
+	for (int i = 0; i < 20000; i++)
+	{
+		auto snapshot = configStore::Get()->Current();
+		CHECK(snapshot->GetInt(L"ShowConsole", &value) && value == 5);
+	}
+	fStop = true;
+	reloader.join();
+}
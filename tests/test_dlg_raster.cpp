@@ -0,0 +1,74 @@
+#include "test.h"
+#include "dlg_raster.h"
+#include "msgina_samples.h"
+#include "png.h"
+#include "util/dlg_template.h"
+
+static uint32_t Pixel(const imageView& frame, int x, int y)
+{
+	const uint8_t* p = frame.pixels + (size_t)y * frame.stride + (size_t)x * 4;
+	return ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+}
+
+// The NT 4.0 user select stand-in at 96 DPI
+static dlgLayout SampleLayout()
+{
+	std::vector<uint8_t> data = BuildMsginaDialog(1450, true);
+	dlgTemplate t;
+	CHECK(ParseDialogTemplate(data.data(), data.size(), &t));
+	dlgLayout layout;
+	layout.Load(t, 6, 13, 384, 140);
+	return layout;
+}
+
+TEST(dlg_raster_controls)
+{
+	dlgLayout layout = SampleLayout();
+	std::vector<uint8_t> pixels(384 * 140 * 4);
+	imageView frame = { pixels.data(), 384, 140, 384 * 4 };
+	CHECK(RasterizeDialog(layout, frame));
+
+	CHECK(Pixel(frame, 0, 0) == 0xD4D0C8);
+	// The default button has a black frame, the edit a white inside
+	dlgItem* pOk = layout.Find(1);
+	CHECK(Pixel(frame, pOk->x, pOk->y) == 0x000000);
+	dlgItem* pEdit = layout.Find(1452);
+	CHECK(Pixel(frame, pEdit->x + pEdit->cx / 2, pEdit->y + 3) == 0xFFFFFF);
+
+	// Hidden controls leave the face behind
+	dlgItem* pCancel = layout.Find(2);
+	CHECK(Pixel(frame, pCancel->x, pCancel->y) != 0xD4D0C8);
+	layout.Hide(2);
+	CHECK(RasterizeDialog(layout, frame));
+	CHECK(Pixel(frame, pCancel->x, pCancel->y) == 0xD4D0C8);
+
+	// Rows above top are the branding's
+	std::fill(pixels.begin(), pixels.end(), 0);
+	CHECK(RasterizeDialog(layout, frame, 20));
+	CHECK(Pixel(frame, 0, 19) == 0 && Pixel(frame, 0, 20) == 0xD4D0C8);
+
+	imageView empty = { nullptr, 0, 0, 0 };
+	CHECK(!RasterizeDialog(layout, empty));
+}
+
+TEST(dlg_raster_png)
+{
+	dlgLayout layout = SampleLayout();
+	std::vector<uint8_t> pixels(384 * 140 * 4);
+	imageView frame = { pixels.data(), 384, 140, 384 * 4 };
+	CHECK(RasterizeDialog(layout, frame));
+
+	std::vector<uint8_t> png;
+	CHECK(EncodePng(frame, &png));
+	static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	CHECK(png.size() > 8 + 25 + 12 + 12 && !memcmp(png.data(), signature, 8));
+	CHECK(!memcmp(&png[12], "IHDR", 4));
+	CHECK(png[16] == 0 && png[17] == 0 && png[18] == 384 >> 8 && png[19] == (384 & 0xFF));
+	CHECK(png[22] == 0 && png[23] == 140);
+	CHECK(!memcmp(&png[png.size() - 8], "IEND", 4));
+	// Stored deflate blocks, the size only depends on the image dimensions
+	size_t raw = (size_t)(384 * 3 + 1) * 140;
+	CHECK(png.size() > raw && png.size() < raw + raw / 1000 + 128);
+
+	CHECK(!EncodePng(frame, nullptr));
+}
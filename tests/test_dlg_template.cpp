@@ -0,0 +1,232 @@
+#include "test.h"
+#include "images.h"
+#include "msgina_samples.h"
+#include "util/dlg_template.h"
+
+static std::vector<uint8_t> SampleTemplate()
+{
+	dlgWriter w;
+	w.Header(0x80C800C0, 3, 0, 0, 200, 100, "Log On");
+	w.Item(1, DLG_CLASS_BUTTON, 0x50010000, 7, 14, 50, 14, "OK");
+	w.Item(0xFFFF, DLG_CLASS_STATIC, 0x50000000, 7, 40, 100, 8, "Label");
+	w.Item(1455, DLG_CLASS_COMBOBOX, 0x50210003, 7, 60, 100, 80, "");
+	return w.data;
+}
+
+static std::vector<uint8_t> SampleTemplateEx()
+{
+	dlgWriter w;
+	w.Word(1);
+	w.Word(0xFFFF);
+	w.Dword(0); // Help id
+	w.Dword(0);
+	w.Dword(0x80C80048);
+	w.Word(2);
+	w.Word((uint16_t)-5);
+	w.Word(3);
+	w.Word(212);
+	w.Word(120);
+	w.Ordinal(5); // Menu
+	w.Word(0);
+	w.String("");
+	w.Word(8);
+	w.Word(400);
+	w.Word(0x0100);
+	w.String("MS Shell Dlg 2");
+
+	w.Align();
+	w.Dword(0);
+	w.Dword(0);
+	w.Dword(0x50010000);
+	w.Word((uint16_t)-2);
+	w.Word(10);
+	w.Word(50);
+	w.Word(14);
+	w.Dword(0xFFFFFFFF);
+	w.Ordinal(DLG_CLASS_COMBOBOX);
+	w.Ordinal(12);
+	w.Word(0);
+
+	w.Align();
+	w.Dword(0);
+	w.Dword(0);
+	w.Dword(0x50010000);
+	w.Word(150);
+	w.Word(99);
+	w.Word(50);
+	w.Word(14);
+	w.Dword(2400);
+	w.String("Button");
+	w.String("Cancel");
+	w.Word(0);
+	return w.data;
+}
+
+TEST(dlg_template_parse)
+{
+	std::vector<uint8_t> data = SampleTemplate();
+	dlgTemplate t;
+	CHECK(ParseDialogTemplate(data.data(), data.size(), &t));
+	CHECK(!t.fExtended && t.cx == 200 && t.cy == 100);
+	CHECK(t.items.size() == 3);
+	CHECK(t.items[0].id == 1 && t.items[0].classAtom == DLG_CLASS_BUTTON && t.items[0].y == 14);
+	CHECK(t.items[1].id == 0xFFFF && t.items[1].classAtom == DLG_CLASS_STATIC);
+	CHECK(t.items[2].id == 1455 && t.items[2].classAtom == DLG_CLASS_COMBOBOX && t.items[2].cy == 80);
+}
+
+TEST(dlg_template_parse_ex)
+{
+	std::vector<uint8_t> data = SampleTemplateEx();
+	dlgTemplate t;
+	CHECK(ParseDialogTemplate(data.data(), data.size(), &t));
+	CHECK(t.fExtended && t.x == -5 && t.items.size() == 2);
+	CHECK(t.items[0].id == 0xFFFFFFFF && t.items[0].x == -2 && t.items[0].classAtom == DLG_CLASS_COMBOBOX);
+	CHECK(t.items[1].id == 2400 && t.items[1].y == 99 && t.items[1].classAtom == 0);
+}
+
+TEST(dlg_template_clear_style)
+{
+	// WS_VISIBLE, as the pool clears it to create dialogs hidden
+	dlgWriter w;
+	w.Header(0x90C800C0, 1, 0, 0, 200, 100, "Please wait...");
+	w.Item(2451, DLG_CLASS_STATIC, 0x50000000, 7, 40, 100, 8, "");
+	dlgTemplate t;
+	CHECK(ClearDialogTemplateStyle(w.data.data(), w.data.size(), 0x10000000));
+	CHECK(ParseDialogTemplate(w.data.data(), w.data.size(), &t));
+	CHECK(t.style == 0x80C800C0 && t.items.size() == 1 && t.items[0].style == 0x50000000);
+
+	std::vector<uint8_t> data = SampleTemplateEx();
+	CHECK(ClearDialogTemplateStyle(data.data(), data.size(), 0x80000000));
+	CHECK(ParseDialogTemplate(data.data(), data.size(), &t));
+	CHECK(t.fExtended && t.style == 0x00C80048 && t.items.size() == 2);
+
+	CHECK(!ClearDialogTemplateStyle(data.data(), 15, 0x10000000));
+	CHECK(!ClearDialogTemplateStyle(nullptr, 0, 0x10000000));
+}
+
+TEST(dlg_template_truncated)
+{
+	for (const std::vector<uint8_t>& data : { SampleTemplate(), SampleTemplateEx() })
+	{
+		dlgTemplate t;
+		for (size_t size = 0; size < data.size(); size++)
+		{
+			std::vector<uint8_t> prefix(data.begin(), data.begin() + size);
+			CHECK(!ParseDialogTemplate(prefix.data(), prefix.size(), &t));
+		}
+	}
+}
+
+TEST(dlg_template_layout)
+{
+	std::vector<uint8_t> data = SampleTemplateEx();
+	dlgTemplate t;
+	CHECK(ParseDialogTemplate(data.data(), data.size(), &t));
+
+	// MS Shell Dlg at 96 DPI
+	dlgLayout layout;
+	layout.Load(t, 6, 13, 330, 200);
+	dlgItem* pItem = layout.Find(2400);
+	CHECK(pItem && pItem->x == 225 && pItem->y == 161 && pItem->cx == 75 && pItem->cy == 23);
+	CHECK(layout.GetItems()[0].x == -3);
+	CHECK(!layout.Find(7));
+
+	layout.Hide(2400);
+	CHECK(pItem->fHidden && pItem->fChanged);
+	layout.OffsetBelow(100, -20, 0);
+	CHECK(pItem->y == 141 && !layout.GetItems()[0].fChanged);
+	layout.OffsetAll(0, 10);
+	CHECK(layout.GetItems()[0].y == 26 && layout.GetItems()[0].fChanged);
+	CHECK(!layout.IsResized());
+	layout.Resize(0, -5);
+	CHECK(layout.IsResized() && layout.GetWidth() == 330 && layout.GetHeight() == 195);
+}
+
+// Where the OK button of every msgina dialog ends up at 96 DPI, before and after the branding strip is added
+struct msginaGolden
+{
+	int cx;
+	int cy;
+	int okX;
+	int okY;
+	int cancelX;
+	int editWidth;
+};
+
+TEST(dlg_template_msgina_golden)
+{
+	// NT 4.0, 2000, XP; 2000 and XP share their templates
+	const msginaGolden golden[] = {
+		{ 256, 86, 213, 104, 299, 269 },
+		{ 262, 158, 222, 221, 308, 278 },
+		{ 262, 158, 222, 221, 308, 278 },
+	};
+
+	std::vector<msginaSample> samples = BuildMsginaSamples();
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		peResources res;
+		CHECK(res.Open(samples[i].image.data(), samples[i].image.size(), false));
+		for (const auto& ids : c_msginaDialogs)
+		{
+			uint16_t id = samples[i].fNt4 ? ids[0] : ids[1];
+			peSpan span;
+			dlgTemplate t;
+			CHECK(res.Find(PE_RT_DIALOG, id, &span));
+			CHECK(ParseDialogTemplate(span.data, span.size, &t));
+			CHECK(!t.fExtended && t.cx == golden[i].cx && t.cy == golden[i].cy);
+			CHECK(t.items.size() == 4);
+			CHECK(t.items[0].id == 0xFFFF && t.items[0].classAtom == DLG_CLASS_STATIC);
+			CHECK(t.items[1].id == (uint32_t)id + 2 && t.items[1].classAtom == DLG_CLASS_EDIT);
+			CHECK(t.items[2].id == 1 && t.items[3].id == 2);
+
+			dlgLayout layout;
+			layout.Load(t, 6, 13, t.cx * 6 / 4, t.cy * 13 / 8);
+			dlgItem* pOk = layout.Find(1);
+			dlgItem* pCancel = layout.Find(2);
+			CHECK(pOk && pOk->x == golden[i].okX && pOk->y == golden[i].okY && pOk->cx == 75 && pOk->cy == 23);
+			CHECK(pCancel && pCancel->x == golden[i].cancelX && pCancel->y == golden[i].okY);
+			CHECK(layout.Find(id + 2)->cx == golden[i].editWidth);
+
+			// What the shutdown dialog does with its help button, then the branding offset
+			int height = layout.GetHeight();
+			layout.Hide(2);
+			layout.Offset(1, pCancel->cx + 8, 0);
+			layout.OffsetAll(0, 70);
+			layout.Resize(0, 70);
+			CHECK(pOk->x == golden[i].okX + 83 && pOk->y == golden[i].okY + 70 && pOk->fChanged);
+			CHECK(pCancel->fHidden && pCancel->y == golden[i].okY + 70);
+			CHECK(layout.IsResized() && layout.GetHeight() == height + 70);
+		}
+	}
+}
+
+TEST(dlg_template_msgina_files)
+{
+	std::vector<msginaSample> samples = LoadMsginaFiles();
+	if (samples.empty())
+	{
+		printf("  CLH_GINA_MSGINA_DIR isn't set, only the synthetic samples were checked\n");
+		return;
+	}
+	for (const msginaSample& sample : samples)
+	{
+		printf("  %s\n", sample.name.c_str());
+		peResources res;
+		CHECK(res.Open(sample.image.data(), sample.image.size(), false));
+		for (const auto& ids : c_msginaDialogs)
+		{
+			peSpan span;
+			dlgTemplate t;
+			CHECK(res.Find(PE_RT_DIALOG, sample.fNt4 ? ids[0] : ids[1], &span));
+			CHECK(ParseDialogTemplate(span.data, span.size, &t));
+			CHECK(t.cx > 0 && t.cy > 0 && !t.items.empty());
+
+			dlgLayout layout;
+			layout.Load(t, 6, 13, t.cx * 6 / 4, t.cy * 13 / 8);
+			CHECK(layout.GetItems().size() == t.items.size());
+			for (const dlgItem& item : layout.GetItems())
+				CHECK(item.cx >= 0 && item.cy >= 0 && !item.fChanged);
+		}
+	}
+}
@@ -0,0 +1,172 @@
+#include "test.h"
+#include "trace_stub_ui.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+using namespace interop_trace;
+
+// Writes records the way interop_trace::Record does, with a 10 MHz counter starting at 1000
+class traceWriter
+{
+public:
+	explicit traceWriter(const std::string& path)
+		: _file(path, std::ios::binary | std::ios::trunc)
+	{
+		traceHeader header = { TraceMagic, TraceVersion, 10000000, 1000 };
+		_file.write((const char*)&header, sizeof(header));
+	}
+
+	void Write(int64_t time, EVENT event, uint64_t arg0 = 0, uint64_t arg1 = 0, const char16_t* str = nullptr)
+	{
+		std::u16string text = str ? str : u"";
+		traceRecord record = { 1000 + time, (uint16_t)event, (uint16_t)text.size(), arg0, arg1 };
+		_file.write((const char*)&record, sizeof(record));
+		_file.write((const char*)text.data(), text.size() * sizeof(char16_t));
+	}
+
+	void Close()
+	{
+		_file.close();
+	}
+
+private:
+	std::ofstream _file;
+};
+
+static std::string TracePath(const char* name)
+{
+	return std::string("interop_trace_") + name + ".bin";
+}
+
+// A logon as the hook records it: status, user list, credential view, then pressing a user that is gone
+static void WriteSession(traceWriter& w)
+{
+	w.Write(0, EV_STATUSVIEW_SETACTIVE, 0, 0, u"Please wait...");
+	w.Write(10000, EV_MESSAGEORSTATUSVIEW_DESTROY);
+	w.Write(20000, EV_USERSELECT_SETACTIVE);
+	w.Write(20100, EV_SELECTABLEUSERORCREDENTIALCONTROL_CREATE, 0x1000, 0, u"");
+	w.Write(20200, EV_SELECTABLEUSERORCREDENTIALCONTROL_CREATE, 0x2000, 0, u"");
+	w.Write(20300, EV_SELECTABLEUSERORCREDENTIALCONTROL_SORT);
+	w.Write(20400, EV_SELECTABLEUSERORCREDENTIALCONTROL_GETTEXT, 0x1000, 0, u"Administrator");
+	w.Write(20500, EV_SELECTABLEUSERORCREDENTIALCONTROL_ISCREDENTIALCONTROL, 0x1000, 0);
+	w.Write(30000, EV_SELECTABLEUSERORCREDENTIALCONTROL_PRESS, 0x1000);
+	w.Write(30100, EV_SELECTEDCREDENTIALVIEW_SETACTIVE, 0, 0, u"Administrator");
+	w.Write(30200, EV_EDITCONTROL_CREATE, 0x3000);
+	w.Write(30300, EV_EDITCONTROL_GETFIELDNAME, 0x3000, 0, u"Password");
+	w.Write(30400, EV_EDITCONTROL_SETINPUTTEDTEXT, 0x3000, 8);
+	w.Write(30500, EV_SELECTABLEUSERORCREDENTIALCONTROL_DESTROY, 0x2000);
+	w.Write(30600, EV_SELECTABLEUSERORCREDENTIALCONTROL_PRESS, 0x2000);
+	w.Write(30700, EV_EDITCONTROL_DESTROY, 0x3000);
+}
+
+TEST(interop_trace_load)
+{
+	std::string path = TracePath("load");
+	traceWriter w(path);
+	WriteSession(w);
+	w.Close();
+
+	std::vector<traceEvent> events;
+	CHECK(Load(path, events));
+	CHECK(events.size() == 16);
+	CHECK(events[0].time == 0 && events[0].event == EV_STATUSVIEW_SETACTIVE && events[0].str == L"Please wait...");
+	CHECK(events[1].time == 10000);
+	CHECK(events[6].event == EV_SELECTABLEUSERORCREDENTIALCONTROL_GETTEXT && events[6].arg0 == 0x1000 && events[6].str == L"Administrator");
+	CHECK(events[12].arg1 == 8 && events[12].str.empty());
+	remove(path.c_str());
+}
+
+TEST(interop_trace_truncated)
+{
+	std::string path = TracePath("truncated");
+	traceWriter w(path);
+	WriteSession(w);
+	w.Close();
+
+	std::ifstream in(path, std::ios::binary);
+	std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	in.close();
+
+	// Where each record ends, every cut loads the records that end before it and nothing else
+	std::vector<size_t> ends;
+	for (size_t offset = sizeof(traceHeader); offset < data.size();)
+	{
+		traceRecord record;
+		memcpy(&record, data.data() + offset, sizeof(record));
+		offset += sizeof(record) + record.strLength * sizeof(char16_t);
+		ends.push_back(offset);
+	}
+	CHECK(ends.size() == 16 && ends.back() == data.size());
+
+	std::vector<traceEvent> events;
+	for (size_t size = 0; size <= data.size(); size++)
+	{
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		out.write(data.data(), size);
+		out.close();
+
+		bool fLoaded = Load(path, events);
+		CHECK(fLoaded == (size >= sizeof(traceHeader)));
+		if (fLoaded)
+			CHECK(events.size() == (size_t)(std::upper_bound(ends.begin(), ends.end(), size) - ends.begin()));
+	}
+	remove(path.c_str());
+
+	CHECK(!Load(TracePath("missing"), events));
+}
+
+TEST(interop_trace_bad_header)
+{
+	std::string path = TracePath("bad");
+	{
+		std::ofstream out(path, std::ios::binary);
+		traceHeader header = { TraceMagic, TraceVersion + 1, 10000000, 0 };
+		out.write((const char*)&header, sizeof(header));
+	}
+	std::vector<traceEvent> events;
+	CHECK(!Load(path, events));
+	remove(path.c_str());
+}
+
+TEST(interop_trace_replay_stub)
+{
+	std::string path = TracePath("replay");
+	traceWriter w(path);
+	WriteSession(w);
+	w.Close();
+
+	std::vector<traceEvent> events;
+	CHECK(Load(path, events));
+	remove(path.c_str());
+
+	traceStubUi ui;
+	Replay(events, 0, [&](const traceEvent& event) { ui.Apply(event); });
+	CHECK(ui.GetEventCount() == events.size());
+	CHECK(ui.GetView() == EV_SELECTEDCREDENTIALVIEW_SETACTIVE);
+	CHECK(ui.GetText() == L"Administrator");
+	CHECK(ui.GetLiveCount(SC_USER) == 1);
+	CHECK(ui.GetLiveCount(SC_EDIT) == 0);
+	// The press on the tile the hook had already destroyed
+	CHECK(ui.GetViolations().size() == 1);
+	CHECK(ui.GetViolations()[0].find("used after being destroyed") == 0);
+	CHECK(ui.GetViolations()[0].find("0x2000") != std::string::npos);
+}
+
+TEST(interop_trace_replay_timing)
+{
+	std::vector<traceEvent> events(3);
+	events[0].time = 0;
+	events[1].time = 100000; // 10 ms
+	events[2].time = 400000; // 40 ms
+
+	std::vector<double> times;
+	auto start = std::chrono::steady_clock::now();
+	Replay(events, 2.0, [&](const traceEvent&) {
+		times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	});
+	CHECK(times.size() == 3);
+	CHECK(times[1] >= 5.0 && times[2] >= 20.0);
+	CHECK(times[2] < 1000.0);
+}
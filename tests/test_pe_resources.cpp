@@ -0,0 +1,220 @@
+#include "test.h"
+#include "images.h"
+#include "msgina_samples.h"
+#include "util/pe_resources.h"
+
+static std::vector<imageResource> SampleResources()
+{
+	std::vector<imageResource> resources;
+	resources.push_back({ PE_RT_VERSION, 1, 1033, BuildVersionResource(0x00050001, 0x0A280000) });
+	resources.push_back({ PE_RT_STRING, 1, 1033, BuildStringBlock({ { 1, u"Hi" }, { 3, u"Yo!" } }) });
+	resources.push_back({ PE_RT_STRING, 101, 1033, BuildStringBlock({ { 0, u"Expand" }, { 15, u"X" } }) });
+	resources.push_back({ PE_RT_DIALOG, 1500, 0, { 1, 2, 3 } });
+	resources.push_back({ PE_RT_DIALOG, 1500, 1031, { 4, 5 } });
+	resources.push_back({ PE_RT_BITMAP, 107, 1033, std::vector<uint8_t>(64, 0x11) });
+	return resources;
+}
+
+static void CheckSample(const peResources& res)
+{
+	CHECK(res.IsOpen());
+	CHECK(res.GetEntries().size() == 6);
+
+	uint32_t ms, ls;
+	CHECK(res.GetFileVersion(&ms, &ls));
+	CHECK(ms == 0x00050001 && ls == 0x0A280000);
+
+	const char16_t* text;
+	uint32_t length;
+	CHECK(res.GetString(1, &text, &length) && length == 2 && !memcmp(text, u"Hi", 4));
+	CHECK(res.GetString(3, &text, &length) && length == 3);
+	CHECK(!res.GetString(2, &text, &length));
+	CHECK(res.GetString(1600, &text, &length) && length == 6 && !memcmp(text, u"Expand", 12));
+	CHECK(res.GetString(1615, &text, &length) && length == 1);
+	CHECK(!res.GetString(8100, &text, &length));
+
+	// Neutral first, then the exact language
+	peSpan span;
+	CHECK(res.Find(PE_RT_DIALOG, 1500, &span) && span.size == 3 && span.data[0] == 1);
+	CHECK(res.Find(PE_RT_DIALOG, 1500, &span, 1031) && span.size == 2 && span.data[0] == 4);
+	CHECK(res.Find(PE_RT_DIALOG, 1500, &span, 1041) && span.size == 3);
+	CHECK(res.Find(PE_RT_BITMAP, 107, &span) && span.size == 64 && span.data[63] == 0x11);
+	CHECK(!res.Find(PE_RT_BITMAP, 108, &span));
+	CHECK(!res.Find(PE_RT_ICON, 107, &span));
+}
+
+TEST(pe_resources_raw)
+{
+	std::vector<uint8_t> image = BuildPeImage(SampleResources());
+	peResources res;
+	CHECK(res.Open(image.data(), image.size(), false));
+	CheckSample(res);
+
+	res.Close();
+	CHECK(!res.IsOpen());
+	CHECK(res.GetEntries().empty());
+}
+
+TEST(pe_resources_mapped)
+{
+	std::vector<uint8_t> image = BuildPeImage(SampleResources(), true);
+	peResources res;
+	CHECK(res.Open(image.data(), image.size(), true));
+	CheckSample(res);
+}
+
+TEST(pe_resources_not_pe)
+{
+	std::vector<uint8_t> image = BuildPeImage(SampleResources());
+	peResources res;
+	CHECK(!res.Open(nullptr, 0, false));
+
+	std::vector<uint8_t> broken = image;
+	broken[0] = 'X';
+	CHECK(!res.Open(broken.data(), broken.size(), false));
+	broken = image;
+	broken[0x80] = 'X';
+	CHECK(!res.Open(broken.data(), broken.size(), false));
+	broken = image;
+	Put16(broken, 0x84 + 20, 0x107); // ROM image
+	CHECK(!res.Open(broken.data(), broken.size(), false));
+	CHECK(!res.IsOpen());
+}
+
+TEST(pe_resources_truncated)
+{
+	// Every prefix has to fail cleanly or open with fewer resources, never read past the end
+	std::vector<uint8_t> image = BuildPeImage(SampleResources());
+	for (size_t size = 0; size < image.size(); size++)
+	{
+		std::vector<uint8_t> prefix(image.begin(), image.begin() + size);
+		peResources res;
+		if (!res.Open(prefix.data(), prefix.size(), false))
+			continue;
+		uint32_t ms, ls;
+		res.GetFileVersion(&ms, &ls);
+		const char16_t* text;
+		uint32_t length;
+		for (uint16_t id = 0; id < 32; id++)
+			res.GetString(id, &text, &length);
+	}
+}
+
+TEST(pe_resources_version_short)
+{
+	// Version resources cut anywhere before the end of the fixed file info, the key included
+	std::vector<uint8_t> version = BuildVersionResource(0x00050001, 0x0A280000);
+	for (size_t size = 0; size <= version.size(); size++)
+	{
+		std::vector<imageResource> resources;
+		resources.push_back({ PE_RT_VERSION, 1, 1033, std::vector<uint8_t>(version.begin(), version.begin() + size) });
+		std::vector<uint8_t> image = BuildPeImage(resources);
+		peResources res;
+		CHECK(res.Open(image.data(), image.size(), false));
+		uint32_t ms, ls;
+		CHECK(res.GetFileVersion(&ms, &ls) == (size >= 56));
+	}
+}
+
+// One type whose ids all share one language directory, which itself has langCount entries
+static std::vector<uint8_t> BuildSharedDirectoryImage(uint32_t idCount, uint32_t langCount)
+{
+	size_t langDir = 40 + (size_t)idCount * 8;
+	size_t dataEntry = langDir + 16 + (size_t)langCount * 8;
+	std::vector<imageResource> resources;
+	resources.push_back({ PE_RT_BITMAP, 1, 0, std::vector<uint8_t>(dataEntry + 32, 0) });
+	std::vector<uint8_t> image = BuildPeImage(resources);
+
+	std::vector<uint8_t> rsrc(dataEntry + 32, 0);
+	Put16(rsrc, 14, 1);
+	Put32(rsrc, 16, PE_RT_BITMAP);
+	Put32(rsrc, 20, 0x80000000u | 24);
+	Put16(rsrc, 24 + 14, (uint16_t)idCount);
+	for (uint32_t i = 0; i < idCount; i++)
+	{
+		Put32(rsrc, 40 + i * 8, i + 1);
+		Put32(rsrc, 44 + i * 8, 0x80000000u | (uint32_t)langDir);
+	}
+	Put16(rsrc, langDir + 14, (uint16_t)langCount);
+	for (uint32_t i = 0; i < langCount; i++)
+	{
+		Put32(rsrc, langDir + 16 + i * 8, i);
+		Put32(rsrc, langDir + 20 + i * 8, (uint32_t)dataEntry);
+	}
+	Put32(rsrc, dataEntry, IMAGE_RESOURCE_RVA + (uint32_t)dataEntry + 16);
+	Put32(rsrc, dataEntry + 4, 4);
+	memcpy(&image[IMAGE_RAW_OFFSET], rsrc.data(), rsrc.size());
+	return image;
+}
+
+TEST(pe_resources_shared_directory)
+{
+	// Within the budget every path through the shared directory is an entry
+	std::vector<uint8_t> image = BuildSharedDirectoryImage(200, 200);
+	peResources res;
+	CHECK(res.Open(image.data(), image.size(), false));
+	CHECK(res.GetEntries().size() == 40000);
+
+	// 65535 ids fanning out into 65535 languages would be billions of entries, the budget stops it early
+	image = BuildSharedDirectoryImage(300, 300);
+	CHECK(!res.Open(image.data(), image.size(), false));
+	CHECK(!res.IsOpen());
+	image = BuildSharedDirectoryImage(0xFFFF, 0xFFFF);
+	CHECK(!res.Open(image.data(), image.size(), false));
+}
+
+static void CheckMsgina(const msginaSample& sample, const peResources& res)
+{
+	uint32_t ms, ls;
+	CHECK(res.GetFileVersion(&ms, &ls));
+	CHECK((ms >> 16) == 4 || (ms >> 16) == 5);
+	CHECK(sample.fNt4 == ((ms >> 16) == 4));
+
+	peSpan span;
+	for (const auto& ids : c_msginaDialogs)
+	{
+		CHECK(res.Find(PE_RT_DIALOG, sample.fNt4 ? ids[0] : ids[1], &span));
+		CHECK(span.size > 18);
+	}
+}
+
+TEST(pe_resources_msgina_samples)
+{
+	std::vector<msginaSample> samples = BuildMsginaSamples();
+	uint32_t builds[] = { 1381, 2195, 2600 };
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		peResources res;
+		CHECK(res.Open(samples[i].image.data(), samples[i].image.size(), false));
+		CheckMsgina(samples[i], res);
+
+		uint32_t ms, ls;
+		CHECK(res.GetFileVersion(&ms, &ls) && (ls >> 16) == builds[i]);
+
+		// The other generation's dialogs aren't there
+		peSpan span;
+		for (const auto& ids : c_msginaDialogs)
+			CHECK(!res.Find(PE_RT_DIALOG, samples[i].fNt4 ? ids[1] : ids[0], &span));
+
+		const char16_t* text;
+		uint32_t length;
+		CHECK(res.GetString(1501, &text, &length) && length == 13);
+	}
+}
+
+TEST(pe_resources_msgina_files)
+{
+	std::vector<msginaSample> samples = LoadMsginaFiles();
+	if (samples.empty())
+	{
+		printf("  CLH_GINA_MSGINA_DIR isn't set, only the synthetic samples were checked\n");
+		return;
+	}
+	for (const msginaSample& sample : samples)
+	{
+		printf("  %s\n", sample.name.c_str());
+		peResources res;
+		CHECK(res.Open(sample.image.data(), sample.image.size(), false));
+		CheckMsgina(sample, res);
+	}
+}
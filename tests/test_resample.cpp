@@ -0,0 +1,162 @@
+#include "test.h"
+#include "util/resample.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+// Straightforward double precision version of the taps resample.cpp computes,
+// every output pixel has to be within rounding of it
+static double ReferenceWeight(RESAMPLE_FILTER filter, double x)
+{
+	x = fabs(x);
+	if (filter == RF_BOX)
+		return x <= 0.5 ? 1.0 : 0.0;
+	if (filter == RF_BILINEAR)
+		return x < 1.0 ? 1.0 - x : 0.0;
+	auto sinc = [](double v) { return v == 0.0 ? 1.0 : sin(M_PI * v) / (M_PI * v); };
+	return x < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+}
+
+static std::vector<std::vector<double>> ReferenceAxis(RESAMPLE_FILTER filter, int srcSize, int dstSize)
+{
+	double scale = (double)dstSize / srcSize;
+	double filterScale = scale < 1.0 ? 1.0 / scale : 1.0;
+	double radius = filter == RF_BOX ? 0.5 : filter == RF_BILINEAR ? 1.0 : 3.0;
+	double support = radius * filterScale;
+
+	std::vector<std::vector<double>> matrix(dstSize, std::vector<double>(srcSize, 0.0));
+	for (int i = 0; i < dstSize; i++)
+	{
+		double center = (i + 0.5) / scale;
+		double total = 0.0;
+		for (int j = (int)floor(center - support) - 2; j <= (int)ceil(center + support) + 2; j++)
+		{
+			double w = ReferenceWeight(filter, (j + 0.5 - center) / filterScale);
+			if (w == 0.0)
+				continue;
+			matrix[i][std::clamp(j, 0, srcSize - 1)] += w;
+			total += w;
+		}
+		if (total == 0.0)
+		{
+			matrix[i][std::clamp((int)center, 0, srcSize - 1)] = 1.0;
+			total = 1.0;
+		}
+		for (double& w : matrix[i])
+			w /= total;
+	}
+	return matrix;
+}
+
+TEST(resample_taps)
+{
+	std::mt19937 random(1);
+	const int sizes[][4] = { { 97, 61, 31, 20 }, { 31, 20, 97, 61 }, { 200, 150, 67, 150 }, { 5, 5, 3, 9 }, { 1, 1, 7, 3 } };
+	for (int filter = RF_BOX; filter <= RF_LANCZOS3; filter++)
+	{
+		for (const auto& size : sizes)
+		{
+			int sw = size[0], sh = size[1], dw = size[2], dh = size[3];
+			std::vector<uint8_t> src((size_t)sw * sh * 4), dst((size_t)dw * dh * 4);
+			for (uint8_t& c : src)
+				c = (uint8_t)random();
+
+			imageView srcView = { src.data(), sw, sh, sw * 4 };
+			imageView dstView = { dst.data(), dw, dh, dw * 4 };
+			CHECK(Resample(srcView, dstView, 0, 0, dw, dh, (RESAMPLE_FILTER)filter, 1));
+
+			auto horz = ReferenceAxis((RESAMPLE_FILTER)filter, sw, dw);
+			auto vert = ReferenceAxis((RESAMPLE_FILTER)filter, sh, dh);
+			for (int y = 0; y < dh; y++)
+			{
+				for (int x = 0; x < dw; x++)
+				{
+					for (int c = 0; c < 4; c++)
+					{
+						double v = 0.0;
+						for (int j = 0; j < sh; j++)
+						{
+							if (vert[y][j] == 0.0)
+								continue;
+							double h = 0.0;
+							for (int i = 0; i < sw; i++)
+								h += horz[x][i] * src[((size_t)j * sw + i) * 4 + c];
+							v += vert[y][j] * h;
+						}
+						int expected = std::clamp((int)lround(v), 0, 255);
+						CHECK(abs(expected - dst[((size_t)y * dw + x) * 4 + c]) <= 1);
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(resample_constant)
+{
+	// Weights are normalized, a flat image stays flat whatever the filter and ratio
+	for (int filter = RF_BOX; filter <= RF_LANCZOS3; filter++)
+	{
+		for (int sw : { 1, 3, 17, 640 })
+		{
+			for (int dw : { 1, 5, 33, 1280 })
+			{
+				std::vector<uint8_t> src((size_t)sw * 7 * 4), dst((size_t)dw * 11 * 4);
+				for (size_t i = 0; i < src.size(); i += 4)
+				{
+					src[i] = 10;
+					src[i + 1] = 200;
+					src[i + 2] = 128;
+					src[i + 3] = 255;
+				}
+				imageView srcView = { src.data(), sw, 7, sw * 4 };
+				imageView dstView = { dst.data(), dw, 11, dw * 4 };
+				CHECK(Resample(srcView, dstView, 0, 0, dw, 11, (RESAMPLE_FILTER)filter, 1));
+				for (size_t i = 0; i < dst.size(); i += 4)
+					CHECK(dst[i] == 10 && dst[i + 1] == 200 && dst[i + 2] == 128 && dst[i + 3] == 255);
+			}
+		}
+	}
+}
+
+TEST(resample_identity)
+{
+	std::mt19937 random(2);
+	int w = 50, h = 40;
+	std::vector<uint8_t> src((size_t)w * h * 4), dst(src.size());
+	for (uint8_t& c : src)
+		c = (uint8_t)random();
+	for (int filter = RF_BOX; filter <= RF_LANCZOS3; filter++)
+	{
+		imageView srcView = { src.data(), w, h, w * 4 };
+		imageView dstView = { dst.data(), w, h, w * 4 };
+		CHECK(Resample(srcView, dstView, 0, 0, w, h, (RESAMPLE_FILTER)filter, 3));
+		CHECK(src == dst);
+	}
+}
+
+TEST(resample_threads)
+{
+	// Splitting the rows over threads must not change a single pixel, also with a rectangle reaching outside
+	std::mt19937 random(3);
+	int w = 1000, h = 700;
+	std::vector<uint8_t> src((size_t)w * h * 4), one(600 * 400 * 4), many(one.size());
+	for (uint8_t& c : src)
+		c = (uint8_t)random();
+	imageView srcView = { src.data(), w, h, w * 4 };
+	imageView oneView = { one.data(), 600, 400, 2400 };
+	imageView manyView = { many.data(), 600, 400, 2400 };
+	CHECK(Resample(srcView, oneView, -50, -20, 700, 450, RF_LANCZOS3, 1));
+	CHECK(Resample(srcView, manyView, -50, -20, 700, 450, RF_LANCZOS3, 8));
+	CHECK(one == many);
+}
+
+TEST(resample_invalid)
+{
+	uint8_t pixel[4] = {};
+	imageView view = { pixel, 1, 1, 4 };
+	imageView empty = { nullptr, 0, 0, 0 };
+	CHECK(!Resample(empty, view, 0, 0, 1, 1, RF_BOX));
+	CHECK(!Resample(view, empty, 0, 0, 1, 1, RF_BOX));
+	CHECK(!Resample(view, view, 0, 0, 0, 1, RF_BOX));
+}
@@ -0,0 +1,141 @@
+#include "test.h"
+#include "util/session_cache.h"
+#include <chrono>
+#include <thread>
+
+// Stands in for WTS, hands out whoever is set and counts the queries that reach it
+class fakeSessionProvider : public sessionIdentityProvider
+{
+public:
+	bool Query(sessionIdentity& identity) override
+	{
+		queries++;
+		if (fFail)
+			return false;
+		identity.sessionId = sessionId;
+		identity.userName = userName;
+		identity.domainName = L"CONTOSO";
+		return true;
+	}
+
+	int queries = 0;
+	bool fFail = false;
+	uint32_t sessionId = 1;
+	std::wstring userName = L"alice";
+};
+
+// sessionCache is a process wide singleton, every case installs its own provider first
+
+TEST(session_cache_hit)
+{
+	fakeSessionProvider provider;
+	sessionCache::Get()->SetProvider(&provider, 10000);
+	uint64_t queries = sessionCache::Get()->GetQueryCount();
+
+	for (int i = 0; i < 100; i++)
+	{
+		auto identity = sessionCache::Get()->Current();
+		CHECK(identity->sessionId == 1 && identity->userName == L"alice" && !identity->IsSystemUser());
+	}
+	CHECK(provider.queries == 1);
+	CHECK(sessionCache::Get()->GetQueryCount() == queries + 1);
+	sessionCache::Get()->SetProvider(nullptr, 0);
+}
+
+TEST(session_cache_ttl)
+{
+	fakeSessionProvider provider;
+	sessionCache::Get()->SetProvider(&provider, 50);
+	CHECK(sessionCache::Get()->Current()->userName == L"alice");
+
+	// Still cached within the lifetime, queried again after it
+	provider.userName = L"bob";
+	CHECK(sessionCache::Get()->Current()->userName == L"alice");
+	std::this_thread::sleep_for(std::chrono::milliseconds(80));
+	CHECK(sessionCache::Get()->Current()->userName == L"bob");
+	CHECK(provider.queries == 2);
+
+	// A lifetime of 0 never expires
+	sessionCache::Get()->SetTtl(0);
+	provider.userName = L"carol";
+	std::this_thread::sleep_for(std::chrono::milliseconds(80));
+	CHECK(sessionCache::Get()->Current()->userName == L"bob");
+	CHECK(provider.queries == 2);
+	sessionCache::Get()->SetProvider(nullptr, 0);
+}
+
+TEST(session_cache_invalidate)
+{
+	fakeSessionProvider provider;
+	sessionCache::Get()->SetProvider(&provider, 0);
+	auto before = sessionCache::Get()->Current();
+	provider.sessionId = 2;
+	provider.userName = L"bob";
+	CHECK(sessionCache::Get()->Current()->sessionId == 1);
+
+	sessionCache::Get()->Invalidate();
+	CHECK(sessionCache::Get()->Current()->sessionId == 2);
+	CHECK(provider.queries == 2);
+	// Identities handed out earlier don't change
+	CHECK(before->sessionId == 1 && before->userName == L"alice");
+	sessionCache::Get()->SetProvider(nullptr, 0);
+}
+
+TEST(session_cache_failure)
+{
+	fakeSessionProvider provider;
+	provider.fFail = true;
+	sessionCache::Get()->SetProvider(&provider, 0);
+	uint64_t queries = sessionCache::Get()->GetQueryCount();
+
+	// A failure comes back as the empty identity and isn't kept, every call asks again
+	auto identity = sessionCache::Get()->Current();
+	CHECK(identity->sessionId == SESSION_NONE && identity->IsSystemUser());
+	CHECK(sessionCache::Get()->Current()->sessionId == SESSION_NONE);
+	CHECK(provider.queries == 2);
+
+	provider.fFail = false;
+	CHECK(sessionCache::Get()->Current()->userName == L"alice");
+	CHECK(sessionCache::Get()->Current()->userName == L"alice");
+	CHECK(provider.queries == 3);
+	CHECK(sessionCache::Get()->GetQueryCount() == queries + 3);
+
+	// Failing again after a success drops the good identity as well
+	provider.fFail = true;
+	sessionCache::Get()->Invalidate();
+	CHECK(sessionCache::Get()->Current()->sessionId == SESSION_NONE);
+	sessionCache::Get()->SetProvider(nullptr, 0);
+}
+
+TEST(session_cache_set_provider)
+{
+	fakeSessionProvider first, second;
+	second.sessionId = 3;
+	second.userName = L"dave";
+
+	sessionCache::Get()->SetProvider(&first, 0);
+	CHECK(sessionCache::Get()->Current()->sessionId == 1);
+	// A new provider is asked right away, whatever the old one said was valid
+	sessionCache::Get()->SetProvider(&second, 0);
+	CHECK(sessionCache::Get()->Current()->sessionId == 3);
+	CHECK(first.queries == 1 && second.queries == 1);
+
+	// Without a provider the last identity stays and nothing is queried
+	uint64_t queries = sessionCache::Get()->GetQueryCount();
+	sessionCache::Get()->SetProvider(nullptr, 0);
+	CHECK(sessionCache::Get()->Current()->sessionId == 3);
+	CHECK(sessionCache::Get()->GetQueryCount() == queries);
+}
+
+TEST(session_cache_system_user)
+{
+	sessionIdentity identity;
+	CHECK(identity.IsSystemUser());
+	identity.sessionId = 0;
+	identity.userName = L"alice";
+	CHECK(identity.IsSystemUser());
+	identity.sessionId = 1;
+	CHECK(!identity.IsSystemUser());
+	identity.userName.clear();
+	CHECK(identity.IsSystemUser());
+}
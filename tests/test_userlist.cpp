@@ -0,0 +1,76 @@
+#include "test.h"
+#include "ui/gina_userlist.h"
+#include "util/sort_key.h"
+#include <cwctype>
+
+// Stands in for LCMapStringEx, case insensitive and counting how often it's asked
+static int g_keyCalls = 0;
+
+static std::vector<uint8_t> LowercaseKey(const std::wstring& text)
+{
+	g_keyCalls++;
+	std::vector<uint8_t> key;
+	for (wchar_t ch : text)
+	{
+		uint16_t unit = (uint16_t)std::towlower(ch);
+		key.push_back((uint8_t)(unit >> 8));
+		key.push_back((uint8_t)unit);
+	}
+	return key;
+}
+
+static void* Instance(uintptr_t id)
+{
+	return (void*)id;
+}
+
+TEST(userlist_sort)
+{
+	std::vector<userListEntry> users = {
+		{ Instance(1), L"charlie" }, { Instance(2), L"Alice" }, { Instance(3), L"bob" }, { Instance(4), L"alice" },
+	};
+	g_keyCalls = 0;
+	userList sorted = SortUserList(users, LowercaseKey);
+
+	// One key per name, not per comparison
+	CHECK(g_keyCalls == 4);
+	CHECK(sorted->size() == 4);
+	// Equal keys keep the order they came in
+	CHECK((*sorted)[0].actualInstance == Instance(2) && (*sorted)[0].text == L"Alice");
+	CHECK((*sorted)[1].actualInstance == Instance(4));
+	CHECK((*sorted)[2].text == L"bob");
+	CHECK((*sorted)[3].text == L"charlie");
+
+	CHECK(SortUserList({}, LowercaseKey)->empty());
+}
+
+TEST(userlist_remove)
+{
+	userList users = SortUserList({ { Instance(1), L"a" }, { Instance(2), L"b" }, { Instance(3), L"c" } }, LowercaseKey);
+	CHECK(UserListContains(users, Instance(2)));
+
+	userList removed = RemoveFromUserList(users, Instance(2));
+	CHECK(removed->size() == 2 && (*removed)[0].text == L"a" && (*removed)[1].text == L"c");
+	CHECK(!UserListContains(removed, Instance(2)));
+	// The list the dialog was filled from doesn't change
+	CHECK(users->size() == 3 && UserListContains(users, Instance(2)));
+
+	// Nothing to remove hands back the same list
+	CHECK(RemoveFromUserList(removed, Instance(7)) == removed);
+	CHECK(!UserListContains(nullptr, Instance(1)));
+}
+
+TEST(userlist_code_unit_key)
+{
+	// What GetSortKey falls back to, comparing the bytes has to compare whole code units
+	CHECK(GetCodeUnitSortKey(L"").empty());
+	CHECK(GetCodeUnitSortKey(L"A") == std::vector<uint8_t>({ 0x00, 0x41 }));
+	CHECK(GetCodeUnitSortKey(L"\u00FF") < GetCodeUnitSortKey(L"\u0100"));
+	CHECK(GetCodeUnitSortKey(L"\u0142") < GetCodeUnitSortKey(L"\u0241"));
+	CHECK(GetCodeUnitSortKey(L"ab") < GetCodeUnitSortKey(L"abc"));
+
+	userList sorted = SortUserList({ { Instance(1), L"\u0100" }, { Instance(2), L"\u00FF" }, { Instance(3), L"Z" } }, GetCodeUnitSortKey);
+	CHECK((*sorted)[0].actualInstance == Instance(3));
+	CHECK((*sorted)[1].actualInstance == Instance(2));
+	CHECK((*sorted)[2].actualInstance == Instance(1));
+}
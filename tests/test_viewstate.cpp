@@ -0,0 +1,113 @@
+#include "test.h"
+#include "ui/gina_viewstate.h"
+#include <string>
+
+static std::wstring g_lastLine;
+
+static void Sink(const wchar_t* line)
+{
+	g_lastLine = line;
+}
+
+// Every case leaves all views inactive, the state is a process wide singleton
+TEST(viewstate_replace)
+{
+	ginaViewState* state = ginaViewState::Get();
+	state->ResetStats();
+	state->SetLogSink(Sink);
+
+	CHECK(state->Current() == GV_NONE);
+	CHECK(state->Enter(GV_USERSELECT) == GT_REPLACE);
+	CHECK(state->IsActive(GV_USERSELECT));
+	CHECK(state->Current() == GV_USERSELECT);
+	state->Shown(GV_USERSELECT);
+	CHECK(g_lastLine.find(L"None -> UserSelect") != std::wstring::npos);
+
+	// The credential view replaces the user list, which closes afterwards
+	CHECK(state->Enter(GV_SELECTEDCREDENTIAL) == GT_REPLACE);
+	CHECK(state->Current() == GV_SELECTEDCREDENTIAL);
+	state->Leave(GV_USERSELECT);
+	CHECK(state->Current() == GV_SELECTEDCREDENTIAL);
+	CHECK(!state->IsActive(GV_USERSELECT));
+	state->Shown(GV_SELECTEDCREDENTIAL);
+	CHECK(state->GetStats(GV_USERSELECT, GV_SELECTEDCREDENTIAL).count == 1);
+
+	state->Leave(GV_SELECTEDCREDENTIAL);
+	CHECK(state->Current() == GV_NONE);
+	state->SetLogSink(nullptr);
+}
+
+TEST(viewstate_deny)
+{
+	ginaViewState* state = ginaViewState::Get();
+	state->ResetStats();
+
+	CHECK(state->Enter(GV_STATUS) == GT_REPLACE);
+	CHECK(state->Enter(GV_STATUS) == GT_DENY);
+	CHECK(state->GetDeniedCount() == 1);
+	CHECK(state->Enter(GV_NONE) == GT_DENY);
+	CHECK(state->Enter((GINAVIEW)GV_COUNT) == GT_DENY);
+	state->Leave(GV_STATUS);
+	CHECK(state->Enter(GV_STATUS) == GT_REPLACE);
+	state->Leave(GV_STATUS);
+}
+
+TEST(viewstate_overlay)
+{
+	ginaViewState* state = ginaViewState::Get();
+	state->ResetStats();
+
+	CHECK(state->Enter(GV_SELECTEDCREDENTIAL) == GT_REPLACE);
+	state->Shown(GV_SELECTEDCREDENTIAL);
+	// Overlays don't take over as the current view
+	CHECK(state->Enter(GV_SHUTDOWN) == GT_OVERLAY);
+	CHECK(state->Current() == GV_SELECTEDCREDENTIAL);
+	state->Shown(GV_SHUTDOWN);
+	CHECK(state->GetStats(GV_SELECTEDCREDENTIAL, GV_SHUTDOWN).count == 1);
+	state->Leave(GV_SHUTDOWN);
+	CHECK(state->Current() == GV_SELECTEDCREDENTIAL);
+	CHECK(state->IsActive(GV_SELECTEDCREDENTIAL));
+	state->Leave(GV_SELECTEDCREDENTIAL);
+	CHECK(state->Current() == GV_NONE);
+}
+
+TEST(viewstate_yield)
+{
+	ginaViewState* state = ginaViewState::Get();
+
+	CHECK(state->Enter(GV_STATUS) == GT_REPLACE);
+	CHECK(!state->ShouldYield(GV_STATUS));
+	CHECK(state->Enter(GV_SECURITYCONTROL) == GT_REPLACE);
+	CHECK(state->ShouldYield(GV_STATUS));
+	CHECK(!state->ShouldYield(GV_SECURITYCONTROL));
+	state->Leave(GV_STATUS);
+	CHECK(state->Current() == GV_SECURITYCONTROL);
+	state->Leave(GV_SECURITYCONTROL);
+	CHECK(!state->ShouldYield(GV_STATUS));
+	CHECK(state->Current() == GV_NONE);
+}
+
+TEST(viewstate_stats)
+{
+	ginaViewState* state = ginaViewState::Get();
+	state->ResetStats();
+
+	for (int i = 0; i < 3; i++)
+	{
+		state->Enter(GV_MESSAGE);
+		state->Shown(GV_MESSAGE);
+		// Shown only counts once per Enter
+		state->Shown(GV_MESSAGE);
+		state->Leave(GV_MESSAGE);
+	}
+	ginaTransitionStats stats = state->GetStats(GV_NONE, GV_MESSAGE);
+	CHECK(stats.count == 3);
+	CHECK(stats.maxUs <= stats.totalUs);
+	CHECK(state->GetStats(GV_NONE, GV_NONE).count == 0);
+	CHECK(state->GetStats((GINAVIEW)-1, GV_MESSAGE).count == 0);
+
+	state->ResetStats();
+	CHECK(state->GetStats(GV_NONE, GV_MESSAGE).count == 0);
+	CHECK(ginaViewState::GetTransition(GV_LOGOFF) == GT_OVERLAY);
+	CHECK(std::wstring(ginaViewState::GetViewName((GINAVIEW)GV_COUNT)) == L"?");
+}
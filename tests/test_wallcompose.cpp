@@ -0,0 +1,119 @@
+#include "test.h"
+#include "ui/wallcompose.h"
+#include <random>
+
+static uint32_t Pixel(const imageView& view, int x, int y)
+{
+	uint32_t pixel;
+	memcpy(&pixel, view.pixels + (size_t)y * view.stride + x * 4, 4);
+	return pixel;
+}
+
+TEST(wallcompose_layout)
+{
+	wallpaperLayout l;
+	CHECK(GetWallpaperLayout(WP_STYLE_CENTER, 1920, 1080, 800, 600, &l));
+	CHECK(l.x == 560 && l.y == 240 && l.width == 800 && l.height == 600 && !l.fTile);
+	CHECK(GetWallpaperLayout(WP_STYLE_TILE, 1920, 1080, 800, 600, &l));
+	CHECK(l.x == 0 && l.y == 0 && l.width == 800 && l.fTile);
+	CHECK(GetWallpaperLayout(WP_STYLE_STRETCH, 1920, 1080, 800, 600, &l));
+	CHECK(l.x == 0 && l.y == 0 && l.width == 1920 && l.height == 1080);
+	CHECK(GetWallpaperLayout(WP_STYLE_FIT, 1920, 1080, 4000, 2000, &l));
+	CHECK(l.width == 1920 && l.height == 960 && l.y == 60);
+	CHECK(GetWallpaperLayout(WP_STYLE_FIT, 1920, 1080, 800, 600, &l));
+	CHECK(l.width == 800 && l.x == 560);
+	CHECK(GetWallpaperLayout(WP_STYLE_FILL, 1920, 1080, 800, 600, &l));
+	// Fill keeps two thirds of the overflow below the screen, like Windows
+	CHECK(l.width == 1920 && l.height == 1440 && l.x == 0 && l.y == -120);
+	CHECK(GetWallpaperLayout(WP_STYLE_SPAN, 1920, 1080, 800, 600, &l));
+	CHECK(l.width == 1920 && l.height == 1440 && l.y == -180);
+	CHECK(GetWallpaperLayout(WP_STYLE_FILL, 1920, 1080, 1000, 200, &l));
+	CHECK(l.height == 1080 && l.width == 5400 && l.x == -1740);
+	CHECK(!GetWallpaperLayout(WP_STYLE_FILL, 1920, 1080, 0, 200, &l));
+	CHECK(!GetWallpaperLayout(WP_STYLE_CENTER, 0, 1080, 800, 600, &l));
+}
+
+TEST(wallcompose_tile_center)
+{
+	int w = 37, h = 23;
+	std::vector<uint8_t> frame((size_t)w * h * 4), image(5 * 4 * 4);
+	for (int i = 0; i < 20; i++)
+	{
+		uint32_t pixel = 0xFF000000u | i;
+		memcpy(&image[i * 4], &pixel, 4);
+	}
+	imageView imageView_ = { image.data(), 5, 4, 20 };
+	imageView frameView = { frame.data(), w, h, w * 4 };
+
+	ComposeWallpaper(imageView_, frameView, WP_STYLE_TILE, 0x123456);
+	for (int y = 0; y < h; y++)
+	{
+		for (int x = 0; x < w; x++)
+			CHECK(Pixel(frameView, x, y) == (0xFF000000u | ((y % 4) * 5 + x % 5)));
+	}
+
+	ComposeWallpaper(imageView_, frameView, WP_STYLE_CENTER, 0x123456);
+	for (int y = 0; y < h; y++)
+	{
+		for (int x = 0; x < w; x++)
+		{
+			int ix = x - 16, iy = y - 9;
+			if (ix >= 0 && ix < 5 && iy >= 0 && iy < 4)
+				CHECK(Pixel(frameView, x, y) == (0xFF000000u | (iy * 5 + ix)));
+			else
+				CHECK(Pixel(frameView, x, y) == 0x123456);
+		}
+	}
+
+	// No image only fills the background
+	ComposeWallpaper({ nullptr, 0, 0, 0 }, frameView, WP_STYLE_FILL, 0xABCDEF);
+	CHECK(Pixel(frameView, 3, 7) == 0xABCDEF);
+}
+
+TEST(wallcompose_monitors)
+{
+	std::mt19937 random(4);
+	int iw = 300, ih = 200;
+	std::vector<uint8_t> image((size_t)iw * ih * 4);
+	for (uint8_t& c : image)
+		c = (uint8_t)random();
+	imageView imageView_ = { image.data(), iw, ih, iw * 4 };
+
+	// 1280x1024 on the left, 1920x1080 primary on the right and 120 pixels down
+	wallpaperMonitor monitors[2] = { { 1280, 120, 1920, 1080 }, { 0, 0, 1280, 1024 } };
+	int fw = 3200, fh = 1200;
+	std::vector<uint8_t> frame((size_t)fw * fh * 4), single;
+	imageView frameView = { frame.data(), fw, fh, fw * 4 };
+
+	for (int style = WP_STYLE_CENTER; style <= WP_STYLE_SPAN; style++)
+	{
+		memset(frame.data(), 0xEE, frame.size());
+		ComposeWallpaperMonitors(imageView_, frameView, style, 0x102030, monitors, 2);
+
+		// Each monitor has to match composing it on its own, span the whole frame at once
+		for (const wallpaperMonitor& m : monitors)
+		{
+			int width = style == WP_STYLE_SPAN ? fw : m.width;
+			int height = style == WP_STYLE_SPAN ? fh : m.height;
+			single.assign((size_t)width * height * 4, 0);
+			imageView singleView = { single.data(), width, height, width * 4 };
+			ComposeWallpaper(imageView_, singleView, style, 0x102030, 1);
+			for (int y = 0; y < m.height; y++)
+			{
+				for (int x = 0; x < m.width; x++)
+				{
+					uint32_t expected = style == WP_STYLE_SPAN ? Pixel(singleView, m.x + x, m.y + y) : Pixel(singleView, x, y);
+					CHECK(Pixel(frameView, m.x + x, m.y + y) == expected);
+				}
+			}
+		}
+
+		// Nothing outside of the monitors is touched
+		CHECK(Pixel(frameView, 0, 1100) == 0xEEEEEEEE);
+		CHECK(Pixel(frameView, 1500, 50) == 0xEEEEEEEE);
+	}
+
+	// Monitors reaching outside of the frame are clipped
+	wallpaperMonitor outside = { -100, 0, 400, 300 };
+	ComposeWallpaperMonitors(imageView_, frameView, WP_STYLE_FILL, 0, &outside, 1);
+}
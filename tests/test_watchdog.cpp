@@ -0,0 +1,148 @@
+#include "test.h"
+#include "ui/gina_watchdog.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// The watchdog is a process wide singleton that can only be started once, with a short timeout
+// Every case leaves all views disarmed and waits for its own stalls only
+
+static std::mutex g_stallMutex;
+static std::condition_variable g_stallCv;
+static int g_stallCount[GV_COUNT];
+static uint64_t g_stallMs[GV_COUNT];
+
+static void OnStall(GINAVIEW view, uint64_t stalledMs)
+{
+	std::lock_guard<std::mutex> lock(g_stallMutex);
+	g_stallCount[view]++;
+	g_stallMs[view] = stalledMs;
+	g_stallCv.notify_all();
+}
+
+static ginaWatchdog* StartWatchdog()
+{
+	ginaWatchdog::Get()->Start(100, OnStall);
+	return ginaWatchdog::Get();
+}
+
+static bool WaitForStall(GINAVIEW view, int count, int timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(g_stallMutex);
+	return g_stallCv.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return g_stallCount[view] >= count; });
+}
+
+static int StallCount(GINAVIEW view)
+{
+	std::lock_guard<std::mutex> lock(g_stallMutex);
+	return g_stallCount[view];
+}
+
+TEST(watchdog_start)
+{
+	// Nothing is up after starting, GV_NONE stalls unless a view comes up
+	StartWatchdog();
+	CHECK(WaitForStall(GV_NONE, 1, 2000));
+}
+
+TEST(watchdog_stall)
+{
+	ginaWatchdog* watchdog = StartWatchdog();
+	int before = StallCount(GV_USERSELECT);
+	watchdog->Arm(GV_USERSELECT);
+	CHECK(WaitForStall(GV_USERSELECT, before + 1, 2000));
+	{
+		std::lock_guard<std::mutex> lock(g_stallMutex);
+		CHECK(g_stallMs[GV_USERSELECT] >= 100);
+	}
+}
+
+TEST(watchdog_rearm)
+{
+	// Arming again while armed keeps the time the view started waiting
+	ginaWatchdog* watchdog = StartWatchdog();
+	int before = StallCount(GV_LOCKED);
+	watchdog->Arm(GV_LOCKED);
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	watchdog->Arm(GV_LOCKED);
+	CHECK(WaitForStall(GV_LOCKED, before + 1, 2000));
+	{
+		std::lock_guard<std::mutex> lock(g_stallMutex);
+		CHECK(g_stallMs[GV_LOCKED] >= 100);
+	}
+}
+
+TEST(watchdog_disarm)
+{
+	ginaWatchdog* watchdog = StartWatchdog();
+	int before = StallCount(GV_SHUTDOWN);
+	watchdog->Arm(GV_SHUTDOWN);
+	watchdog->Disarm(GV_SHUTDOWN);
+	std::this_thread::sleep_for(std::chrono::milliseconds(250));
+	CHECK(StallCount(GV_SHUTDOWN) == before);
+}
+
+TEST(watchdog_beat)
+{
+	// A message loop that keeps beating never stalls, one that stops does
+	ginaWatchdog* watchdog = StartWatchdog();
+	int before = StallCount(GV_STATUS);
+	for (int i = 0; i < 30; i++)
+	{
+		watchdog->Beat(GV_STATUS);
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	CHECK(StallCount(GV_STATUS) == before);
+	CHECK(WaitForStall(GV_STATUS, before + 1, 2000));
+}
+
+TEST(watchdog_histogram)
+{
+	ginaWatchdog* watchdog = StartWatchdog();
+	uint64_t before[WATCHDOG_HISTOGRAM_BUCKETS];
+	watchdog->GetHistogram(before);
+
+	// Arm then disarm right away lands in the first bucket
+	watchdog->Arm(GV_CHANGEPWD);
+	watchdog->Disarm(GV_CHANGEPWD);
+	uint64_t after[WATCHDOG_HISTOGRAM_BUCKETS];
+	watchdog->GetHistogram(after);
+	uint64_t total = 0;
+	for (int i = 0; i < WATCHDOG_HISTOGRAM_BUCKETS; i++)
+	{
+		total += after[i] - before[i];
+	}
+	CHECK(total >= 1);
+	CHECK(after[0] > before[0]);
+}
+
+TEST(watchdog_beat_period)
+{
+	// Every timeout, the default and sub-second ones included, fits a few beats
+	for (unsigned int timeoutMs : { 1u, 100u, 150u, 500u, 999u, 1000u, 1001u, 3000u, 6000u, 60000u })
+	{
+		unsigned int beatMs = ginaWatchdog::GetBeatMs(timeoutMs);
+		CHECK(beatMs >= WATCHDOG_MIN_BEAT_MS && beatMs <= WATCHDOG_BEAT_MS);
+		CHECK(beatMs * WATCHDOG_BEATS_PER_TIMEOUT <= ginaWatchdog::GetEffectiveTimeoutMs(timeoutMs));
+	}
+	CHECK(ginaWatchdog::GetEffectiveTimeoutMs(6000) == 6000);
+	CHECK(ginaWatchdog::GetBeatMs(6000) == WATCHDOG_BEAT_MS);
+}
+
+TEST(watchdog_short_timeout)
+{
+	// Started with a timeout shorter than the default beat, a loop beating at the watchdog's own period never stalls
+	ginaWatchdog* watchdog = StartWatchdog();
+	CHECK(watchdog->GetBeatMs() < WATCHDOG_BEAT_MS);
+	CHECK(watchdog->GetBeatMs() == ginaWatchdog::GetBeatMs(100));
+	int before = StallCount(GV_MESSAGE);
+	auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(800);
+	while (std::chrono::steady_clock::now() < end)
+	{
+		watchdog->Beat(GV_MESSAGE);
+		std::this_thread::sleep_for(std::chrono::milliseconds(watchdog->GetBeatMs()));
+	}
+	CHECK(StallCount(GV_MESSAGE) == before);
+	watchdog->Disarm(GV_MESSAGE);
+}
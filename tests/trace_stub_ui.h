@@ -0,0 +1,122 @@
+#pragma once
+#include "interop_trace_file.h"
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+// Stands in for ConsoleLogonUI when replaying an interop trace
+// Keeps the controls the hook handed over and the active view, and reports calls that would have
+// reached a control the hook already destroyed, or lifecycles that don't add up
+
+enum STUB_CONTROL
+{
+	SC_MESSAGEOPTION = 0,
+	SC_SECURITYOPTION,
+	SC_EDIT,
+	SC_USER,
+	SC_COUNT
+};
+
+class traceStubUi
+{
+public:
+	void Apply(const interop_trace::traceEvent& event)
+	{
+		using namespace interop_trace;
+		_count++;
+		switch (event.event)
+		{
+		case EV_MESSAGEOPTIONCONTROL_CREATE: Create(SC_MESSAGEOPTION, event); break;
+		case EV_SECURITYOPTIONCONTROL_CREATE: Create(SC_SECURITYOPTION, event); break;
+		case EV_EDITCONTROL_CREATE: Create(SC_EDIT, event); break;
+		case EV_SELECTABLEUSERORCREDENTIALCONTROL_CREATE: Create(SC_USER, event); break;
+
+		case EV_MESSAGEOPTIONCONTROL_DESTROY: Destroy(SC_MESSAGEOPTION, event); break;
+		case EV_SECURITYOPTIONCONTROL_DESTROY: Destroy(SC_SECURITYOPTION, event); break;
+		case EV_EDITCONTROL_DESTROY: Destroy(SC_EDIT, event); break;
+		case EV_SELECTABLEUSERORCREDENTIALCONTROL_DESTROY: Destroy(SC_USER, event); break;
+
+		case EV_MESSAGEOPTIONCONTROL_PRESS:
+		case EV_MESSAGEOPTIONCONTROL_GETTEXT:
+			Use(SC_MESSAGEOPTION, event);
+			break;
+		case EV_SECURITYOPTIONCONTROL_PRESS:
+		case EV_SECURITYOPTIONCONTROL_GETSTRING:
+			Use(SC_SECURITYOPTION, event);
+			break;
+		case EV_EDITCONTROL_SETINPUTTEDTEXT:
+		case EV_EDITCONTROL_GETFIELDNAME:
+		case EV_EDITCONTROL_GETINPUTTEDTEXT:
+		case EV_EDITCONTROL_ISVISIBLE:
+			Use(SC_EDIT, event);
+			break;
+		case EV_SELECTABLEUSERORCREDENTIALCONTROL_PRESS:
+		case EV_SELECTABLEUSERORCREDENTIALCONTROL_GETTEXT:
+		case EV_SELECTABLEUSERORCREDENTIALCONTROL_ISCREDENTIALCONTROL:
+			Use(SC_USER, event);
+			break;
+
+		case EV_MESSAGEVIEW_SETACTIVE:
+		case EV_SECURITYCONTROL_SETACTIVE:
+		case EV_SELECTEDCREDENTIALVIEW_SETACTIVE:
+		case EV_STATUSVIEW_SETACTIVE:
+		case EV_USERSELECT_SETACTIVE:
+			_view = event.event;
+			if (!event.str.empty())
+				_text = event.str;
+			break;
+		case EV_MESSAGEVIEW_SETMESSAGE:
+			_text = event.str;
+			break;
+		case EV_SECURITYCONTROL_SETINACTIVE:
+		case EV_MESSAGEORSTATUSVIEW_DESTROY:
+			_view = 0;
+			break;
+		default:
+			break;
+		}
+	}
+
+	size_t GetLiveCount(STUB_CONTROL control) const { return _live[control].size(); }
+	unsigned short GetView() const { return _view; }
+	const std::wstring& GetText() const { return _text; }
+	size_t GetEventCount() const { return _count; }
+	const std::vector<std::string>& GetViolations() const { return _violations; }
+
+private:
+	void Violation(const char* what, const interop_trace::traceEvent& event)
+	{
+		char line[160];
+		snprintf(line, sizeof(line), "%s: event 0x%x instance 0x%llx at %.3f ms", what, (unsigned)event.event,
+			(unsigned long long)event.arg0, event.time / 10000.0);
+		_violations.push_back(line);
+	}
+
+	void Create(STUB_CONTROL control, const interop_trace::traceEvent& event)
+	{
+		_seen[control].insert(event.arg0);
+		if (!_live[control].insert(event.arg0).second)
+			Violation("created twice", event);
+	}
+
+	void Destroy(STUB_CONTROL control, const interop_trace::traceEvent& event)
+	{
+		if (!_live[control].erase(event.arg0))
+			Violation("destroyed without being created", event);
+	}
+
+	void Use(STUB_CONTROL control, const interop_trace::traceEvent& event)
+	{
+		// Traces started halfway through a session don't have the creation of older controls
+		if (!_live[control].count(event.arg0) && _seen[control].count(event.arg0))
+			Violation("used after being destroyed", event);
+	}
+
+	std::set<uint64_t> _live[SC_COUNT];
+	std::set<uint64_t> _seen[SC_COUNT];
+	unsigned short _view = 0;
+	std::wstring _text;
+	size_t _count = 0;
+	std::vector<std::string> _violations;
+};